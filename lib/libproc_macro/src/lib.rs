@@ -503,174 +503,181 @@ impl fmt::Display for TokenStream {
     }
 }
 
-/// Receive a token stream from the compiler
-pub fn recv_token_stream() -> TokenStream
-{
-    struct Reader<R> {
-        inner: R,
+struct Reader<R> {
+    inner: R,
+}
+impl<R: ::std::io::Read> Reader<R> {
+    fn getb(&mut self) -> Option<u8> {
+        let mut b = [0];
+        match self.inner.read(&mut b)
+        {
+        Ok(1) => Some(b[0]),
+        Ok(0) => panic!("Unexpected EOF reading from stdin"),
+        Ok(_) => panic!("Bad byte count"),
+        Err(e) => panic!("Error reading from stdin - {}", e),
+        }
     }
-    impl<R: ::std::io::Read> Reader<R> {
-        fn getb(&mut self) -> Option<u8> {
-            let mut b = [0];
-            match self.inner.read(&mut b)
-            {
-            Ok(1) => Some(b[0]),
-            Ok(0) => panic!("Unexpected EOF reading from stdin"),
-            Ok(_) => panic!("Bad byte count"),
-            Err(e) => panic!("Error reading from stdin - {}", e),
+    fn get_u128v(&mut self) -> u128 {
+        let mut ofs = 0;
+        let mut raw_rv = 0u128;
+        loop
+        {
+            let b = self.getb().unwrap();
+            raw_rv |= ((b & 0x7F) as u128) << ofs;
+            if b < 128 {
+                break;
             }
+            assert!(ofs < 18*7);  // at most 18 bytes needed for a i128
+            ofs += 7;
         }
-        fn get_u128v(&mut self) -> u128 {
-            let mut ofs = 0;
-            let mut raw_rv = 0u128;
-            loop
-            {
-                let b = self.getb().unwrap();
-                raw_rv |= ((b & 0x7F) as u128) << ofs;
-                if b < 128 {
-                    break;
-                }
-                assert!(ofs < 18*7);  // at most 18 bytes needed for a i128
-                ofs += 7;
-            }
-            raw_rv
+        raw_rv
+    }
+    fn get_i128v(&mut self) -> i128 {
+        let raw_rv = self.get_u128v();
+        // Zig-zag encoding (0 = 0, 1 = -1, 2 = 1, ...)
+        if raw_rv & 1 != 0 {
+            -( (raw_rv >> 1) as i128 + 1 )
         }
-        fn get_i128v(&mut self) -> i128 {
-            let raw_rv = self.get_u128v();
-            // Zig-zag encoding (0 = 0, 1 = -1, 2 = 1, ...)
-            if raw_rv & 1 != 0 {
-                -( (raw_rv >> 1) as i128 + 1 )
-            }
-            else {
-                (raw_rv >> 1) as i128
-            }
+        else {
+            (raw_rv >> 1) as i128
         }
-        fn get_byte_vec(&mut self) -> Vec<u8> {
-            let size = self.get_u128v();
-            assert!(size < (1<<30));
-            let size = size as usize;
-            let mut buf = vec![0u8; size];
-            match self.inner.read_exact(&mut buf)
-            {
-            Ok(_) => {},
-            Err(e) => panic!("Error reading from stdin get_byte_vec({}) - {}", size, e),
-            }
-
-            buf
+    }
+    fn get_byte_vec(&mut self) -> Vec<u8> {
+        let size = self.get_u128v();
+        assert!(size < (1<<30));
+        let size = size as usize;
+        let mut buf = vec![0u8; size];
+        match self.inner.read_exact(&mut buf)
+        {
+        Ok(_) => {},
+        Err(e) => panic!("Error reading from stdin get_byte_vec({}) - {}", size, e),
         }
-        fn get_string(&mut self) -> String {
-            let raw = self.get_byte_vec();
-            String::from_utf8(raw).expect("Invalid UTF-8 passed from compiler")
+
+        buf
+    }
+    fn get_string(&mut self) -> String {
+        let raw = self.get_byte_vec();
+        String::from_utf8(raw).expect("Invalid UTF-8 passed from compiler")
+    }
+    fn get_f64(&mut self) -> f64 {
+        let mut buf = [0u8; 8];
+        match self.inner.read_exact(&mut buf)
+        {
+        Ok(_) => {},
+        Err(e) => panic!("Error reading from stdin - {}", e),
         }
-        fn get_f64(&mut self) -> f64 {
-            let mut buf = [0u8; 8];
-            match self.inner.read_exact(&mut buf)
-            {
-            Ok(_) => {},
-            Err(e) => panic!("Error reading from stdin - {}", e),
-            }
-            unsafe {
-                ::std::mem::transmute(buf)
-            }
+        unsafe {
+            ::std::mem::transmute(buf)
         }
     }
 
-    let mut s = Reader { inner: ::std::io::stdin().lock() };
-    let mut toks = Vec::new();
-    loop
-    {
-        let hdr_b = some_else!( s.getb() => break );
-        toks.push(match hdr_b
-            {
-            0 => {
-                let sym = s.get_string();
-                if sym == "" { break ; }
-                Token::Symbol( sym )
-                },
-            1 => Token::Ident( s.get_string() ),
-            2 => Token::Lifetime( s.get_string() ),
-            3 => Token::String( s.get_string() ),
-            4 => Token::ByteString( s.get_byte_vec() ),
-            5 => Token::CharLit(::std::char::from_u32(s.get_i128v() as u32).expect("char lit")),
-            6 => {
-                let ty = s.getb().expect("getb int ty");
-                Token::UnsignedInt(s.get_u128v(), ty)
-                },
-            7 => {
-                let ty = s.getb().expect("getb int ty");
-                Token::SignedInt(s.get_i128v(), ty)
-                },
-            8 => {
-                let ty = s.getb().expect("getb float ty");
-                Token::Float(s.get_f64(), ty)
-                }
-            });
-        //eprintln!("> {:?}\r", toks.last().unwrap());
-    }
-    TokenStream {
-        inner: toks,
+    fn get_token_stream(&mut self) -> TokenStream {
+        let mut toks = Vec::new();
+        loop
+        {
+            let hdr_b = some_else!( self.getb() => break );
+            toks.push(match hdr_b
+                {
+                0 => {
+                    let sym = self.get_string();
+                    if sym == "" { break ; }
+                    Token::Symbol( sym )
+                    },
+                1 => Token::Ident( self.get_string() ),
+                2 => Token::Lifetime( self.get_string() ),
+                3 => Token::String( self.get_string() ),
+                4 => Token::ByteString( self.get_byte_vec() ),
+                5 => Token::CharLit(::std::char::from_u32(self.get_i128v() as u32).expect("char lit")),
+                6 => {
+                    let ty = self.getb().expect("getb int ty");
+                    Token::UnsignedInt(self.get_u128v(), ty)
+                    },
+                7 => {
+                    let ty = self.getb().expect("getb int ty");
+                    Token::SignedInt(self.get_i128v(), ty)
+                    },
+                8 => {
+                    let ty = self.getb().expect("getb float ty");
+                    Token::Float(self.get_f64(), ty)
+                    }
+                });
+            //eprintln!("> {:?}\r", toks.last().unwrap());
         }
+        TokenStream {
+            inner: toks,
+            }
+    }
 }
-/// Send a token stream back to the compiler
-pub fn send_token_stream(ts: TokenStream)
-{
-    struct Writer<T> {
-        inner: T,
+struct Writer<T> {
+    inner: T,
+}
+impl<T: ::std::io::Write> Writer<T> {
+    fn putb(&mut self, v: u8) {
+        let buf = [v];
+        self.inner.write_all(&buf).expect("");
     }
-    impl<T: ::std::io::Write> Writer<T> {
-        fn putb(&mut self, v: u8) {
-            let buf = [v];
-            self.inner.write(&buf).expect("");
-        }
-        fn put_u128v(&mut self, mut v: u128) {
-            while v > 128 {
-                self.putb( (v & 0x7F) as u8 | 0x80 );
-                v >>= 7;
-            }
-            self.putb( (v & 0x7F) as u8 );
-        }
-        fn put_i128v(&mut self, v: i128) {
-            if v < 0 {
-                self.put_u128v( (((v + 1) as u128) << 1) | 1 );
-            }
-            else {
-                self.put_u128v( (v as u128) << 1 );
-            }
+    fn put_u128v(&mut self, mut v: u128) {
+        while v >= 128 {
+            self.putb( (v & 0x7F) as u8 | 0x80 );
+            v >>= 7;
         }
-        fn put_bytes(&mut self, v: &[u8]) {
-            self.put_u128v(v.len() as u128);
-            self.inner.write(v).expect("");
+        self.putb( (v & 0x7F) as u8 );
+    }
+    fn put_i128v(&mut self, v: i128) {
+        if v < 0 {
+            self.put_u128v( (((v + 1) as u128) << 1) | 1 );
         }
-        fn put_f64(&mut self, v: f64) {
-            let buf: [u8; 8] = unsafe { ::std::mem::transmute(v) };
-            self.inner.write(&buf).expect("");
+        else {
+            self.put_u128v( (v as u128) << 1 );
         }
     }
+    fn put_bytes(&mut self, v: &[u8]) {
+        self.put_u128v(v.len() as u128);
+        self.inner.write_all(v).expect("");
+    }
+    fn put_f64(&mut self, v: f64) {
+        let buf: [u8; 8] = unsafe { ::std::mem::transmute(v) };
+        self.inner.write_all(&buf).expect("");
+    }
 
-    let mut s = Writer { inner: ::std::io::stdout().lock() };
-
-    for t in &ts.inner
-    {
-        //eprintln!("{:?}\r", t);
-        match t
+    fn put_token_stream(&mut self, ts: &TokenStream) {
+        for t in &ts.inner
         {
-        &Token::Symbol(ref v)   => { s.putb(0); s.put_bytes(v.as_bytes()); },
-        &Token::Ident(ref v)    => { s.putb(1); s.put_bytes(v.as_bytes()); },
-        &Token::Lifetime(ref v) => { s.putb(2); s.put_bytes(v.as_bytes()); },
-        &Token::String(ref v)      => { s.putb(3); s.put_bytes(v.as_bytes()); },
-        &Token::ByteString(ref v)  => { s.putb(4); s.put_bytes(&v[..]); },
-        &Token::CharLit(v)         => { s.putb(5); s.put_u128v(v as u32 as u128); },
-        &Token::UnsignedInt(v, sz) => { s.putb(6); s.putb(sz); s.put_u128v(v); },
-        &Token::SignedInt(v, sz)   => { s.putb(7); s.putb(sz); s.put_i128v(v); },
-        &Token::Float(v, sz)       => { s.putb(8); s.putb(sz); s.put_f64(v); },
-        &Token::Fragment(ty, key)  => { s.putb(9); s.putb(ty as u8); s.put_u128v(key as u128); },
+            //eprintln!("{:?}\r", t);
+            match t
+            {
+            &Token::Symbol(ref v)   => { self.putb(0); self.put_bytes(v.as_bytes()); },
+            &Token::Ident(ref v)    => { self.putb(1); self.put_bytes(v.as_bytes()); },
+            &Token::Lifetime(ref v) => { self.putb(2); self.put_bytes(v.as_bytes()); },
+            &Token::String(ref v)      => { self.putb(3); self.put_bytes(v.as_bytes()); },
+            &Token::ByteString(ref v)  => { self.putb(4); self.put_bytes(&v[..]); },
+            &Token::CharLit(v)         => { self.putb(5); self.put_u128v(v as u32 as u128); },
+            &Token::UnsignedInt(v, sz) => { self.putb(6); self.putb(sz); self.put_u128v(v); },
+            &Token::SignedInt(v, sz)   => { self.putb(7); self.putb(sz); self.put_i128v(v); },
+            &Token::Float(v, sz)       => { self.putb(8); self.putb(sz); self.put_f64(v); },
+            &Token::Fragment(ty, key)  => { self.putb(9); self.putb(ty as u8); self.put_u128v(key as u128); },
+            }
         }
+
+        // Empty symbol indicates EOF
+        self.putb(0); self.putb(0);
     }
+}
 
-    // Empty symbol indicates EOF
-    s.putb(0); s.putb(0);
-    drop(s);
-    ::std::io::Write::flush(&mut ::std::io::stdout());
+/// Receive a token stream from the compiler
+pub fn recv_token_stream() -> TokenStream
+{
+    let stdin = ::std::io::stdin();
+    let mut s = Reader { inner: stdin.lock() };
+    s.get_token_stream()
+}
+/// Send a token stream back to the compiler
+pub fn send_token_stream(ts: TokenStream)
+{
+    let stdout = ::std::io::stdout();
+    let mut s = Writer { inner: ::std::io::BufWriter::new(stdout.lock()) };
+    s.put_token_stream(&ts);
+    ::std::io::Write::flush(&mut s.inner).expect("Error writing to stdout");
 }
 
 pub struct MacroDesc
@@ -679,11 +686,80 @@ pub struct MacroDesc
     handler: fn(TokenStream)->TokenStream,
 }
 
+/// Read a frame (32-bit little-endian length, then the data), returns `None` if the compiler has closed the pipe
+fn read_frame<R: ::std::io::Read>(r: &mut R) -> Option<Vec<u8>>
+{
+    let mut len_buf = [0u8; 4];
+    match r.read(&mut len_buf[..1])
+    {
+    Ok(0) => return None,
+    Ok(_) => {},
+    Err(e) => panic!("Error reading from stdin - {}", e),
+    }
+    r.read_exact(&mut len_buf[1..]).expect("Error reading frame length");
+    let len = (len_buf[0] as usize) | (len_buf[1] as usize) << 8 | (len_buf[2] as usize) << 16 | (len_buf[3] as usize) << 24;
+    let mut buf = vec![0u8; len];
+    r.read_exact(&mut buf).expect("Error reading frame");
+    Some(buf)
+}
+fn write_frame<W: ::std::io::Write>(w: &mut W, data: &[u8])
+{
+    let len = data.len() as u32;
+    let len_buf = [len as u8, (len >> 8) as u8, (len >> 16) as u8, (len >> 24) as u8];
+    w.write_all(&len_buf).expect("Error writing to stdout");
+    w.write_all(data).expect("Error writing to stdout");
+    w.flush().expect("Error writing to stdout");
+}
+
+/// Handle invocations until stdin is closed (saves the compiler spawning a process for every use of a macro)
+///
+/// Requests are a frame containing the macro name and then the input token stream, responses are a frame containing a
+/// status byte (0 = success, 1 = unknown macro) and then the output token stream.
+fn run_server(macros: &[MacroDesc])
+{
+    use std::io::Write;
+    let stdin = ::std::io::stdin();
+    let stdout = ::std::io::stdout();
+    let mut input = stdin.lock();
+    let mut output = stdout.lock();
+    // Ready signal (the single-invocation mode sends 0)
+    output.write_all(&[1]).expect("Error writing to stdout");
+    output.flush().expect("Error writing to stdout");
+
+    let mut response = Vec::new();
+    while let Some(request) = read_frame(&mut input)
+    {
+        let mut s = Reader { inner: &request[..] };
+        let mac_name = s.get_string();
+        response.clear();
+        match macros.iter().find(|m| m.name == mac_name)
+        {
+        Some(m) => {
+            let input = s.get_token_stream();
+            debug!("{}: INPUT = `{}`\r", mac_name, input);
+            let output = (m.handler)( input );
+            debug!("{}: OUTPUT = `{}`\r", mac_name, output);
+            response.push(0);
+            Writer { inner: &mut response }.put_token_stream(&output);
+            },
+        None => {
+            note!("Unknown macro name '{}'", mac_name);
+            response.push(1);
+            },
+        }
+        write_frame(&mut output, &response);
+    }
+    note!("Done");
+}
+
 pub fn main(macros: &[MacroDesc])
 {
     //::env_logger::init();
 
     let mac_name = ::std::env::args().nth(1).expect("Was not passed a macro name");
+    if mac_name == "--server" {
+        return run_server(macros);
+    }
     //eprintln!("Searching for macro {}\r", mac_name);
     for m in macros
     {
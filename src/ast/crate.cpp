@@ -32,6 +32,12 @@ namespace {
         }
         return true;
     }
+    /// Check if a crate can be loaded from `path`
+    /// - Only the metadata (`.hir`) is needed, so a pipelined build can start before the library itself is written.
+    bool crate_file_exists(const ::std::string& path)
+    {
+        return ::std::ifstream(path).good() || ::std::ifstream(path + ".hir").good();
+    }
     void iterate_module(::AST::Module& mod, ::std::function<void(::AST::Module& mod)> fcn)
     {
         fcn(mod);
@@ -135,7 +141,7 @@ RcString Crate::load_extern_crate(Span sp, const RcString& name, const ::std::st
     if(basename == "" && it != g_crate_overrides.end())
     {
         path = it->second;
-        if( !::std::ifstream(path).good() ) {
+        if( !crate_file_exists(path) ) {
             ERROR(sp, E0000, "Unable to open crate '" << name << "' at path " << path);
         }
         DEBUG("path = " << path << " (--extern)");
@@ -155,7 +161,7 @@ RcString Crate::load_extern_crate(Span sp, const RcString& name, const ::std::st
             }
         }
 #endif
-        if( !::std::ifstream(path).good() ) {
+        if( !crate_file_exists(path) ) {
             ERROR(sp, E0000, "Unable to locate crate '" << name << "' with filename " << basename << " in search directories");
         }
         DEBUG("path = " << path << " (basename)");
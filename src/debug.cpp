@@ -12,9 +12,19 @@
 #include <iomanip>
 #include <common.hpp>   // FmtEscaped
 #include <cstring>	// strchr
+#include <cstdlib>	// malloc/free, atexit
+#include <fstream>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#ifndef _WIN32
+# include <sys/resource.h>	// getrusage
+# include <unistd.h>	// sysconf
+#endif
 
 
-int g_debug_indent_level = 0;
+thread_local int g_debug_indent_level = 0;
+thread_local ::std::ostream* g_debug_capture = nullptr;
 bool g_debug_enabled = true;
 ::std::string g_cur_phase;
 ::std::set< ::std::string>    g_debug_disable_map;
@@ -79,27 +89,326 @@ bool debug_enabled()
 }
 ::std::ostream& debug_output(int indent, const char* function)
 {
-    return ::std::cout << g_cur_phase << "- " << RepeatLitStr { " ", indent } << function << ": ";
+    return debug_stream() << g_cur_phase << "- " << RepeatLitStr { " ", indent } << function << ": ";
+}
+
+::std::ostream& debug_stream()
+{
+    return g_debug_capture ? *g_debug_capture : ::std::cout;
+}
+
+DebugCapture::DebugCapture():
+    m_saved(g_debug_capture),
+    m_saved_indent(g_debug_indent_level)
+{
+    g_debug_capture = &m_buffer;
+    g_debug_indent_level = 0;
+}
+DebugCapture::~DebugCapture()
+{
+    g_debug_capture = m_saved;
+    g_debug_indent_level = m_saved_indent;
+}
+
+// Allocation count, for the per-phase statistics
+// - Global `new`/`delete` are replaced so every allocation is counted
+// - Only counted when timings are being recorded, and counted per-thread (flushed in batches, and when the thread
+//   exits) so the allocating threads don't all contend on the shared counter
+static bool s_count_allocations = false;
+static ::std::atomic<unsigned long> s_allocation_count { 0 };
+namespace {
+    struct ThreadAllocationCount
+    {
+        static const unsigned long FLUSH_INTERVAL = 1024;
+        unsigned long   pending = 0;
+
+        ~ThreadAllocationCount() {
+            flush();
+        }
+        void inc() {
+            if( ++pending == FLUSH_INTERVAL )
+                flush();
+        }
+        void flush() {
+            s_allocation_count.fetch_add(pending, ::std::memory_order_relaxed);
+            pending = 0;
+        }
+    };
+    thread_local ThreadAllocationCount  t_allocation_count;
+
+    /// Total allocations so far (exact for the calling thread, finished threads have flushed their counts)
+    unsigned long get_allocation_count()
+    {
+        t_allocation_count.flush();
+        return s_allocation_count.load(::std::memory_order_relaxed);
+    }
+}
+void* operator new(size_t size)
+{
+    if( s_count_allocations )
+        t_allocation_count.inc();
+    if( size == 0 )
+        size = 1;
+    if( void* rv = ::std::malloc(size) )
+        return rv;
+    throw ::std::bad_alloc();
+}
+void* operator new[](size_t size)
+{
+    return ::operator new(size);
+}
+void operator delete(void* ptr) noexcept { ::std::free(ptr); }
+void operator delete[](void* ptr) noexcept { ::std::free(ptr); }
+void operator delete(void* ptr, size_t ) noexcept { ::std::free(ptr); }
+void operator delete[](void* ptr, size_t ) noexcept { ::std::free(ptr); }
+
+static DebugCounter* s_first_counter = nullptr;
+static DebugCounter** s_last_counter_next = &s_first_counter;
+DebugCounter::DebugCounter(const char* name):
+    m_name(name),
+    m_value(0),
+    m_next(nullptr)
+{
+    // Append, so counters are reported in declaration order
+    *s_last_counter_next = this;
+    s_last_counter_next = &m_next;
+}
+void DebugCounter::report_and_reset(::std::ostream& os, ::std::vector< ::std::pair<const char*, unsigned long> >* out/*=nullptr*/)
+{
+    for(auto* c = s_first_counter; c; c = c->m_next)
+    {
+        auto v = c->m_value.exchange(0);
+        if( v != 0 )
+        {
+            os << "- " << c->m_name << ": " << v << ::std::endl;
+            if( out )
+                out->push_back(::std::make_pair(c->m_name, v));
+        }
+    }
+}
+
+namespace {
+    /// Current resident set size (in KiB)
+    unsigned long get_current_rss_kb()
+    {
+#ifdef __linux__
+        ::std::ifstream is("/proc/self/statm");
+        unsigned long size = 0, resident = 0;
+        if( is >> size >> resident )
+            return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+        return 0;
+    }
+    /// Peak resident set size (in KiB)
+    unsigned long get_peak_rss_kb()
+    {
+#ifndef _WIN32
+        struct rusage   ru;
+        if( getrusage(RUSAGE_SELF, &ru) == 0 )
+        {
+# ifdef __APPLE__
+            return ru.ru_maxrss / 1024; // Bytes on macOS
+# else
+            return ru.ru_maxrss;
+# endif
+        }
+#endif
+        return 0;
+    }
+}
+
+// Number of items kept in the per-phase hot spot list
+static const size_t TIMINGS_HOT_ITEM_COUNT = 20;
+struct DebugPhaseRecord
+{
+    const char* name = "";
+    // NOTE: Left as zero if the phase didn't complete (e.g. the compiler exited early)
+    double  cpu_s = 0;
+    double  wall_s = 0;
+    unsigned long   rss_kb = 0;
+    unsigned long   peak_rss_kb = 0;
+    unsigned long   allocations = 0;
+    ::std::vector< ::std::pair<const char*, unsigned long> >    counters;
+
+    // Slowest items, sorted by decreasing time (can be written by worker threads)
+    ::std::mutex    hot_items_lock;
+    ::std::vector< ::std::pair<double, ::std::string> > hot_items;
+};
+static ::std::string    s_timings_json_path;
+static ::std::deque<DebugPhaseRecord>   s_phase_records;
+static DebugPhaseRecord*    s_cur_phase_record = nullptr;
+
+namespace {
+    void write_json_string(::std::ostream& os, const char* s)
+    {
+        os << '"';
+        for(; *s; s ++)
+        {
+            switch(*s)
+            {
+            case '"':   os << "\\\"";  break;
+            case '\\':  os << "\\\\";  break;
+            case '\n':  os << "\\n";   break;
+            case '\t':  os << "\\t";   break;
+            default:
+                if( static_cast<unsigned char>(*s) < 0x20 ) {
+                    os << "\\u" << ::std::hex << ::std::setw(4) << ::std::setfill('0') << static_cast<unsigned>(*s) << ::std::dec << ::std::setfill(' ');
+                }
+                else {
+                    os << *s;
+                }
+                break;
+            }
+        }
+        os << '"';
+    }
+    void write_timings_json()
+    {
+        ::std::ofstream os(s_timings_json_path);
+        if( !os.good() )
+        {
+            ::std::cerr << "Unable to open " << s_timings_json_path << " for writing" << ::std::endl;
+            return ;
+        }
+        os << ::std::fixed << ::std::setprecision(6);
+        os << "{\n";
+        os << "  \"phases\": [";
+        bool first_phase = true;
+        for(const auto& r : s_phase_records)
+        {
+            os << (first_phase ? "\n" : ",\n");
+            first_phase = false;
+            os << "    {\n";
+            os << "      \"name\": "; write_json_string(os, r.name); os << ",\n";
+            os << "      \"cpu_s\": " << r.cpu_s << ",\n";
+            os << "      \"wall_s\": " << r.wall_s << ",\n";
+            os << "      \"rss_kb\": " << r.rss_kb << ",\n";
+            os << "      \"peak_rss_kb\": " << r.peak_rss_kb << ",\n";
+            os << "      \"allocations\": " << r.allocations << ",\n";
+            os << "      \"counters\": {";
+            for(size_t i = 0; i < r.counters.size(); i ++)
+            {
+                os << (i == 0 ? "" : ", ");
+                write_json_string(os, r.counters[i].first);
+                os << ": " << r.counters[i].second;
+            }
+            os << "},\n";
+            os << "      \"hot_items\": [";
+            for(size_t i = 0; i < r.hot_items.size(); i ++)
+            {
+                os << (i == 0 ? "\n" : ",\n");
+                os << "        { \"name\": "; write_json_string(os, r.hot_items[i].second.c_str());
+                os << ", \"wall_s\": " << r.hot_items[i].first << " }";
+            }
+            os << (r.hot_items.empty() ? "]\n" : "\n      ]\n");
+            os << "    }";
+        }
+        os << "\n  ]\n";
+        os << "}\n";
+    }
+}
+void debug_enable_timings_json(const ::std::string& path)
+{
+    if( s_timings_json_path.empty() )
+    {
+        ::std::atexit(write_timings_json);
+    }
+    s_timings_json_path = path;
+    // NOTE: Set before any worker threads are started
+    s_count_allocations = true;
+}
+bool debug_timings_enabled()
+{
+    return !s_timings_json_path.empty();
 }
 
 DebugTimedPhase::DebugTimedPhase(const char* name):
-    m_name(name)
+    m_name(name),
+    m_record(nullptr),
+    m_parent_record(s_cur_phase_record)
 {
     ::std::cout << m_name << ": V V V" << ::std::endl;
     g_cur_phase = m_name;
     g_debug_enabled = debug_enabled_update();
+    if( debug_timings_enabled() )
+    {
+        // NOTE: Records are in start order (so nested phases come after their parent)
+        s_phase_records.emplace_back();
+        m_record = &s_phase_records.back();
+        m_record->name = m_name;
+        s_cur_phase_record = m_record;
+    }
+    m_allocations_start = get_allocation_count();
+    m_wall_start = ::std::chrono::steady_clock::now();
     m_start = clock();
 }
 DebugTimedPhase::~DebugTimedPhase()
 {
     auto end = clock();
+    auto wall_end = ::std::chrono::steady_clock::now();
+    auto allocations = get_allocation_count() - m_allocations_start;
     g_cur_phase = "";
     g_debug_enabled = debug_enabled_update();
 
-    // TODO: Show wall time too?
-    ::std::cout << "(" << ::std::fixed << ::std::setprecision(2) << static_cast<double>(end - m_start) / static_cast<double>(CLOCKS_PER_SEC) << " s) ";
+    double cpu_s = static_cast<double>(end - m_start) / static_cast<double>(CLOCKS_PER_SEC);
+    double wall_s = ::std::chrono::duration<double>(wall_end - m_wall_start).count();
+    auto peak_rss_kb = get_peak_rss_kb();
+    ::std::cout << "(" << ::std::fixed << ::std::setprecision(2) << cpu_s << " s, " << wall_s << " s wall";
+    if( peak_rss_kb > 0 )
+        ::std::cout << ", " << (peak_rss_kb / 1024) << " MB peak";
+    ::std::cout << ") ";
     ::std::cout << m_name << ": DONE";
     ::std::cout << ::std::endl;
+    if( m_record )
+    {
+        m_record->cpu_s = cpu_s;
+        m_record->wall_s = wall_s;
+        m_record->rss_kb = get_current_rss_kb();
+        m_record->peak_rss_kb = peak_rss_kb;
+        m_record->allocations = allocations;
+        DebugCounter::report_and_reset(::std::cout, &m_record->counters);
+        s_cur_phase_record = m_parent_record;
+    }
+    else
+    {
+        DebugCounter::report_and_reset(::std::cout);
+    }
+}
+
+DebugTimedItem::DebugTimedItem(::std::function<void(::std::ostream&)> name_cb)
+{
+    if( s_cur_phase_record )
+    {
+        m_name_cb = ::std::move(name_cb);
+        m_start = ::std::chrono::steady_clock::now();
+    }
+}
+DebugTimedItem::~DebugTimedItem()
+{
+    auto* r = s_cur_phase_record;
+    if( !r || !m_name_cb )
+        return ;
+    double t = ::std::chrono::duration<double>(::std::chrono::steady_clock::now() - m_start).count();
+
+    auto is_hot = [&]() {
+        return r->hot_items.size() < TIMINGS_HOT_ITEM_COUNT || r->hot_items.back().first < t;
+        };
+    {
+        ::std::lock_guard<::std::mutex> lh(r->hot_items_lock);
+        if( !is_hot() )
+            return ;
+    }
+    // Only format the name if it'll (probably) be kept
+    ::std::stringstream ss;
+    m_name_cb(ss);
+
+    ::std::lock_guard<::std::mutex> lh(r->hot_items_lock);
+    if( !is_hot() )
+        return ;
+    auto it = ::std::find_if(r->hot_items.begin(), r->hot_items.end(), [&](const auto& e){ return e.first < t; });
+    r->hot_items.insert(it, ::std::make_pair(t, ss.str()));
+    if( r->hot_items.size() > TIMINGS_HOT_ITEM_COUNT )
+        r->hot_items.pop_back();
 }
 
 extern void debug_init_phases(const char* env_var_name, std::initializer_list<const char*> il)
@@ -14,6 +14,9 @@
 #include <hir/hir.hpp>  // ABI_RUST
 #include "proc_macro.hpp"
 #include <parse/lex.hpp>
+#include <debug_inner.hpp>  // DebugTimedItem
+#include <chrono>
+#include <iomanip>
 #ifdef _WIN32
 # define NOMINMAX
 # define NOGDI  // Don't include GDI functions (defines some macros that collide with mrustc ones)
@@ -22,6 +25,7 @@
 # include <unistd.h>    // read/write/pipe
 # include <spawn.h>
 # include <sys/wait.h>
+# include <fcntl.h>
 #endif
 
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__DragonFly__) || defined(__APPLE__)
@@ -156,28 +160,73 @@ enum class FragType
     Block = 6,
     Pattern = 7,
 };
-struct ProcMacroInv:
-    public TokenStream
+/// A running proc-macro executable, connected via its stdin/stdout
+class ProcMacroChild
 {
-    Span    m_parent_span;
-    const ::HIR::ProcMacro& m_proc_macro_desc;
-    ::std::ofstream m_dump_file;
-
 #ifdef _WIN32
     HANDLE  child_handle;
     HANDLE  child_stdin;
     HANDLE  child_stdout;
 #else
     // POSIX
-    pid_t   child_pid;  // Questionably needed
+    pid_t   child_pid;
      int    child_stdin;
      int    child_stdout;
     // NOTE: stderr stays as our stderr
 #endif
+    // Reads are buffered, the protocol is mostly single bytes
+    char    m_read_buf[4096];
+    size_t  m_read_pos = 0;
+    size_t  m_read_len = 0;
+
+public:
+    ProcMacroChild(const Span& sp, const char* executable, const char* arg);
+    ProcMacroChild(const ProcMacroChild&) = delete;
+    ProcMacroChild& operator=(const ProcMacroChild&) = delete;
+    /// Closes the child's stdin (which stops a server) and waits for it to exit
+    ~ProcMacroChild();
+
+    bool write_all(const void* data, size_t len);
+    /// Read exactly `len` bytes, returns false on EOF/error
+    bool read_exact(void* data, size_t len);
+    /// Read until the child closes its stdout
+    void read_to_end(::std::string& out);
+private:
+    bool fill_buffer();
+};
+/// Per-executable state: the long-lived server process (if supported) and expansion statistics
+struct ProcMacroServer
+{
+    RcString    crate_name;
+    /// `nullptr` if the executable predates server mode, in which case a process is spawned per invocation
+    ::std::unique_ptr<ProcMacroChild>   child;
+
+    unsigned    invocations = 0;
+    double  startup_s = 0;
+    double  expand_s = 0;
+};
+
+struct ProcMacroInv:
+    public TokenStream
+{
+    Span    m_parent_span;
+    const ::HIR::ProcMacro& m_proc_macro_desc;
+    ::std::ofstream m_dump_file;
+
+    ProcMacroServer*    m_server;
+    // Child for just this invocation (when the executable doesn't support server mode)
+    ::std::unique_ptr<ProcMacroChild>   m_child;
+
+    // The input is sent as a single write in `send_done`
+    // - In server mode this is a request frame, starting with the frame length and the macro name
+    ::std::string   m_send_buf;
+    size_t  m_send_start = 0;
+    ::std::string   m_recv_buf;
+    size_t  m_recv_pos = 0;
     bool    m_eof_hit = false;
 
 public:
-    ProcMacroInv(const Span& sp, const char* executable, const ::HIR::ProcMacro& proc_macro_desc);
+    ProcMacroInv(const Span& sp, ProcMacroServer& server, const char* executable, const ::HIR::ProcMacro& proc_macro_desc);
     ProcMacroInv(const ProcMacroInv&) = delete;
     ProcMacroInv(ProcMacroInv&&);
     ProcMacroInv& operator=(const ProcMacroInv&) = delete;
@@ -185,10 +234,8 @@ public:
     virtual ~ProcMacroInv();
 
     bool check_good();
-    void send_done() {
-        send_symbol("");
-        DEBUG("Input tokens sent");
-    }
+    /// Send the buffered input to the child, and read back the entire output
+    void send_done();
     void send_symbol(const char* val) {
         this->send_u8(static_cast<uint8_t>(TokenClass::Symbol));
         this->send_bytes(val, ::std::strlen(val));
@@ -229,6 +276,45 @@ private:
     uint64_t recv_v128u();
 };
 
+namespace {
+    // Proc macro executables, started on first use and kept running until `ProcMacro_StopServers`
+    ::std::map< ::std::string, ProcMacroServer>  s_proc_macro_servers;
+
+    ProcMacroServer& get_proc_macro_server(const Span& sp, const ::std::string& executable, const RcString& crate_name)
+    {
+        auto it = s_proc_macro_servers.find(executable);
+        if( it != s_proc_macro_servers.end() )
+            return it->second;
+
+        auto& srv = s_proc_macro_servers[executable];
+        srv.crate_name = crate_name;
+        auto start = ::std::chrono::steady_clock::now();
+        srv.child.reset(new ProcMacroChild(sp, executable.c_str(), "--server"));
+        // A server signals that it's ready with a 1 byte (the single-invocation mode uses 0)
+        uint8_t v = 0;
+        if( !srv.child->read_exact(&v, 1) || v != 1 )
+        {
+            DEBUG("`" << executable << "` doesn't support server mode (" << (int)v << "), spawning once per invocation");
+            srv.child.reset();
+        }
+        srv.startup_s += ::std::chrono::duration<double>(::std::chrono::steady_clock::now() - start).count();
+        return srv;
+    }
+}
+
+void ProcMacro_StopServers()
+{
+    for(auto& e : s_proc_macro_servers)
+    {
+        auto& srv = e.second;
+        ::std::cout << "proc-macro " << srv.crate_name << ": " << srv.invocations << " invocations, "
+            << ::std::fixed << ::std::setprecision(2) << srv.expand_s << " s (" << srv.startup_s << " s startup"
+            << (srv.child ? "" : ", no server mode") << ")" << ::std::endl;
+        srv.child.reset();
+    }
+    s_proc_macro_servers.clear();
+}
+
 ProcMacroInv ProcMacro_Invoke_int(const Span& sp, const ::AST::Crate& crate, const ::std::vector<RcString>& mac_path)
 {
     TRACE_FUNCTION_F(mac_path);
@@ -267,7 +353,8 @@ ProcMacroInv ProcMacro_Invoke_int(const Span& sp, const ::AST::Crate& crate, con
     ::std::string   proc_macro_exe_name = ext_crate.m_filename;
 
     // 3. Create ProcMacroInv
-    return ProcMacroInv(sp, proc_macro_exe_name.c_str(), *pmp);
+    auto& server = get_proc_macro_server(sp, proc_macro_exe_name, ext_crate.m_name);
+    return ProcMacroInv(sp, server, proc_macro_exe_name.c_str(), *pmp);
 }
 
 
@@ -835,18 +922,10 @@ namespace {
     return box$(pmi);
 }
 
-ProcMacroInv::ProcMacroInv(const Span& sp, const char* executable, const ::HIR::ProcMacro& proc_macro_desc):
-    TokenStream(ParseState(AST::Edition::Rust2015)), // TODO: Pull edition from the macro
-    m_parent_span(sp),
-    m_proc_macro_desc(proc_macro_desc)
+ProcMacroChild::ProcMacroChild(const Span& sp, const char* executable, const char* arg)
 {
-    // TODO: Optionally dump the data sent to the client.
-    if( getenv("MRUSTC_DUMP_PROCMACRO") )
-    {
-        m_dump_file.open( getenv("MRUSTC_DUMP_PROCMACRO"), ::std::ios::out | ::std::ios::binary );
-    }
 #ifdef _WIN32
-    std::string commandline = std::string{ executable } + " " + proc_macro_desc.name.c_str();
+    std::string commandline = std::string{ executable } + " " + arg;
     DEBUG(commandline);
 
     HANDLE stdin_read = INVALID_HANDLE_VALUE;
@@ -912,6 +991,9 @@ ProcMacroInv::ProcMacroInv(const Span& sp, const char* executable, const ::HIR::
         BUG(sp, "Unable to create stdout pipe pair for proc macro, " << strerror(errno));
     }
     this->child_stdout = stdout_pipes[0]; // Read end
+    // Don't leak these ends into other children (a server would never see EOF on stdin)
+    fcntl(this->child_stdin, F_SETFD, FD_CLOEXEC);
+    fcntl(this->child_stdout, F_SETFD, FD_CLOEXEC);
 
     posix_spawn_file_actions_t  file_actions;
     posix_spawn_file_actions_init(&file_actions);
@@ -922,7 +1004,7 @@ ProcMacroInv::ProcMacroInv(const Span& sp, const char* executable, const ::HIR::
     posix_spawn_file_actions_addclose(&file_actions, stdout_pipes[0]);
     posix_spawn_file_actions_addclose(&file_actions, stdout_pipes[1]);
 
-    char*   argv[3] = { const_cast<char*>(executable), const_cast<char*>(proc_macro_desc.name.c_str()), nullptr };
+    char*   argv[3] = { const_cast<char*>(executable), const_cast<char*>(arg), nullptr };
     DEBUG(argv[0] << " " << argv[1]);
     //char*   envp[] = { nullptr };
     int rv = posix_spawn(&this->child_pid, executable, &file_actions, nullptr, argv, environ);
@@ -938,124 +1020,212 @@ ProcMacroInv::ProcMacroInv(const Span& sp, const char* executable, const ::HIR::
 
 #endif
 }
-ProcMacroInv::ProcMacroInv(ProcMacroInv&& x):
-    TokenStream(x.parse_state()),
-    m_parent_span(x.m_parent_span),
-    m_proc_macro_desc(x.m_proc_macro_desc),
-#ifdef _WIN32
-    child_handle(x.child_handle),
-    child_stdin(x.child_stdin),
-    child_stdout(x.child_stdout)
-#else
-    child_pid(x.child_pid),
-    child_stdin(x.child_stdin),
-    child_stdout(x.child_stdout)
-#endif
+ProcMacroChild::~ProcMacroChild()
 {
 #ifdef _WIN32
-    x.child_handle = INVALID_HANDLE_VALUE;
-    x.child_stdin = INVALID_HANDLE_VALUE;
-    x.child_stdout = INVALID_HANDLE_VALUE;
+    CloseHandle(this->child_stdin);
+    DEBUG("Waiting for child to terminate");
+    WaitForSingleObject(this->child_handle, INFINITE);
+    CloseHandle(this->child_stdout);
+    CloseHandle(this->child_handle);
 #else
-    x.child_pid = 0;
+    close(this->child_stdin);
+    DEBUG("Waiting for child " << this->child_pid << " to terminate");
+    int status;
+    waitpid(this->child_pid, &status, 0);
+    close(this->child_stdout);
 #endif
-    DEBUG("");
 }
-#if 0
-ProcMacroInv& ProcMacroInv::operator=(ProcMacroInv&& x)
+bool ProcMacroChild::write_all(const void* data, size_t len)
 {
-    m_parent_span = x.m_parent_span;
+    const char* p = static_cast<const char*>(data);
+    while( len > 0 )
+    {
 #ifdef _WIN32
+        DWORD n = 0;
+        if( !WriteFile(this->child_stdin, p, static_cast<DWORD>(len), &n, nullptr) )
+        {
+            DEBUG("Error writing to child, " << GetLastError());
+            return false;
+        }
 #else
-    child_pid = x.child_pid;
-    child_stdin = x.child_stdin;
-    child_stdout = x.child_stdout;
-
-    x.child_pid = 0;
+        auto n = write(this->child_stdin, p, len);
+        if( n < 0 && errno == EINTR )
+            continue;
+        if( n <= 0 )
+        {
+            DEBUG("Error writing to child, " << strerror(errno));
+            return false;
+        }
 #endif
-    DEBUG("");
-    return *this;
+        p += n;
+        len -= n;
+    }
+    return true;
 }
-#endif
-ProcMacroInv::~ProcMacroInv()
+bool ProcMacroChild::fill_buffer()
 {
+    m_read_pos = 0;
+    m_read_len = 0;
 #ifdef _WIN32
-    if( this->child_handle != INVALID_HANDLE_VALUE )
+    DWORD n = 0;
+    if( !ReadFile(this->child_stdout, m_read_buf, sizeof(m_read_buf), &n, nullptr) )
     {
-        DEBUG("Waiting for child to terminate");
-        WaitForSingleObject(this->child_handle, INFINITE);
-        CloseHandle(this->child_stdout);
-        CloseHandle(this->child_stdin);
-        CloseHandle(this->child_handle);
+        DEBUG("Error reading from child, " << GetLastError());
+        return false;
     }
 #else
-    if( this->child_pid != 0 )
+    ssize_t n;
+    do {
+        n = read(this->child_stdout, m_read_buf, sizeof(m_read_buf));
+    } while( n < 0 && errno == EINTR );
+    if( n < 0 )
     {
-        DEBUG("Waiting for child " << this->child_pid << " to terminate");
-        int status;
-        waitpid(this->child_pid, &status, 0);
-        close(this->child_stdout);
-        close(this->child_stdin);
+        DEBUG("Error reading from child, " << strerror(errno));
+        return false;
     }
 #endif
+    m_read_len = n;
+    return n > 0;
 }
-bool ProcMacroInv::check_good()
+bool ProcMacroChild::read_exact(void* data, size_t len)
 {
-    char    v;
-#ifdef _WIN32
-    DWORD rv = 0;
-    if( !ReadFile(this->child_stdout, &v, 1, &rv, nullptr) )
+    char* p = static_cast<char*>(data);
+    while( len > 0 )
     {
-        DEBUG("Error reading from child, " << GetLastError());
-        return false;
+        if( m_read_pos == m_read_len && !this->fill_buffer() )
+            return false;
+        size_t n = ::std::min(len, m_read_len - m_read_pos);
+        memcpy(p, m_read_buf + m_read_pos, n);
+        m_read_pos += n;
+        p += n;
+        len -= n;
     }
-#else
-    int rv = read(this->child_stdout, &v, 1);
-#endif
-    if( rv == 0 )
+    return true;
+}
+void ProcMacroChild::read_to_end(::std::string& out)
+{
+    do {
+        out.append(m_read_buf + m_read_pos, m_read_len - m_read_pos);
+        m_read_pos = m_read_len;
+    } while( this->fill_buffer() );
+}
+
+ProcMacroInv::ProcMacroInv(const Span& sp, ProcMacroServer& server, const char* executable, const ::HIR::ProcMacro& proc_macro_desc):
+    TokenStream(ParseState(AST::Edition::Rust2015)), // TODO: Pull edition from the macro
+    m_parent_span(sp),
+    m_proc_macro_desc(proc_macro_desc),
+    m_server(&server)
+{
+    // TODO: Optionally dump the data sent to the client.
+    if( getenv("MRUSTC_DUMP_PROCMACRO") )
     {
-        DEBUG("Unexpected EOF from child");
-        return false;
+        m_dump_file.open( getenv("MRUSTC_DUMP_PROCMACRO"), ::std::ios::out | ::std::ios::binary );
+    }
+    if( server.child )
+    {
+        // Request frame: 32-bit little-endian length (filled in by `send_done`), then the macro name
+        m_send_buf.append(4, '\0');
+        this->send_bytes(proc_macro_desc.name.c_str(), proc_macro_desc.name.size());
+        // The dump file only gets the token stream (the same as the single-invocation input)
+        m_send_start = m_send_buf.size();
+    }
+    else
+    {
+        auto start = ::std::chrono::steady_clock::now();
+        m_child.reset(new ProcMacroChild(sp, executable, proc_macro_desc.name.c_str()));
+        server.startup_s += ::std::chrono::duration<double>(::std::chrono::steady_clock::now() - start).count();
     }
-#ifndef _WIN32
-    if( rv < 0 )
+}
+ProcMacroInv::ProcMacroInv(ProcMacroInv&& x):
+    TokenStream(x.parse_state()),
+    m_parent_span(x.m_parent_span),
+    m_proc_macro_desc(x.m_proc_macro_desc),
+    m_dump_file(mv$(x.m_dump_file)),
+    m_server(x.m_server),
+    m_child(mv$(x.m_child)),
+    m_send_buf(mv$(x.m_send_buf)),
+    m_send_start(x.m_send_start),
+    m_recv_buf(mv$(x.m_recv_buf)),
+    m_recv_pos(x.m_recv_pos),
+    m_eof_hit(x.m_eof_hit)
+{
+    DEBUG("");
+}
+ProcMacroInv::~ProcMacroInv()
+{
+}
+bool ProcMacroInv::check_good()
+{
+    // A server has already sent its ready signal
+    if( !m_child )
+        return true;
+    uint8_t v;
+    if( !m_child->read_exact(&v, 1) )
     {
-        DEBUG("Error reading from child, rv=" << rv << " " << strerror(errno));
+        DEBUG("Unexpected EOF from child");
         return false;
     }
-#endif
     DEBUG("Child started, value = " << (int)v);
     if( v != 0 )
         return false;
     return true;
 }
-void ProcMacroInv::send_u8(uint8_t v)
+void ProcMacroInv::send_done()
 {
+    send_symbol("");
+    DEBUG("Input tokens buffered");
     if( m_dump_file.is_open() )
-        m_dump_file.put(v);
-#ifdef _WIN32
-    DWORD bytesWritten = 0;
-    if( !WriteFile(this->child_stdin, &v, 1, &bytesWritten, nullptr) || bytesWritten != 1 )
-        BUG(m_parent_span, "Error writing to child, " << GetLastError());
-#else
-    if( write(this->child_stdin, &v, 1) != 1 )
-        BUG(m_parent_span, "Error writing to child, " << strerror(errno));
-#endif
+        m_dump_file.write(m_send_buf.data() + m_send_start, m_send_buf.size() - m_send_start);
+
+    DebugTimedItem  timed_item([&](::std::ostream& os){ os << "proc-macro " << m_server->crate_name << "::" << m_proc_macro_desc.name; });
+    auto start = ::std::chrono::steady_clock::now();
+    if( m_child )
+    {
+        // Single invocation: the child exits once it has sent its output
+        if( !m_child->write_all(m_send_buf.data(), m_send_buf.size()) )
+            BUG(m_parent_span, "Error writing to child process");
+        m_child->read_to_end(m_recv_buf);
+    }
+    else
+    {
+        auto& child = *m_server->child;
+        size_t len = m_send_buf.size() - 4;
+        ASSERT_BUG(m_parent_span, len <= UINT32_MAX, "Oversized proc macro input");
+        for(int i = 0; i < 4; i ++)
+            m_send_buf[i] = static_cast<char>( (len >> (i*8)) & 0xFF );
+        if( !child.write_all(m_send_buf.data(), m_send_buf.size()) )
+            BUG(m_parent_span, "Error writing to proc macro server for " << m_server->crate_name);
+
+        // Response frame: 32-bit little-endian length, status byte (0 = success, 1 = unknown macro), token stream
+        uint8_t len_bytes[4];
+        if( !child.read_exact(len_bytes, 4) )
+            BUG(m_parent_span, "Proc macro server for " << m_server->crate_name << " exited unexpectedly");
+        len = 0;
+        for(int i = 0; i < 4; i ++)
+            len |= static_cast<size_t>(len_bytes[i]) << (i*8);
+        m_recv_buf.resize(len);
+        if( len == 0 || !child.read_exact(&m_recv_buf[0], len) )
+            BUG(m_parent_span, "Proc macro server for " << m_server->crate_name << " exited unexpectedly");
+        if( m_recv_buf[0] != 0 )
+            ERROR(m_parent_span, E0000, "Proc macro `" << m_proc_macro_desc.name << "` not found in " << m_server->crate_name);
+        m_recv_pos = 1;
+    }
+    m_server->invocations += 1;
+    m_server->expand_s += ::std::chrono::duration<double>(::std::chrono::steady_clock::now() - start).count();
+    // Release the memory (and the child) early, the output is consumed later
+    ::std::string().swap(m_send_buf);
+    m_child.reset();
+    DEBUG("Output received (" << m_recv_buf.size() << " bytes)");
+}
+void ProcMacroInv::send_u8(uint8_t v)
+{
+    m_send_buf += static_cast<char>(v);
 }
 void ProcMacroInv::send_bytes(const void* val, size_t size)
 {
     this->send_v128u( static_cast<uint64_t>(size) );
-
-    if( m_dump_file.is_open() )
-        m_dump_file.write( reinterpret_cast<const char*>(val), size);
-#ifdef _WIN32
-    DWORD bytesWritten = 0;
-    if( !WriteFile(this->child_stdin, val, size, &bytesWritten, nullptr) || bytesWritten != size )
-        BUG(m_parent_span, "Error writing to child, " << GetLastError());
-#else
-    if( write(this->child_stdin, val, size) != static_cast<ssize_t>(size) )
-        BUG(m_parent_span, "Error writing to child, " << strerror(errno));
-#endif
+    m_send_buf.append(static_cast<const char*>(val), size);
 }
 void ProcMacroInv::send_v128u(uint64_t val)
 {
@@ -1067,43 +1237,16 @@ void ProcMacroInv::send_v128u(uint64_t val)
 }
 uint8_t ProcMacroInv::recv_u8()
 {
-    uint8_t v;
-#ifdef _WIN32
-    DWORD n;
-    if( !ReadFile(this->child_stdout, &v, 1, &n, nullptr) )
+    if( m_recv_pos >= m_recv_buf.size() )
         BUG(this->m_parent_span, "Unexpected EOF while reading from child process");
-#else
-    if( read(this->child_stdout, &v, 1) != 1 )
-        BUG(this->m_parent_span, "Unexpected EOF while reading from child process");
-#endif
-    return v;
+    return static_cast<uint8_t>(m_recv_buf[m_recv_pos++]);
 }
 ::std::string ProcMacroInv::recv_bytes()
 {
     auto len = this->recv_v128u();
-    ASSERT_BUG(this->m_parent_span, len < SIZE_MAX, "Oversized string from child process");
-    ::std::string   val;
-    val.resize(len);
-    size_t  ofs = 0, rem = len;
-    while( rem > 0 )
-    {
-#ifdef _WIN32
-        DWORD n;
-        ReadFile(this->child_stdout, &val[ofs], rem, &n, nullptr);
-#else
-        auto n = read(this->child_stdout, &val[ofs], rem);
-#endif
-        if( n == 0 ) {
-            BUG(this->m_parent_span, "Unexpected EOF while reading from child process");
-        }
-        if( n < 0 ) {
-            BUG(this->m_parent_span, "Error while reading from child process");
-        }
-        assert(static_cast<size_t>(n) <= rem);
-        ofs += n;
-        rem -= n;
-    }
-
+    ASSERT_BUG(this->m_parent_span, len <= m_recv_buf.size() - m_recv_pos, "Unexpected EOF while reading from child process");
+    ::std::string   val = m_recv_buf.substr(m_recv_pos, len);
+    m_recv_pos += len;
     return val;
 }
 uint64_t ProcMacroInv::recv_v128u()
@@ -27,7 +27,15 @@
         RcString m_crate_name;
         ::std::vector<HIR::TypeRef> m_types;
         ::HIR::serialise::Reader&   m_in;
+
+        // Types first seen within the current lazy block (numbered from `m_lazy_types_base`)
+        bool    m_in_lazy_block = false;
+        size_t  m_lazy_types_base = 0;
+        ::std::vector<HIR::TypeRef> m_lazy_types;
     public:
+        // Loader handed to lazily-loaded MIR (owns this deserialiser)
+        ::std::weak_ptr< ::MIR::FunctionLoader>  m_loader;
+
         HirDeserialiser(::HIR::serialise::Reader& in):
             m_in(in)
         {}
@@ -36,6 +44,7 @@
         ::std::string read_string() { return m_in.read_string(); }
         bool read_bool() { return m_in.read_bool(); }
         size_t deserialise_count() { return m_in.read_count(); }
+        uint64_t deserialise_u64c() { return m_in.read_u64c(); }
 
         template<typename V>
         ::std::map< ::std::string,V> deserialise_strmap()
@@ -308,6 +317,7 @@
             // NOTE: This is set after loading.
             //rv.m_exported = true;
             rv.m_rules = deserialise_vec_c< ::MacroRulesArm>( [&](){ return deserialise_macrorulesarm(); });
+            rv.build_first_token_index();
             rv.m_source_crate = m_in.read_istring();
             if(rv.m_source_crate == "")
             {
@@ -457,12 +467,58 @@
             auto _ = m_in.open_object("HIR::ExprPtr");
             if( m_in.read_bool() )
             {
-                rv.m_mir = deserialise_mir();
+                // MIR is stored out-of-line, and only loaded when first used
+                auto ofs = m_in.read_lazy_block_ref();
+                auto loader = m_loader.lock();
+                assert(loader);
+                rv.m_mir = ::MIR::FunctionPointer(mv$(loader), ofs);
             }
             rv.m_erased_types = deserialise_vec< ::HIR::TypeRef>();
             return rv;
         }
-        ::MIR::FunctionPointer deserialise_mir();
+        /// Decode a block written by `HirSerialiser::serialise_lazy_block`
+        template<typename F>
+        auto deserialise_lazy_block(uint64_t ofs, F cb) -> decltype(cb())
+        {
+            auto _ = m_in.open_lazy_block(ofs);
+            auto saved_in_lazy_block = m_in_lazy_block;
+            auto saved_lazy_types_base = m_lazy_types_base;
+            auto saved_lazy_types = ::std::move(m_lazy_types);
+            m_lazy_types.clear();
+
+            // Types new to the block are numbered following the main table's entries at the point the block was written
+            m_lazy_types_base = m_in.read_u64c();
+            ASSERT_BUG(Span(), m_lazy_types_base <= m_types.size(), "Lazy block type base " << m_lazy_types_base << " larger than type table (" << m_types.size() << ")");
+            m_in_lazy_block = true;
+            auto rv = cb();
+            m_in_lazy_block = saved_in_lazy_block;
+            m_lazy_types_base = saved_lazy_types_base;
+            m_lazy_types = ::std::move(saved_lazy_types);
+            return rv;
+        }
+        ::MIR::Function* deserialise_lazy_mir(uint64_t ofs);
+        template<typename T>
+        ::HIR::Crate::ImplGroup<T> deserialise_lazy_implgroup(uint64_t ofs)
+        {
+            TRACE_FUNCTION_F(ofs);
+            return deserialise_lazy_block(ofs, [&]{ return D< ::HIR::Crate::ImplGroup<T> >::des(*this); });
+        }
+        /// Impl groups keyed by trait, left empty until `HirLazyLoader::load_*_impls` is called
+        template<typename T>
+        ::std::map< ::HIR::SimplePath, ::HIR::Crate::ImplGroup<T> > deserialise_lazy_implgroups()
+        {
+            size_t n = m_in.read_count();
+            ::std::map< ::HIR::SimplePath, ::HIR::Crate::ImplGroup<T> >   rv;
+            for(size_t i = 0; i < n; i ++)
+            {
+                auto s = deserialise_simplepath();
+                auto& ig = rv[mv$(s)];
+                ig.m_lazy.ofs = m_in.read_lazy_block_ref();
+                ig.m_lazy.loaded = false;
+            }
+            return rv;
+        }
+        ::MIR::Function deserialise_mir();
         ::MIR::BasicBlock deserialise_mir_basicblock();
         ::MIR::Statement deserialise_mir_statement();
         ::MIR::Terminator deserialise_mir_terminator();
@@ -876,7 +932,12 @@
     DEF_D( ::HIR::Crate::ImplGroup<T>,
         ::HIR::Crate::ImplGroup<T>  rv;
         rv.named = d.deserialise_pathmap< ::std::vector<::std::unique_ptr<T> > >();
-        rv.non_named = d.deserialise_vec< ::std::unique_ptr<T> >();
+        size_t n = d.deserialise_count();
+        for(size_t i = 0; i < n; i ++)
+        {
+            unsigned key = static_cast<unsigned>(d.deserialise_u64c());
+            rv.non_named[key] = d.deserialise_vec< ::std::unique_ptr<T> >();
+        }
         rv.generic = d.deserialise_vec< ::std::unique_ptr<T> >();
         return rv;
         )
@@ -926,7 +987,10 @@
         auto idx = m_in.read_count();
         if( idx != ~0u ) {
             DEBUG("#" << idx << "");
-            rv = m_types.at(idx).clone();
+            if( m_in_lazy_block && idx >= m_lazy_types_base )
+                rv = m_lazy_types.at(idx - m_lazy_types_base).clone();
+            else
+                rv = m_types.at(idx).clone();
             return rv;
         }
         else {
@@ -987,7 +1051,7 @@
         default:
             BUG(Span(), "Bad tag for HIR::TypeRef - " << tag);
         }
-        m_types.push_back(rv.clone());
+        (m_in_lazy_block ? m_lazy_types : m_types).push_back(rv.clone());
         return rv;
     }
 
@@ -1238,7 +1302,12 @@
         }
     }
 
-    ::MIR::FunctionPointer HirDeserialiser::deserialise_mir()
+    ::MIR::Function* HirDeserialiser::deserialise_lazy_mir(uint64_t ofs)
+    {
+        TRACE_FUNCTION_F(ofs);
+        return deserialise_lazy_block(ofs, [&]{ return new ::MIR::Function( deserialise_mir() ); });
+    }
+    ::MIR::Function HirDeserialiser::deserialise_mir()
     {
         TRACE_FUNCTION;
 
@@ -1249,7 +1318,7 @@
         rv.drop_flags = deserialise_vec<bool>();
         rv.blocks = deserialise_vec< ::MIR::BasicBlock>( );
 
-        return ::MIR::FunctionPointer( new ::MIR::Function(mv$(rv)) );
+        return rv;
     }
     ::MIR::BasicBlock HirDeserialiser::deserialise_mir_basicblock()
     {
@@ -1415,8 +1484,8 @@
         rv.m_root_module = deserialise_module();
 
         rv.m_type_impls = D< ::HIR::Crate::ImplGroup<::HIR::TypeImpl> >::des(*this);
-        rv.m_trait_impls = deserialise_pathmap< ::HIR::Crate::ImplGroup<::HIR::TraitImpl>>();
-        rv.m_marker_impls = deserialise_pathmap< ::HIR::Crate::ImplGroup<::HIR::MarkerImpl>>();
+        rv.m_trait_impls = deserialise_lazy_implgroups<::HIR::TraitImpl>();
+        rv.m_marker_impls = deserialise_lazy_implgroups<::HIR::MarkerImpl>();
 
         rv.m_exported_macro_names = deserialise_vec< ::RcString>();
         //rv.m_exported_macros = deserialise_istrumap< ::MacroRulesPtr>();
@@ -1439,20 +1508,99 @@
         rv.m_ext_libs = deserialise_vec< ::HIR::ExternLibrary>();
         rv.m_link_paths = deserialise_vec< ::std::string>();
 
+        {
+            size_t n = m_in.read_count();
+            for(size_t i = 0; i < n; i ++)
+            {
+                rv.m_shared_monomorphs.insert( deserialise_path() );
+            }
+        }
+
         //rv.m_proc_macros = deserialise_vec< ::HIR::ProcMacro>();
 
         return rv;
     }
+
+    /// Owns the reader (and deserialiser state) for as long as there is MIR or impls left to load
+    class HirLazyLoader:
+        public ::MIR::FunctionLoader,
+        public ::HIR::CrateLoader
+    {
+        ::std::string   m_filename;
+    public:
+        ::HIR::serialise::Reader    m_in;
+        HirDeserialiser m_des;
+
+        HirLazyLoader(const ::std::string& filename):
+            m_filename(filename),
+            m_in(filename),
+            m_des(m_in)
+        {
+        }
+
+        ::MIR::Function* load(size_t key) override
+        {
+            ::MIR::Function* rv;
+            try
+            {
+                rv = m_des.deserialise_lazy_mir(key);
+            }
+            catch(const ::std::runtime_error& e)
+            {
+                ::std::cerr << "Unable to load MIR from " << m_filename << ": " << e.what() << ::std::endl;
+                ::std::abort();
+            }
+            if( m_hooks.mir )
+                m_hooks.mir(*rv);
+            return rv;
+        }
+
+        void load_trait_impls(const ::HIR::SimplePath& trait, ::HIR::Crate::ImplGroup<::HIR::TraitImpl>& group) override
+        {
+            load_impls(trait, group, m_hooks.trait_impl);
+        }
+        void load_marker_impls(const ::HIR::SimplePath& trait, ::HIR::Crate::ImplGroup<::HIR::MarkerImpl>& group) override
+        {
+            load_impls(trait, group, m_hooks.marker_impl);
+        }
+    private:
+        template<typename T>
+        void load_impls(const ::HIR::SimplePath& trait, ::HIR::Crate::ImplGroup<T>& group, const ::std::function<void(const ::HIR::SimplePath&, T&)>& hook)
+        {
+            // NOTE: Shares the lock with MIR loading, as both use the same reader
+            ::std::lock_guard< ::std::mutex>    lh { m_lock };
+            if( group.m_lazy.loaded.load(::std::memory_order_relaxed) )
+                return ;
+            TRACE_FUNCTION_F(trait);
+            try
+            {
+                auto loaded = m_des.deserialise_lazy_implgroup<T>(group.m_lazy.ofs);
+                group.named = mv$(loaded.named);
+                group.non_named = mv$(loaded.non_named);
+                group.generic = mv$(loaded.generic);
+            }
+            catch(const ::std::runtime_error& e)
+            {
+                ::std::cerr << "Unable to load impls of " << trait << " from " << m_filename << ": " << e.what() << ::std::endl;
+                ::std::abort();
+            }
+            if( hook )
+                group.for_each_impl([&](T& impl){ hook(trait, impl); });
+            // Pairs with the acquire load in `find_trait_impls`/`find_auto_trait_impls`
+            group.m_lazy.loaded.store(true, ::std::memory_order_release);
+        }
+    };
 //}
 
 ::HIR::CratePtr HIR_Deserialise(const ::std::string& filename)
 {
     try
     {
-        ::HIR::serialise::Reader    in{ filename + ".hir" };    // HACK!
-        HirDeserialiser  s { in };
+        auto loader = ::std::make_shared<HirLazyLoader>(filename + ".hir");    // HACK!
+        loader->m_des.m_loader = loader;
 
-        ::HIR::Crate    rv = s.deserialise_crate();
+        ::HIR::Crate    rv = loader->m_des.deserialise_crate();
+        rv.m_loader = loader;
 
         return ::HIR::CratePtr( mv$(rv) );
     }
@@ -12,8 +12,10 @@
 
 #include <cassert>
 #include <unordered_map>
+#include <set>
 #include <vector>
 #include <memory>
+#include <atomic>
 
 #include <tagged_union.hpp>
 
@@ -42,6 +44,7 @@ class TypeItem;
 class MacroItem;
 
 class ItemPath;
+class CrateLoader;
 
 class Publicity
 {
@@ -536,6 +539,18 @@ class ExternLibrary
 public:
     ::std::string   name;
 };
+/// Location of an impl group in an extern crate's metadata, decoded when the group is first searched
+struct LazyImplGroup
+{
+    uint64_t    ofs = 0;
+    // Cleared until the lists are populated (atomic, as searches can happen from multiple threads)
+    ::std::atomic<bool> loaded { true };
+
+    LazyImplGroup() {}
+    LazyImplGroup(LazyImplGroup&& x): ofs(x.ofs), loaded(x.loaded.load()) {}
+    LazyImplGroup& operator=(LazyImplGroup&& x) { ofs = x.ofs; loaded = x.loaded.load(); return *this; }
+};
+
 class Crate
 {
 public:
@@ -548,11 +563,25 @@ public:
     {
         typedef ::std::vector<::std::unique_ptr<T>> list_t;
         ::std::map<::HIR::SimplePath, list_t>   named;
-        list_t  non_named; // TODO: use a map of HIR::TypeRef::Data::Tag
+        /// Impls on unnamed types, keyed by `TypeRef::get_impl_sort_key`
+        ::std::map<unsigned, list_t>  non_named;
         list_t  generic;
+        /// Only used for trait/marker impls of extern crates, see `Crate::m_loader`
+        LazyImplGroup   m_lazy;
+
+        template<typename Fcn>
+        void for_each_impl(Fcn cb) {
+            for(auto& l : named)
+                for(auto& impl : l.second)
+                    cb(*impl);
+            for(auto& l : non_named)
+                for(auto& impl : l.second)
+                    cb(*impl);
+            for(auto& impl : generic)
+                cb(*impl);
+        }
 
         const list_t* get_list_for_type(const ::HIR::TypeRef& ty) const {
-            static list_t empty;
             if( const auto* p = ty.get_sort_path() ) {
                 auto it = named.find(*p);
                 if( it != named.end() )
@@ -561,8 +590,11 @@ public:
                     return nullptr;
             }
             else {
-                // TODO: Sort these by type tag, use the `Primitive` group if `ty` is Infer
-                return &non_named;
+                auto it = non_named.find(ty.get_impl_sort_key());
+                if( it != non_named.end() )
+                    return &it->second;
+                else
+                    return nullptr;
             }
         }
         list_t& get_list_for_type_mut(const ::HIR::TypeRef& ty) {
@@ -570,14 +602,47 @@ public:
                 return named[*p];
             }
             else {
-                // TODO: Ivars match with core types
-                return non_named;
+                auto key = ty.get_impl_sort_key();
+                if( key == ~0u )
+                    return generic;
+                return non_named[key];
+            }
+        }
+
+        /// Call `cb` with every sorted list that could contain an impl for `ty` (the `generic` list is not included)
+        /// - `ty` should have its outer ivar resolved; unresolved ivars search all unnamed lists (or just the
+        ///   integer/float primitives for literal ivars)
+        template<typename Fcn>
+        bool iterate_lists_for_type(const ::HIR::TypeRef& ty, Fcn cb) const {
+            if( ty.get_sort_path() ) {
+                const auto* l = get_list_for_type(ty);
+                return l && cb(*l);
+            }
+            auto key = ty.get_impl_sort_key();
+            if( key != ~0u ) {
+                auto it = non_named.find(key);
+                return it != non_named.end() && cb(it->second);
             }
+            const auto* ivar = ty.data().opt_Infer();
+            for(const auto& e : non_named)
+            {
+                if( ivar && ivar->ty_class == ::HIR::InferClass::Integer ) {
+                    if( (e.first >> 16) != ::HIR::TypeData::TAG_Primitive || !is_integer(static_cast<::HIR::CoreType>(e.first & 0xFFFF)) )
+                        continue;
+                }
+                if( ivar && ivar->ty_class == ::HIR::InferClass::Float ) {
+                    if( (e.first >> 16) != ::HIR::TypeData::TAG_Primitive || !is_float(static_cast<::HIR::CoreType>(e.first & 0xFFFF)) )
+                        continue;
+                }
+                if( cb(e.second) )
+                    return true;
+            }
+            return false;
         }
     };
     /// Impl blocks on just a type, split into three groups
     // - Named type (sorted on the path)
-    // - Primitive types
+    // - Unnamed types (sorted on the outer type structure)
     // - Unsorted (generics, and everything before outer type resolution)
     ImplGroup<::HIR::TypeImpl>  m_type_impls;
 
@@ -597,6 +662,12 @@ public:
     ::std::vector<ExternLibrary>    m_ext_libs;
     /// Extra paths for the linker
     ::std::vector<::std::string>    m_link_paths;
+    /// Monomorphised functions emitted (with external linkage) by this crate, recorded with `-Z share-generics`
+    /// - Downstream crates declare these instead of generating their own copy
+    ::std::set< ::HIR::Path>    m_shared_monomorphs;
+
+    /// Set for a crate loaded from metadata, decodes trait/marker impl groups on first search
+    ::std::shared_ptr<CrateLoader>  m_loader;
 
     /// Method called to populate runtime state after deserialisation
     /// See hir/crate_post_load.cpp
@@ -642,4 +713,22 @@ public:
     }
 };
 
+/// Deferred decoding of an extern crate's metadata (see hir/deserialise.cpp)
+class CrateLoader
+{
+public:
+    virtual ~CrateLoader() {}
+
+    /// Populate a trait's impl group (if not already loaded)
+    virtual void load_trait_impls(const ::HIR::SimplePath& trait, Crate::ImplGroup<TraitImpl>& group) = 0;
+    virtual void load_marker_impls(const ::HIR::SimplePath& trait, Crate::ImplGroup<MarkerImpl>& group) = 0;
+
+    /// Called on items decoded after the crate has been bound (see `ConvertHIR_Bind`), with the loader lock held
+    struct Hooks {
+        ::std::function<void(const ::HIR::SimplePath&, ::HIR::TraitImpl&)>  trait_impl;
+        ::std::function<void(const ::HIR::SimplePath&, ::HIR::MarkerImpl&)> marker_impl;
+        ::std::function<void(::MIR::Function&)> mir;
+    } m_hooks;
+};
+
 }   // namespace HIR
@@ -979,12 +979,13 @@ namespace
         auto it = crate.m_trait_impls.find( trait );
         if( it != crate.m_trait_impls.end() )
         {
-            // 1. Find named impls (associated with named types)
-            if( const auto* impl_list = it->second.get_list_for_type(type) )
-            {
-                if( find_impls_list(*impl_list, type, ty_res, callback) )
-                    return true;
-            }
+            // Extern crates only decode a trait's impls when first searched
+            if( !it->second.m_lazy.loaded.load(::std::memory_order_acquire) )
+                crate.m_loader->load_trait_impls(it->first, const_cast<::HIR::Crate::ImplGroup<::HIR::TraitImpl>&>(it->second));
+
+            // 1. Find impls sorted on the type (named types, or the outer structure of unnamed types)
+            if( it->second.iterate_lists_for_type(ty_res(type), [&](const auto& impl_list){ return find_impls_list(impl_list, type, ty_res, callback); }) )
+                return true;
 
             // 2. Search fully generic list.
             if( find_impls_list(it->second.generic, type, ty_res, callback) )
@@ -1020,12 +1021,12 @@ namespace
         auto it = crate.m_marker_impls.find( trait );
         if( it != crate.m_marker_impls.end() )
         {
-            // 1. Find named impls (associated with named types)
-            if( const auto* impl_list = it->second.get_list_for_type(type) )
-            {
-                if( find_impls_list(*impl_list, type, ty_res, callback) )
-                    return true;
-            }
+            if( !it->second.m_lazy.loaded.load(::std::memory_order_acquire) )
+                crate.m_loader->load_marker_impls(it->first, const_cast<::HIR::Crate::ImplGroup<::HIR::MarkerImpl>&>(it->second));
+
+            // 1. Find impls sorted on the type (named types, or the outer structure of unnamed types)
+            if( it->second.iterate_lists_for_type(ty_res(type), [&](const auto& impl_list){ return find_impls_list(impl_list, type, ty_res, callback); }) )
+                return true;
 
             // 2. Search fully generic list.
             if( find_impls_list(it->second.generic, type, ty_res, callback) )
@@ -1054,12 +1055,9 @@ namespace
 {
     bool find_type_impls_int(const ::HIR::Crate& crate, const ::HIR::TypeRef& type, ::HIR::t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&)> callback)
     {
-        // 1. Find named impls (associated with named types)
-        if( const auto* impl_list = crate.m_type_impls.get_list_for_type(type) )
-        {
-            if( find_impls_list(*impl_list, type, ty_res, callback) )
-                return true;
-        }
+        // 1. Find impls sorted on the type (named types, or the outer structure of unnamed types)
+        if( crate.m_type_impls.iterate_lists_for_type(ty_res(type), [&](const auto& impl_list){ return find_impls_list(impl_list, type, ty_res, callback); }) )
+            return true;
 
         // 2. Search fully generic list?
         if( find_impls_list(crate.m_type_impls.generic, type, ty_res, callback) )
@@ -17,5 +17,16 @@ namespace AST {
 
 extern void HIR_Dump(::std::ostream& sink, const ::HIR::Crate& crate);
 extern ::HIR::CratePtr  LowerHIR_FromAST(::AST::Crate crate);
-extern void HIR_Serialise(const ::std::string& filename, const ::HIR::Crate& crate);
+/// Compression applied to serialised HIR (recorded in the file, so readers pick the matching decoder)
+struct HirCompression
+{
+    enum class Codec {
+        None,   // Stored as-is (can be mapped directly)
+        Zlib,
+    };
+    Codec   codec = Codec::Zlib;
+    int level = -1; // -1 = best compression
+};
+
+extern void HIR_Serialise(const ::std::string& filename, const ::HIR::Crate& crate, const HirCompression& compression=HirCompression());
 extern ::HIR::CratePtr HIR_Deserialise(const ::std::string& filename);
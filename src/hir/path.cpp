@@ -164,6 +164,26 @@ bool ::HIR::GenericPath::operator==(const GenericPath& x) const
     return m_params == x.m_params;
 }
 
+size_t HIR::SimplePath::hash() const
+{
+    size_t rv = m_crate_name.hash();
+    for(const auto& c : m_components)
+        rv = rv * 31 + c.hash();
+    return rv;
+}
+size_t HIR::PathParams::hash() const
+{
+    // NOTE: Only the types, as `ord` (and thus `Path::operator==`) ignores the values
+    size_t rv = m_types.size();
+    for(const auto& t : m_types)
+        rv = rv * 31 + t.hash();
+    return rv;
+}
+size_t HIR::GenericPath::hash() const
+{
+    return m_path.hash() * 31 + m_params.hash();
+}
+
 ::HIR::TraitPath HIR::TraitPath::clone() const
 {
     ::HIR::TraitPath    rv {
@@ -439,4 +459,30 @@ Ordering HIR::Path::ord(const ::HIR::Path& x) const
 bool ::HIR::Path::operator==(const Path& x) const {
     return this->ord(x) == ::OrdEqual;
 }
+size_t HIR::Path::hash() const
+{
+    size_t rv = static_cast<size_t>(m_data.tag());
+    TU_MATCH_HDRA( (m_data), {)
+    TU_ARMA(Generic, e) {
+        rv = rv * 31 + e.hash();
+        }
+    TU_ARMA(UfcsInherent, e) {
+        rv = rv * 31 + e.type.hash();
+        rv = rv * 31 + e.item.hash();
+        rv = rv * 31 + e.params.hash();
+        }
+    TU_ARMA(UfcsKnown, e) {
+        rv = rv * 31 + e.type.hash();
+        rv = rv * 31 + e.trait.hash();
+        rv = rv * 31 + e.item.hash();
+        rv = rv * 31 + e.params.hash();
+        }
+    TU_ARMA(UfcsUnknown, e) {
+        rv = rv * 31 + e.type.hash();
+        rv = rv * 31 + e.item.hash();
+        rv = rv * 31 + e.params.hash();
+        }
+    }
+    return rv;
+}
 
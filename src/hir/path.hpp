@@ -85,6 +85,7 @@ struct SimplePath
         rv = ::ord(m_components, x.m_components);
         return rv;
     }
+    size_t hash() const;
     friend ::std::ostream& operator<<(::std::ostream& os, const SimplePath& x);
 };
 
@@ -118,6 +119,7 @@ struct PathParams
     Ordering ord(const PathParams& x) const {
         return ::ord(m_types, x.m_types);
     }
+    size_t hash() const;
 
     friend ::std::ostream& operator<<(::std::ostream& os, const PathParams& x);
 };
@@ -145,6 +147,7 @@ public:
         if(rv != OrdEqual)  return rv;
         return ::ord(m_params, x.m_params);
     }
+    size_t hash() const;
 
     friend ::std::ostream& operator<<(::std::ostream& os, const GenericPath& x);
 };
@@ -222,11 +225,24 @@ public:
     bool operator==(const Path& x) const;
     bool operator!=(const Path& x) const { return !(*this == x); }
     bool operator<(const Path& x) const { return ord(x) == OrdLess; }
+    /// Structural hash, consistent with `operator==` (used for the hashed TransList containers)
+    size_t hash() const;
 
     friend ::std::ostream& operator<<(::std::ostream& os, const Path& x);
 };
 
 }   // namespace HIR
 
+namespace std {
+    template<> struct hash< ::HIR::GenericPath>
+    {
+        size_t operator()(const ::HIR::GenericPath& x) const { return x.hash(); }
+    };
+    template<> struct hash< ::HIR::Path>
+    {
+        size_t operator()(const ::HIR::Path& x) const { return x.hash(); }
+    };
+}
+
 #endif
 
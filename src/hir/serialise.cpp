@@ -16,13 +16,29 @@
     {
         ::std::map<HIR::TypeRef, size_t>    m_types;
         ::HIR::serialise::Writer&   m_out;
+
+        // Types first seen within the current lazy block (discarded at the end of the block)
+        bool    m_in_lazy_block = false;
+        ::std::map<HIR::TypeRef, size_t>    m_lazy_types;
     public:
         HirSerialiser(::HIR::serialise::Writer& out):
             m_out( out )
         {}
 
-        void clear() {
-            m_types.clear();
+        /// Write the output of `cb` to an out-of-line block, so the reader can decode it on first use
+        template<typename F>
+        void serialise_lazy_block(F cb)
+        {
+            auto _ = m_out.open_lazy_block();
+            // Blocks can nest, but each one can only refer to types in the main table (as they're decoded independently)
+            auto saved_in_lazy_block = m_in_lazy_block;
+            auto saved_lazy_types = ::std::move(m_lazy_types);
+            m_lazy_types.clear();
+            m_in_lazy_block = true;
+            m_out.write_u64c(m_types.size());
+            cb();
+            m_in_lazy_block = saved_in_lazy_block;
+            m_lazy_types = ::std::move(saved_lazy_types);
         }
 
         template<typename V>
@@ -177,6 +193,14 @@
                 m_out.write_count(it->second);
                 return ;
             }
+            if( m_in_lazy_block ) {
+                auto it = m_lazy_types.find(ty);
+                if( it != m_lazy_types.end() ) {
+                    DEBUG("Cached (lazy) " << it->second);
+                    m_out.write_count(it->second);
+                    return ;
+                }
+            }
             m_out.write_count(~0u);
             DEBUG("Fresh " << m_types.size());
 
@@ -240,7 +264,12 @@
                 }
             }
 
-            m_types.insert(std::make_pair( ty.clone(), m_types.size() ));
+            if( m_in_lazy_block ) {
+                m_lazy_types.insert(std::make_pair( ty.clone(), m_types.size() + m_lazy_types.size() ));
+            }
+            else {
+                m_types.insert(std::make_pair( ty.clone(), m_types.size() ));
+            }
         }
         void serialise_simplepath(const ::HIR::SimplePath& path)
         {
@@ -341,9 +370,24 @@
         void serialise(const ::HIR::Crate::ImplGroup<T>& ig)
         {
             serialise_pathmap(ig.named);
-            serialise_vec(ig.non_named);
+            m_out.write_count(ig.non_named.size());
+            for(const auto& l : ig.non_named) {
+                m_out.write_u64c(l.first);
+                serialise_vec(l.second);
+            }
             serialise_vec(ig.generic);
         }
+        /// Impl groups keyed by trait, each stored out-of-line (so only the traits searched in are decoded)
+        template<typename T>
+        void serialise_lazy_implgroups(const ::std::map< ::HIR::SimplePath, ::HIR::Crate::ImplGroup<T> >& map)
+        {
+            m_out.write_count(map.size());
+            for(const auto& v : map) {
+                DEBUG("- " << v.first);
+                serialise(v.first);
+                serialise_lazy_block([&]{ serialise(v.second); });
+            }
+        }
 
         void serialise_crate(const ::HIR::Crate& crate)
         {
@@ -351,8 +395,8 @@
             serialise_module(crate.m_root_module);
 
             serialise(crate.m_type_impls);
-            serialise_pathmap(crate.m_trait_impls);
-            serialise_pathmap(crate.m_marker_impls);
+            serialise_lazy_implgroups(crate.m_trait_impls);
+            serialise_lazy_implgroups(crate.m_marker_impls);
 
             serialise_vec(crate.m_exported_macro_names);
 
@@ -377,6 +421,12 @@
             }
             serialise_vec(crate.m_ext_libs);
             serialise_vec(crate.m_link_paths);
+
+            m_out.write_count(crate.m_shared_monomorphs.size());
+            for(const auto& p : crate.m_shared_monomorphs)
+            {
+                serialise_path(p);
+            }
         }
         void serialise(const ::HIR::ExternLibrary& lib)
         {
@@ -641,7 +691,8 @@
             save_mir &= static_cast<bool>(exp.m_mir);
             m_out.write_bool( save_mir );
             if( save_mir ) {
-                serialise(*exp.m_mir);
+                // Stored out-of-line, so the reader only loads it when used
+                serialise_lazy_block([&]{ serialise(*exp.m_mir); });
             }
             serialise_vec( exp.m_erased_types );
         }
@@ -1180,13 +1231,11 @@
     };
 //}
 
-void HIR_Serialise(const ::std::string& filename, const ::HIR::Crate& crate)
+void HIR_Serialise(const ::std::string& filename, const ::HIR::Crate& crate, const HirCompression& compression)
 {
     ::HIR::serialise::Writer    out;
     HirSerialiser  s { out };
-    s.serialise_crate(crate);
-    s.clear();
-    out.open(filename);
+    out.open(filename, compression);
     s.serialise_crate(crate);
 }
 
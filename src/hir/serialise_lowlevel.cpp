@@ -12,22 +12,124 @@
 #include <string.h>   // memcpy
 #include <common.hpp>
 #include <algorithm>
+#ifndef _WIN32
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
 
 namespace HIR {
 namespace serialise {
 
+namespace {
+    // "MRUSTHIR", followed by a format version
+    const uint8_t   HEADER_MAGIC[8] = { 'M','R','U','S','T','H','I','R' };
+    const uint32_t  HEADER_VERSION = 6;
+    const size_t    NUM_SECTIONS = 3;
+    // magic, version, codec, [stored size, size] for each section (in `Section` order)
+    const size_t    HEADER_SIZE = 8 + 4 + 4 + NUM_SECTIONS * (8 + 8);
+    // Codec IDs (stored in the header)
+    const uint32_t  CODEC_NONE = 0;
+    const uint32_t  CODEC_ZLIB = 1;
+
+    void put_u32(uint8_t* dst, uint32_t v) {
+        for(int i = 0; i < 4; i ++)
+            dst[i] = static_cast<uint8_t>(v >> (8*i));
+    }
+    void put_u64(uint8_t* dst, uint64_t v) {
+        for(int i = 0; i < 8; i ++)
+            dst[i] = static_cast<uint8_t>(v >> (8*i));
+    }
+    uint32_t get_u32(const uint8_t* src) {
+        uint32_t rv = 0;
+        for(int i = 0; i < 4; i ++)
+            rv |= static_cast<uint32_t>(src[i]) << (8*i);
+        return rv;
+    }
+    uint64_t get_u64(const uint8_t* src) {
+        uint64_t rv = 0;
+        for(int i = 0; i < 8; i ++)
+            rv |= static_cast<uint64_t>(src[i]) << (8*i);
+        return rv;
+    }
+
+    uint32_t get_codec_id(HirCompression::Codec c) {
+        switch(c)
+        {
+        case HirCompression::Codec::None:   return CODEC_NONE;
+        case HirCompression::Codec::Zlib:   return CODEC_ZLIB;
+        }
+        throw ::std::runtime_error("Unknown compression codec");
+    }
+
+    ::std::vector<uint8_t> zlib_compress(const ::std::vector<uint8_t>& data, int level)
+    {
+        uLongf  len = compressBound(data.size());
+        ::std::vector<uint8_t>  rv(len);
+        int ret = compress2(rv.data(), &len, data.data(), data.size(), level < 0 ? Z_BEST_COMPRESSION : level);
+        if( ret != Z_OK ) {
+            ::std::cerr << "ERROR: zlib compress failure (" << ret << ")" << ::std::endl;
+            abort();
+        }
+        rv.resize(len);
+        return rv;
+    }
+    ::std::vector<uint8_t> zlib_decompress(const uint8_t* data, size_t len, size_t out_len)
+    {
+        ::std::vector<uint8_t>  rv(out_len);
+        uLongf  rv_len = out_len;
+        int ret = uncompress(rv.data(), &rv_len, data, len);
+        if( ret != Z_OK || rv_len != out_len )
+            throw ::std::runtime_error("zlib inflate error");
+        return rv;
+    }
+}
+
+enum class Section {
+    Main,   // Crate data (first, so it can be streamed straight to the file)
+    Lazy,   // Out-of-line blocks
+    Strings,    // String table, built as strings are first written
+};
+
 class WriterInner
 {
     ::std::ofstream m_backing;
-    z_stream    m_zstream;
-    ::std::vector<unsigned char> m_buffer;
-
-    unsigned int    m_byte_out_count = 0;
-    unsigned int    m_byte_in_count = 0;
+    HirCompression  m_compression;
+    // Section contents (the main section is written directly to the file if not compressed)
+    ::std::vector<uint8_t>  m_buffers[NUM_SECTIONS];
+    uint64_t    m_main_size = 0;
+    Section m_section = Section::Main;
+    // Contents of the open lazy blocks (innermost last), appended to the lazy section when closed
+    ::std::vector< ::std::vector<uint8_t> > m_open_blocks;
 public:
-    WriterInner(const ::std::string& filename);
+    WriterInner(const ::std::string& filename, const HirCompression& compression);
     ~WriterInner();
     void write(const void* buf, size_t len);
+
+    uint64_t section_size(Section s) const {
+        return s == Section::Main ? m_main_size : m_buffers[static_cast<int>(s)].size();
+    }
+    /// Direct subsequent writes to the given section (returns the previous section)
+    Section set_section(Section s) {
+        auto rv = m_section;
+        m_section = s;
+        return rv;
+    }
+
+    /// Direct subsequent writes (other than to the string table) to a new lazy block
+    void push_block() {
+        m_open_blocks.push_back({});
+    }
+    /// Append the innermost open block to the lazy section, returning its offset
+    uint64_t pop_block() {
+        assert(!m_open_blocks.empty());
+        auto& dst = m_buffers[static_cast<int>(Section::Lazy)];
+        uint64_t rv = dst.size();
+        dst.insert(dst.end(), m_open_blocks.back().begin(), m_open_blocks.back().end());
+        m_open_blocks.pop_back();
+        return rv;
+    }
 };
 
 Writer::Writer():
@@ -38,146 +140,118 @@ Writer::~Writer()
 {
     delete m_inner, m_inner = nullptr;
 }
-void Writer::open(const ::std::string& filename)
+void Writer::open(const ::std::string& filename, const HirCompression& compression)
 {
-    // 1. Sort strings by frequency
-    ::std::vector<::std::pair<RcString, unsigned>> sorted;
-    sorted.reserve(m_istring_cache.size());
-    for(const auto& e : m_istring_cache)
-        sorted.push_back( e );
-    // 2. Write out string table
-    ::std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b){ return a.second > b.second; });
-
+    m_istring_cache.clear();
     m_objname_cache.clear();
-
-    m_inner = new WriterInner(filename);
-    // 3. Reset m_istring_cache to use the same value
-    this->write_count(sorted.size());
-    for(size_t i = 0; i < sorted.size(); i ++)
-    {
-        const auto& s = sorted[i].first;
-        this->write_string(s.size(), s.c_str());
-        DEBUG(i << " = " << m_istring_cache[s] << " '" << s << "'");
-        m_istring_cache[s] = i;
-    }
-    for(const auto& e : m_istring_cache)
-    {
-        assert(e.second < sorted.size());
-    }
+    m_inner = new WriterInner(filename, compression);
 }
 void Writer::write(const void* buf, size_t len)
 {
-    if( m_inner ) {
-        m_inner->write(buf, len);
-    }
-    else {
-        // No-op, pre caching
-    }
+    assert(m_inner);
+    m_inner->write(buf, len);
 }
 void Writer::write_string(const RcString& v)
 {
-    if( m_inner ) {
-        // Emit ID from the cache
-        this->write_count( m_istring_cache.at(v) );
-    }
-    else {
-        // Find/add in cache
-        m_istring_cache.insert(::std::make_pair(v, 0)).first->second += 1;
+    // Strings are numbered in the order they're first seen, and appended to the string table at that point
+    auto ins = m_istring_cache.insert(::std::make_pair( v, static_cast<unsigned>(m_istring_cache.size()) ));
+    if( ins.second )
+    {
+        DEBUG(ins.first->second << " = '" << v << "'");
+        auto saved = m_inner->set_section(Section::Strings);
+        this->write_string(v.size(), v.c_str());
+        m_inner->set_section(saved);
     }
+    this->write_count( ins.first->second );
+}
+Writer::LazyBlock Writer::open_lazy_block()
+{
+    LazyBlock   rv { *this };
+    // Blocks are decoded on their own, so can't refer to object names defined elsewhere
+    ::std::swap(rv.saved_objname_cache, m_objname_cache);
+    // NOTE: Blocks can nest (e.g. MIR within an impl block), each is buffered until it's closed
+    m_inner->push_block();
+    return rv;
+}
+void Writer::close_lazy_block(LazyBlock& b)
+{
+    auto ofs = m_inner->pop_block();
+    ::std::swap(b.saved_objname_cache, m_objname_cache);
+    write_u64c(ofs);
 }
 
 
-WriterInner::WriterInner(const ::std::string& filename):
+WriterInner::WriterInner(const ::std::string& filename, const HirCompression& compression):
     m_backing( filename, ::std::ios_base::out | ::std::ios_base::binary),
-    m_zstream(),
-    m_buffer( 16*1024 )
-    //m_buffer( 4*1024 )
+    m_compression( compression )
 {
-    m_zstream.zalloc = Z_NULL;
-    m_zstream.zfree = Z_NULL;
-    m_zstream.opaque = Z_NULL;
-
-    const int COMPRESSION_LEVEL = Z_BEST_COMPRESSION;
-    int ret = deflateInit(&m_zstream, COMPRESSION_LEVEL);
-    if(ret != Z_OK)
-        throw ::std::runtime_error("zlib init failure");
+    if( !m_backing.is_open() )
+        throw ::std::runtime_error("Unable to open file for writing");
 
-    m_zstream.avail_out = m_buffer.size();
-    m_zstream.next_out = m_buffer.data();
+    // Placeholder header, filled once the section sizes are known
+    uint8_t header[HEADER_SIZE] = {};
+    m_backing.write( reinterpret_cast<const char*>(header), sizeof(header) );
 }
 WriterInner::~WriterInner()
 {
-    assert( m_zstream.avail_in == 0 );
-
-    // Complete the compression
-    int ret;
-    do
+    uint8_t header[HEADER_SIZE];
+    memcpy(header, HEADER_MAGIC, 8);
+    put_u32(header + 8, HEADER_VERSION);
+    put_u32(header + 12, get_codec_id(m_compression.codec));
+    for(size_t i = 0; i < NUM_SECTIONS; i ++)
     {
-        ret = deflate(&m_zstream, Z_FINISH);
-        if(ret == Z_STREAM_ERROR) {
-            ::std::cerr << "ERROR: zlib deflate stream error (cleanup)";
-            abort();
-        }
-        if( m_zstream.avail_out != m_buffer.size() )
+        auto sec = static_cast<Section>(i);
+        const auto& buf = m_buffers[i];
+        uint64_t    stored_size = 0;
+        switch(m_compression.codec)
         {
-            size_t rem = m_buffer.size() - m_zstream.avail_out;
-            m_byte_out_count += rem;
-            m_backing.write( reinterpret_cast<char*>(m_buffer.data()), rem );
-
-            m_zstream.avail_out = m_buffer.size();
-            m_zstream.next_out = m_buffer.data();
+        case HirCompression::Codec::None:
+            if( sec != Section::Main ) {
+                m_backing.write( reinterpret_cast<const char*>(buf.data()), buf.size() );
+            }
+            stored_size = section_size(sec);
+            break;
+        case HirCompression::Codec::Zlib: {
+            // NOTE: Sections are compressed independently (so the main section can be loaded without the lazy one)
+            auto data = zlib_compress(buf, m_compression.level);
+            m_backing.write( reinterpret_cast<const char*>(data.data()), data.size() );
+            stored_size = data.size();
+            break; }
         }
-    } while(ret == Z_OK);
-    deflateEnd(&m_zstream);
+        put_u64(header + 16 + i*16 + 0, stored_size);
+        put_u64(header + 16 + i*16 + 8, section_size(sec));
+    }
+    m_backing.seekp(0);
+    m_backing.write( reinterpret_cast<const char*>(header), sizeof(header) );
+    m_backing.flush();
+    if( !m_backing.good() ) {
+        ::std::cerr << "ERROR: Failed to write HIR file" << ::std::endl;
+        abort();
+    }
 }
 
 void WriterInner::write(const void* buf, size_t len)
 {
-    m_zstream.avail_in = len;
-    m_zstream.next_in = reinterpret_cast<unsigned char*>( const_cast<void*>(buf) );
-
-    size_t last_avail_in = m_zstream.avail_in;
-
-    // While there's data to compress
-    while( m_zstream.avail_in > 0 )
+    if( m_section == Section::Main && !m_open_blocks.empty() )
     {
-        assert(m_zstream.avail_out != 0);
-
-        // Compress the data
-        int ret = deflate(&m_zstream, Z_NO_FLUSH);
-        if(ret == Z_STREAM_ERROR)
-            throw ::std::runtime_error("zlib deflate stream error");
-
-        size_t used_this_time = last_avail_in - m_zstream.avail_in;
-        last_avail_in = m_zstream.avail_in;
-        m_byte_in_count += used_this_time;
-
-        // If the entire input wasn't consumed, then it was likely due to a lack of output space
-        // - Flush the output buffer to the file
-        if( m_zstream.avail_in > 0 )
-        {
-            size_t bytes = m_buffer.size() - m_zstream.avail_out;
-            m_backing.write( reinterpret_cast<char*>(m_buffer.data()), bytes );
-            m_byte_out_count += bytes;
-
-            m_zstream.avail_out = m_buffer.size();
-            m_zstream.next_out = m_buffer.data();
-        }
+        auto& dst = m_open_blocks.back();
+        const auto* p = reinterpret_cast<const uint8_t*>(buf);
+        dst.insert(dst.end(), p, p + len);
+        return ;
     }
-
-    // Flush stream contents if the output buffer is full.
-    while( m_zstream.avail_out == 0 )
+    if( m_section == Section::Main && m_compression.codec == HirCompression::Codec::None )
     {
-        size_t bytes = m_buffer.size() - m_zstream.avail_out;
-        m_backing.write( reinterpret_cast<char*>(m_buffer.data()), bytes );
-        m_byte_out_count += bytes;
-
-        m_zstream.avail_out = m_buffer.size();
-        m_zstream.next_out = m_buffer.data();
-
-        int ret = deflate(&m_zstream, Z_NO_FLUSH);
-        if(ret == Z_STREAM_ERROR)
-            throw ::std::runtime_error("zlib deflate stream error");
+        m_backing.write( reinterpret_cast<const char*>(buf), len );
+    }
+    else
+    {
+        auto& dst = m_buffers[static_cast<int>(m_section)];
+        const auto* p = reinterpret_cast<const uint8_t*>(buf);
+        dst.insert(dst.end(), p, p + len);
+    }
+    if( m_section == Section::Main )
+    {
+        m_main_size += len;
     }
 }
 
@@ -185,154 +259,156 @@ void WriterInner::write(const void* buf, size_t len)
 // --------------------------------------------------------------------
 class ReaderInner
 {
-    ::std::ifstream m_backing;
-    z_stream    m_zstream;
-    ::std::vector<unsigned char> m_buffer;
-
-    unsigned int    m_byte_out_count = 0;
-    unsigned int    m_byte_in_count = 0;
+    const uint8_t*  m_data;
+    size_t  m_size;
+#ifdef _WIN32
+    ::std::vector<uint8_t>  m_backing;
+#endif
+    // Sections, either pointing into the mapping or into the decompressed buffers
+    struct SectionData {
+        const uint8_t*  data = nullptr;
+        size_t  size = 0;
+        ::std::vector<uint8_t>  buf;
+    } m_sections[NUM_SECTIONS];
 public:
     ReaderInner(const ::std::string& filename);
+    ReaderInner(const ReaderInner&) = delete;
     ~ReaderInner();
-    size_t read(void* buf, size_t len);
-};
-
 
-ReadBuffer::ReadBuffer(size_t cap):
-    m_ofs(0)
-{
-    m_backing.reserve(cap);
-}
-size_t ReadBuffer::read(void* dst, size_t len)
-{
-    size_t rem = m_backing.size() - m_ofs;
-    if( rem >= len )
-    {
-        memcpy(dst, m_backing.data() + m_ofs, len);
-        m_ofs += len;
-        return len;
-    }
-    else
-    {
-        memcpy(dst, m_backing.data() + m_ofs, rem);
-        m_ofs = m_backing.size();
-        return rem;
-    }
-}
-void ReadBuffer::populate(ReaderInner& is)
-{
-    m_backing.resize( m_backing.capacity(), 0 );
-    auto len = is.read(m_backing.data(), m_backing.size());
-    m_backing.resize( len );
-    m_ofs = 0;
-}
+    const uint8_t* section_data(Section s) const { return m_sections[static_cast<int>(s)].data; }
+    size_t section_size(Section s) const { return m_sections[static_cast<int>(s)].size; }
+private:
+    void parse_header();
+};
 
 
 Reader::Reader(const ::std::string& filename):
     m_inner( new ReaderInner(filename) ),
-    m_buffer(1024),
+    m_data(nullptr),
+    m_size(0),
     m_pos(0)
 {
-    size_t n_strings = read_count();
-    m_strings.reserve(n_strings);
-    DEBUG("n_strings = " << n_strings);
-    for(size_t i = 0; i < n_strings; i ++)
+    // Load the string table (a sequence of strings filling its section)
+    m_data = m_inner->section_data(Section::Strings);
+    m_size = m_inner->section_size(Section::Strings);
+    while( m_pos < m_size )
     {
         auto s = read_string();
         m_strings.push_back( RcString::new_interned(s) );
     }
+    DEBUG("n_strings = " << m_strings.size());
+
+    m_data = m_inner->section_data(Section::Main);
+    m_size = m_inner->section_size(Section::Main);
+    m_pos = 0;
 }
 Reader::~Reader()
 {
     delete m_inner, m_inner = nullptr;
 }
 
-void Reader::read(void* buf, size_t len)
+Reader::LazyBlock Reader::open_lazy_block(uint64_t ofs)
 {
-    auto used = m_buffer.read(buf, len);
-    if( used == len ) {
-        m_pos += len;
-        return ;
-    }
-    buf = reinterpret_cast<uint8_t*>(buf) + used;
-    len -= used;
-
-    if( len >= m_buffer.capacity() )
-    {
-        m_inner->read(buf, len);
-    }
-    else
-    {
-        m_buffer.populate( *m_inner );
-        used = m_buffer.read(buf, len);
-        if( used != len )
-            throw ::std::runtime_error( FMT("Reader::read - Requested " << len << " bytes from buffer, got " << used) );
-    }
-
-    m_pos += len;
+    if( ofs > m_inner->section_size(Section::Lazy) )
+        throw ::std::runtime_error(FMT("Lazy block offset " << ofs << " out of range"));
+
+    LazyBlock   rv { *this };
+    ::std::swap(rv.saved_objname_cache, m_objname_cache);
+    m_data = m_inner->section_data(Section::Lazy);
+    m_size = m_inner->section_size(Section::Lazy);
+    m_pos = ofs;
+    return rv;
+}
+void Reader::close_lazy_block(LazyBlock& b)
+{
+    ::std::swap(b.saved_objname_cache, m_objname_cache);
+    m_data = b.saved_data;
+    m_size = b.saved_size;
+    m_pos = b.saved_pos;
 }
 
 
 ReaderInner::ReaderInner(const ::std::string& filename):
-    m_backing(filename, ::std::ios_base::in|::std::ios_base::binary),
-    m_zstream(),
-    m_buffer(16*1024)
+    m_data(nullptr),
+    m_size(0)
 {
-    if( !m_backing.is_open() )
+#ifdef _WIN32
+    ::std::ifstream is(filename, ::std::ios_base::in|::std::ios_base::binary);
+    if( !is.is_open() )
         throw ::std::runtime_error("Unable to open file");
-
-    m_zstream.zalloc = Z_NULL;
-    m_zstream.zfree = Z_NULL;
-    m_zstream.opaque = Z_NULL;
-
-    int ret = inflateInit(&m_zstream);
-    if(ret != Z_OK)
-        throw ::std::runtime_error("zlib init failure");
-
-    m_zstream.avail_in = 0;
-}
-ReaderInner::~ReaderInner()
-{
-    inflateEnd(&m_zstream);
+    is.seekg(0, ::std::ios::end);
+    m_backing.resize( static_cast<size_t>(is.tellg()) );
+    is.seekg(0);
+    is.read( reinterpret_cast<char*>(m_backing.data()), m_backing.size() );
+    m_data = m_backing.data();
+    m_size = m_backing.size();
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if( fd < 0 )
+        throw ::std::runtime_error("Unable to open file");
+    struct stat st;
+    if( fstat(fd, &st) != 0 ) {
+        close(fd);
+        throw ::std::runtime_error("Unable to stat file");
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if( m_size > 0 )
+    {
+        void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if( p == MAP_FAILED ) {
+            close(fd);
+            throw ::std::runtime_error("Unable to map file");
+        }
+        m_data = static_cast<const uint8_t*>(p);
+    }
+    close(fd);
+#endif
+    parse_header();
 }
-size_t ReaderInner::read(void* buf, size_t len)
+void ReaderInner::parse_header()
 {
-    m_zstream.avail_out = len;
-    m_zstream.next_out = reinterpret_cast<unsigned char*>(buf);
-    do {
-        // Reset input buffer if empty
-        if( m_zstream.avail_in == 0 )
-        {
-            m_backing.read( reinterpret_cast<char*>(m_buffer.data()), m_buffer.size() );
-            m_zstream.avail_in = m_backing.gcount();
-            if( m_zstream.avail_in == 0 ) {
-                m_byte_out_count += len  - m_zstream.avail_out;
-                //::std::cerr << "Out of bytes, " << m_zstream.avail_out << " needed" << ::std::endl;
-                return len - m_zstream.avail_out;
-            }
-            m_zstream.next_in = const_cast<unsigned char*>(m_buffer.data());
-
-            m_byte_in_count += m_zstream.avail_in;
-        }
+    if( m_size < HEADER_SIZE || memcmp(m_data, HEADER_MAGIC, 8) != 0 )
+        throw ::std::runtime_error("Not a HIR file (bad magic)");
+    if( get_u32(m_data + 8) != HEADER_VERSION )
+        throw ::std::runtime_error(FMT("Unsupported HIR file version " << get_u32(m_data + 8)));
+    auto codec = get_u32(m_data + 12);
+    if( codec != CODEC_NONE && codec != CODEC_ZLIB )
+        throw ::std::runtime_error(FMT("Unknown HIR compression codec " << codec));
+
+    const auto* stored = m_data + HEADER_SIZE;
+    size_t  rem = m_size - HEADER_SIZE;
+    for(size_t i = 0; i < NUM_SECTIONS; i ++)
+    {
+        auto& sec = m_sections[i];
+        auto stored_size = get_u64(m_data + 16 + i*16 + 0);
+        sec.size = get_u64(m_data + 16 + i*16 + 8);
+        if( rem < stored_size )
+            throw ::std::runtime_error("Truncated HIR file");
 
-        int ret = inflate(&m_zstream, Z_NO_FLUSH);
-        if(ret == Z_STREAM_ERROR)
-            throw ::std::runtime_error("zlib inflate stream error");
-        switch(ret)
+        switch(codec)
         {
-        case Z_NEED_DICT:
-            ret = Z_DATA_ERROR;
-        case Z_DATA_ERROR:
-        case Z_MEM_ERROR:
-            throw ::std::runtime_error("zlib inflate error");
-        default:
+        case CODEC_NONE:
+            if( stored_size != sec.size )
+                throw ::std::runtime_error("Section size mismatch in uncompressed HIR file");
+            sec.data = stored;
+            break;
+        case CODEC_ZLIB:
+            // Decompress up-front, the lazy section is still only decoded on demand
+            sec.buf = zlib_decompress(stored, stored_size, sec.size);
+            sec.data = sec.buf.data();
             break;
         }
-
-    } while( m_zstream.avail_out > 0 );
-    m_byte_out_count += len;
-
-    return len;
+        stored += stored_size;
+        rem -= stored_size;
+    }
+}
+ReaderInner::~ReaderInner()
+{
+#ifndef _WIN32
+    if( m_data ) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
 }
 
 }   // namespace serialise
@@ -17,13 +17,25 @@
 // 0xFD indicates start of a named object (string index follows)
 // 0xFE indicates start of an unnamed object
 // 0xFF indicates end of an object
+//
+// File layout (uncompressed by default, so it can be mapped directly)
+// - Header (magic, version, compression codec, section sizes)
+// - Main section: The crate
+// - Lazy section: Out-of-line blocks (e.g. impl groups, MIR bodies), referenced by offset from the main section
+//   (or from an enclosing block). Each block starts with an empty object name cache, so can be decoded independently.
+// - String table: Interned strings in the order they were first written (so the crate is written in one pass)
+// If compressed, each section is compressed on its own.
 
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <stdexcept>
 #include <stddef.h>
+#include <string.h> // memcpy
 #include <assert.h>
 #include <rc_string.hpp>
+#include "main_bindings.hpp"    // HirCompression
 
 namespace HIR {
 namespace serialise {
@@ -34,7 +46,7 @@ class ReaderInner;
 class Writer
 {
     WriterInner*    m_inner;
-    ::std::map<RcString, unsigned>  m_istring_cache;
+    ::std::unordered_map<RcString, unsigned>  m_istring_cache;
     ::std::map<const char*, unsigned>  m_objname_cache;
 public:
     Writer();
@@ -42,7 +54,7 @@ public:
     Writer(Writer&&) = delete;
     ~Writer();
 
-    void open(const ::std::string& filename);
+    void open(const ::std::string& filename, const HirCompression& compression);
     void write(const void* data, size_t count);
 
     void write_u8(uint8_t v) {
@@ -207,25 +219,30 @@ public:
     void close_object() {
         write_u8(0xFF);
     }
-};
-
 
-class ReadBuffer
-{
-    ::std::vector<uint8_t>  m_backing;
-    unsigned int    m_ofs;
-public:
-    ReadBuffer(size_t size);
-
-    size_t capacity() const { return m_backing.capacity(); }
-    size_t read(void* dst, size_t len);
-    void populate(ReaderInner& is);
+    /// Handle for an open lazy block, writes the block's offset to the enclosing section/block when dropped
+    class LazyBlock {
+        friend class Writer;
+        Writer* w;
+        ::std::map<const char*, unsigned>  saved_objname_cache;
+        LazyBlock(Writer& w): w(&w) {}
+    public:
+        LazyBlock(LazyBlock&& x): w(x.w), saved_objname_cache(::std::move(x.saved_objname_cache)) { x.w = nullptr; }
+        ~LazyBlock() { if(w) w->close_lazy_block(*this); }
+    };
+    /// Start writing to the lazy section (until the returned handle is dropped)
+    LazyBlock open_lazy_block();
+private:
+    void close_lazy_block(LazyBlock& b);
 };
 
+
 class Reader
 {
     ReaderInner*    m_inner;
-    ReadBuffer  m_buffer;
+    // Current section (main or lazy), and the read position within it
+    const uint8_t*  m_data;
+    size_t  m_size;
     size_t  m_pos;
     ::std::vector<RcString> m_strings;
 
@@ -237,7 +254,12 @@ public:
     ~Reader();
 
     size_t get_pos() const { return m_pos; }
-    void read(void* dst, size_t count);
+    void read(void* dst, size_t count) {
+        if( count > m_size - m_pos )
+            throw ::std::runtime_error("Reader::read - Unexpected end of section");
+        memcpy(dst, m_data + m_pos, count);
+        m_pos += count;
+    }
 
     uint8_t read_u8() {
         uint8_t v;
@@ -435,6 +457,28 @@ public:
     void close_object() {
         assert(read_u8() == 0xFF);
     }
+
+    /// Read the reference to a lazy block (written when a `Writer::LazyBlock` is dropped)
+    uint64_t read_lazy_block_ref() {
+        return read_u64c();
+    }
+    /// Handle for reading a lazy block, restores the previous read position when dropped
+    class LazyBlock {
+        friend class Reader;
+        Reader* r;
+        const uint8_t*  saved_data;
+        size_t  saved_size;
+        size_t  saved_pos;
+        ::std::vector<std::string>  saved_objname_cache;
+        LazyBlock(Reader& r): r(&r), saved_data(r.m_data), saved_size(r.m_size), saved_pos(r.m_pos) {}
+    public:
+        LazyBlock(LazyBlock&& x): r(x.r), saved_data(x.saved_data), saved_size(x.saved_size), saved_pos(x.saved_pos), saved_objname_cache(::std::move(x.saved_objname_cache)) { x.r = nullptr; }
+        ~LazyBlock() { if(r) r->close_lazy_block(*this); }
+    };
+    /// Start reading the lazy block at the given offset
+    LazyBlock open_lazy_block(uint64_t ofs);
+private:
+    void close_lazy_block(LazyBlock& b);
 };
 
 }   // namespace serialise
@@ -8,6 +8,8 @@
 #include "type.hpp"
 #include <span.hpp>
 #include "expr.hpp" // Hack for cloning array types
+#include <unordered_set>
+#include <mutex>
 
 namespace HIR {
 
@@ -136,6 +138,27 @@ Ordering HIR::ArraySize::ord(const HIR::ArraySize& x) const
     throw "";
 }
 
+size_t HIR::ArraySize::hash() const
+{
+    size_t rv = static_cast<size_t>(this->tag());
+    TU_MATCH_HDRA( (*this), {)
+    TU_ARMA(Unevaluated, se) {
+        // Same rules as `ord`: const params compare by binding, otherwise by identity
+        if( const auto* n = dynamic_cast<const HIR::ExprNode_ConstParam*>(&**se) )
+            rv = rv * 31 + n->m_binding;
+        else
+            rv = rv * 31 + reinterpret_cast<::std::uintptr_t>(se.get());
+        }
+    TU_ARMA(Generic, se) {
+        rv = rv * 31 + se.binding;
+        }
+    TU_ARMA(Known, se) {
+        rv = rv * 31 + static_cast<size_t>(se);
+        }
+    }
+    return rv;
+}
+
 HIR::ArraySize HIR::ArraySize::clone() const
 {
     TU_MATCH_HDRA( (*this), {)
@@ -274,6 +297,9 @@ bool ::HIR::TypeRef::operator==(const ::HIR::TypeRef& x) const
     
     if( !m_ptr || !x.m_ptr )
         return false;
+    // Interned types are unique, so two different interned types can't be equal
+    if( m_ptr->m_interned && x.m_ptr->m_interned )
+        return false;
     if( data().tag() != x.data().tag() )
         return false;
 
@@ -363,6 +389,8 @@ Ordering HIR::TypeRef::ord(const ::HIR::TypeRef& x) const
 {
     Ordering    rv;
 
+    if( m_ptr == x.m_ptr )
+        return OrdEqual;
     ORD( static_cast<unsigned int>(data().tag()), static_cast<unsigned int>(x.data().tag()) );
 
     TU_MATCH(::HIR::TypeData, (data(), x.data()), (te, xe),
@@ -429,6 +457,214 @@ Ordering HIR::TypeRef::ord(const ::HIR::TypeRef& x) const
     )
     throw "";
 }
+size_t HIR::TypeRef::hash() const
+{
+    assert(m_ptr);
+    size_t rv = m_ptr->m_hash;
+    if( rv != 0 )
+        return rv;
+
+    // NOTE: Only hashes what `operator==`/`ord` compare (e.g. lifetimes and path bindings are ignored)
+    rv = static_cast<size_t>(data().tag());
+    TU_MATCH_HDRA( (data()), {)
+    TU_ARMA(Infer, te) {
+        rv = rv * 31 + te.index;
+        }
+    TU_ARMA(Diverge, te) {
+        }
+    TU_ARMA(Primitive, te) {
+        rv = rv * 31 + static_cast<size_t>(te);
+        }
+    TU_ARMA(Path, te) {
+        rv = rv * 31 + te.path.hash();
+        }
+    TU_ARMA(Generic, te) {
+        rv = rv * 31 + te.name.hash();
+        rv = rv * 31 + te.binding;
+        }
+    TU_ARMA(TraitObject, te) {
+        rv = rv * 31 + te.m_trait.m_path.hash();
+        for(const auto& m : te.m_markers)
+            rv = rv * 31 + m.hash();
+        }
+    TU_ARMA(ErasedType, te) {
+        rv = rv * 31 + te.m_origin.hash();
+        }
+    TU_ARMA(Array, te) {
+        rv = rv * 31 + te.inner.hash();
+        rv = rv * 31 + te.size.hash();
+        }
+    TU_ARMA(Slice, te) {
+        rv = rv * 31 + te.inner.hash();
+        }
+    TU_ARMA(Tuple, te) {
+        for(const auto& t : te)
+            rv = rv * 31 + t.hash();
+        }
+    TU_ARMA(Borrow, te) {
+        rv = rv * 31 + static_cast<size_t>(te.type);
+        rv = rv * 31 + te.inner.hash();
+        }
+    TU_ARMA(Pointer, te) {
+        rv = rv * 31 + static_cast<size_t>(te.type);
+        rv = rv * 31 + te.inner.hash();
+        }
+    TU_ARMA(Function, te) {
+        rv = rv * 31 + (te.is_unsafe ? 1 : 0);
+        rv = rv * 31 + ::std::hash<::std::string>()(te.m_abi);
+        for(const auto& t : te.m_arg_types)
+            rv = rv * 31 + t.hash();
+        rv = rv * 31 + te.m_rettype.hash();
+        }
+    TU_ARMA(Closure, te) {
+        rv = rv * 31 + reinterpret_cast<::std::uintptr_t>(te.node);
+        }
+    }
+    // Zero is reserved for "not yet calculated"
+    if( rv == 0 )
+        rv = 1;
+    m_ptr->m_hash = rv;
+    return rv;
+}
+namespace {
+    bool s_type_interning_enabled = false;
+    ::std::mutex    s_type_intern_lock;
+    // NOTE: Leaked (created by `enable_interning`), as the types must outlive anything that still refers to them
+    ::std::unordered_set<::HIR::TypeRef>*   s_type_intern_table;
+
+    DebugCounter    s_type_intern_unique("HIR::TypeRef interned (unique)");
+    DebugCounter    s_type_intern_hits("HIR::TypeRef interned (deduplicated)");
+    DebugCounter    s_type_intern_bytes_saved("HIR::TypeRef interned (TypeInner bytes saved)");
+
+    /// Replaces all types within a freshly cloned type with their interned versions
+    /// - `ok` is cleared if any of them couldn't be interned (so the outer type can't be either)
+    struct TypeInterner
+    {
+        bool    ok = true;
+
+        void visit_type(::HIR::TypeRef& ty) {
+            ty = ty.intern();
+            ok &= ty.is_interned();
+        }
+        void visit_params(::HIR::PathParams& pp) {
+            for(auto& t : pp.m_types)
+                visit_type(t);
+            // Value parameters aren't considered by `Path::ord` (so would be merged)
+            if( !pp.m_values.empty() )
+                ok = false;
+        }
+        void visit_path(::HIR::Path& p) {
+            TU_MATCH_HDRA( (p.m_data), {)
+            TU_ARMA(Generic, e) {
+                visit_params(e.m_params);
+                }
+            TU_ARMA(UfcsInherent, e) {
+                visit_type(e.type);
+                visit_params(e.params);
+                visit_params(e.impl_params);
+                }
+            TU_ARMA(UfcsKnown, e) {
+                visit_type(e.type);
+                visit_params(e.trait.m_params);
+                visit_params(e.params);
+                }
+            TU_ARMA(UfcsUnknown, e) {
+                ok = false;
+                }
+            }
+        }
+        void visit_data(::HIR::TypeData& data) {
+            TU_MATCH_HDRA( (data), {)
+            TU_ARMA(Infer, e) {
+                ok = false;
+                }
+            TU_ARMA(Diverge, e) {
+                }
+            TU_ARMA(Primitive, e) {
+                }
+            TU_ARMA(Path, e) {
+                // Unbound paths may be bound later (and the binding isn't part of equality)
+                if( e.binding.is_Unbound() )
+                    ok = false;
+                visit_path(e.path);
+                }
+            TU_ARMA(Generic, e) {
+                }
+            TU_ARMA(TraitObject, e) {
+                visit_params(e.m_trait.m_path.m_params);
+                for(auto& b : e.m_trait.m_type_bounds)
+                    visit_type(b.second);
+                for(auto& m : e.m_markers)
+                    visit_params(m.m_params);
+                }
+            TU_ARMA(ErasedType, e) {
+                // Equality only considers the origin path
+                ok = false;
+                }
+            TU_ARMA(Array, e) {
+                visit_type(e.inner);
+                if( !e.size.is_Known() )
+                    ok = false;
+                }
+            TU_ARMA(Slice, e) {
+                visit_type(e.inner);
+                }
+            TU_ARMA(Tuple, e) {
+                for(auto& t : e)
+                    visit_type(t);
+                }
+            TU_ARMA(Borrow, e) {
+                visit_type(e.inner);
+                }
+            TU_ARMA(Pointer, e) {
+                visit_type(e.inner);
+                }
+            TU_ARMA(Function, e) {
+                for(auto& t : e.m_arg_types)
+                    visit_type(t);
+                visit_type(e.m_rettype);
+                }
+            TU_ARMA(Closure, e) {
+                // Only compared by node
+                ok = false;
+                }
+            }
+        }
+    };
+}
+void HIR::TypeRef::enable_interning()
+{
+    if( !s_type_interning_enabled )
+    {
+        s_type_intern_table = new ::std::unordered_set<::HIR::TypeRef>();
+        s_type_interning_enabled = true;
+    }
+}
+HIR::TypeRef HIR::TypeRef::intern() const
+{
+    if( !s_type_interning_enabled || !m_ptr || m_ptr->m_interned )
+        return this->clone();
+
+    // Intern all inner types first, so the table lookup (and later equality checks) compare them by pointer
+    auto rv = this->clone_shallow();
+    TypeInterner    ti;
+    ti.visit_data(rv.m_ptr->m_data);
+    if( !ti.ok )
+        return rv;
+
+    ::std::lock_guard<::std::mutex> lh(s_type_intern_lock);
+    auto it = s_type_intern_table->find(rv);
+    if( it != s_type_intern_table->end() )
+    {
+        s_type_intern_hits.inc();
+        s_type_intern_bytes_saved.add(sizeof(TypeInner));
+        return it->clone();
+    }
+    s_type_intern_unique.inc();
+    rv.m_ptr->m_interned = true;
+    s_type_intern_table->insert(rv.clone());
+    return rv;
+}
 #if 0
 bool ::HIR::TypeRef::contains_generics() const
 {
@@ -16,6 +16,7 @@
 #include "type_ref.hpp"
 #include "literal.hpp"
 #include "generic_ref.hpp"
+#include <atomic>
 
 constexpr const char* CLOSURE_PATH_PREFIX = "closure#";
 
@@ -93,6 +94,7 @@ TAGGED_UNION_EX(ArraySize, (), Unevaluated, (
     /*extra=*/(
         ArraySize clone() const;
         Ordering ord(const ArraySize& x) const;
+        size_t hash() const;
         bool operator==(const ArraySize& x) const { return ord(x) == OrdEqual; }
         bool operator!=(const ArraySize& x) const { return !operator==(x); }
     )
@@ -202,12 +204,19 @@ public:
     // Existing TypeRef
 
 private:
-    unsigned    m_refcount;
+    // NOTE: Atomic, as types are shared between worker threads (e.g. in parallel MIR optimisation)
+    ::std::atomic<unsigned> m_refcount;
+    // Cached result of `TypeRef::hash` (zero if not yet calculated, cleared by `data_mut`/`get_unique`)
+    mutable ::std::atomic<size_t>   m_hash;
+    // Set if this is the canonical copy in the intern table (see `TypeRef::intern`), must not be mutated
+    bool    m_interned;
 public:
     TypeData   m_data;
 private:
     TypeInner(TypeData d):
         m_refcount(1),
+        m_hash(0),
+        m_interned(false),
         m_data(mv$(d))
     {
     }
@@ -230,8 +239,7 @@ inline TypeRef::~TypeRef()
 {
     if(m_ptr)
     {
-        m_ptr->m_refcount -= 1;
-        if(m_ptr->m_refcount == 0)
+        if(--m_ptr->m_refcount == 0)
         {
             delete m_ptr;
             m_ptr = nullptr;
@@ -239,8 +247,10 @@ inline TypeRef::~TypeRef()
     }
 }
 inline const TypeData& TypeRef::data() const { assert(m_ptr); return m_ptr->m_data; }
-inline TypeData& TypeRef::data_mut() { assert(m_ptr); return m_ptr->m_data; }
-inline TypeData& TypeRef::get_unique() { assert(m_ptr); if(m_ptr->m_refcount != 1) *this = this->clone_shallow(); return m_ptr->m_data; }
+// NOTE: Interned types are shared by value, so get a private copy before mutating
+inline TypeData& TypeRef::data_mut() { assert(m_ptr); if(m_ptr->m_interned) *this = this->clone_shallow(); m_ptr->m_hash = 0; return m_ptr->m_data; }
+inline bool TypeRef::is_interned() const { return m_ptr && m_ptr->m_interned; }
+inline TypeData& TypeRef::get_unique() { assert(m_ptr); if(m_ptr->m_refcount != 1) *this = this->clone_shallow(); m_ptr->m_hash = 0; return m_ptr->m_data; }
 
 
 inline TypeRef::TypeRef(::HIR::CoreType ct):
@@ -305,6 +315,26 @@ inline const ::HIR::SimplePath* TypeRef::get_sort_path() const {
         return nullptr;
     }
 }
+inline unsigned TypeRef::get_impl_sort_key() const {
+    unsigned sub = 0;
+    switch(this->data().tag())
+    {
+    case TypeData::TAGDEAD:
+    case TypeData::TAG_Infer:
+    case TypeData::TAG_Generic:
+    case TypeData::TAG_Path:
+    case TypeData::TAG_ErasedType:
+        return ~0u;
+    case TypeData::TAG_Primitive:   sub = static_cast<unsigned>(this->data().as_Primitive());   break;
+    case TypeData::TAG_Borrow:  sub = static_cast<unsigned>(this->data().as_Borrow().type);  break;
+    case TypeData::TAG_Pointer: sub = static_cast<unsigned>(this->data().as_Pointer().type); break;
+    case TypeData::TAG_Tuple:   sub = this->data().as_Tuple().size();  break;
+    case TypeData::TAG_Function:    sub = this->data().as_Function().m_arg_types.size(); break;
+    default:
+        break;
+    }
+    return (static_cast<unsigned>(this->data().tag()) << 16) | (sub & 0xFFFF);
+}
 
 #if 0
 // TODO: Convert to a shared_ptr (or interior RC)
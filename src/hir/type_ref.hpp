@@ -107,6 +107,15 @@ public:
     bool operator!=(const ::HIR::TypeRef& x) const { return !(*this == x); }
     bool operator<(const ::HIR::TypeRef& x) const { return ord(x) == OrdLess; }
     Ordering ord(const ::HIR::TypeRef& x) const;
+    /// Structural hash, consistent with `operator==` (cached in the inner data)
+    size_t hash() const;
+
+    /// Enable hash-consing of fully resolved types (see `intern`), `-Z intern-types`
+    static void enable_interning();
+    /// Get the canonical shared copy of this type (equal interned types share the same inner data, so compare by pointer)
+    /// - Returns a plain clone if interning is disabled, or if the type isn't fully resolved (ivars, erased types, unbound paths)
+    TypeRef intern() const;
+    bool is_interned() const;
 
 
     //void match_generics(const Span& sp, const ::HIR::TypeRef& x_in, t_cb_resolve_type resolve_placeholder, MatchGenerics& callback) const;
@@ -118,6 +127,16 @@ public:
     Compare compare_with_placeholders(const Span& sp, const ::HIR::TypeRef& x, t_cb_resolve_type resolve_placeholder) const;
 
     const ::HIR::SimplePath* get_sort_path() const;
+    /// Grouping key for impls on types without a sort path (outer type tag, plus primitive kind/borrow type/arity)
+    /// - Returns `~0u` if the outer structure isn't known (ivars, generics, non-generic paths)
+    unsigned get_impl_sort_key() const;
 };
 
-}
\ No newline at end of file
+}
+
+namespace std {
+    template<> struct hash< ::HIR::TypeRef>
+    {
+        size_t operator()(const ::HIR::TypeRef& x) const { return x.hash(); }
+    };
+}
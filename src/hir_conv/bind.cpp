@@ -711,150 +711,152 @@ namespace {
                 (*expr).visit(v);
             }
             // External expression (has MIR)
-            else if( auto* mir = expr.get_ext_mir_mut() )
+            // - Not-yet-loaded MIR is visited when it's loaded (see ConvertHIR_Bind)
+            else if( expr.m_mir.is_loaded() )
             {
-                struct H {
-                    static void visit_lvalue(Visitor& upper_visitor, ::MIR::LValue& lv)
-                    {
-                        if( lv.m_root.is_Static() ) {
-                            upper_visitor.visit_path(lv.m_root.as_Static(), ::HIR::Visitor::PathContext::VALUE);
-                        }
+                visit_mir(*expr.get_ext_mir_mut());
+            }
+        }
+        void visit_mir(::MIR::Function& mir)
+        {
+            struct H {
+                static void visit_lvalue(Visitor& upper_visitor, ::MIR::LValue& lv)
+                {
+                    if( lv.m_root.is_Static() ) {
+                        upper_visitor.visit_path(lv.m_root.as_Static(), ::HIR::Visitor::PathContext::VALUE);
                     }
-                    static void visit_constant(Visitor& upper_visitor, ::MIR::Constant& e)
-                    {
-                        TU_MATCHA( (e), (ce),
-                        (Int, ),
-                        (Uint,),
-                        (Float, ),
-                        (Bool, ),
-                        (Bytes, ),
-                        (StaticString, ),  // String
-                        (Const,
-                            upper_visitor.visit_path(*ce.p, ::HIR::Visitor::PathContext::VALUE);
+                }
+                static void visit_constant(Visitor& upper_visitor, ::MIR::Constant& e)
+                {
+                    TU_MATCHA( (e), (ce),
+                    (Int, ),
+                    (Uint,),
+                    (Float, ),
+                    (Bool, ),
+                    (Bytes, ),
+                    (StaticString, ),  // String
+                    (Const,
+                        upper_visitor.visit_path(*ce.p, ::HIR::Visitor::PathContext::VALUE);
+                        ),
+                    (Generic,
+                        ),
+                    (ItemAddr,
+                        upper_visitor.visit_path(*ce, ::HIR::Visitor::PathContext::VALUE);
+                        )
+                    )
+                }
+                static void visit_param(Visitor& upper_visitor, ::MIR::Param& p)
+                {
+                    TU_MATCHA( (p), (e),
+                    (LValue,
+                        H::visit_lvalue(upper_visitor, e);
+                        ),
+                    (Borrow,
+                        H::visit_lvalue(upper_visitor, e.val);
+                        ),
+                    (Constant,
+                        H::visit_constant(upper_visitor, e);
+                        )
+                    )
+                }
+            };
+            for(auto& ty : mir.locals)
+                this->visit_type(ty);
+            for(auto& block : mir.blocks)
+            {
+                for(auto& stmt : block.statements)
+                {
+                    TU_IFLET(::MIR::Statement, stmt, Assign, se,
+                        H::visit_lvalue(*this, se.dst);
+                        TU_MATCHA( (se.src), (e),
+                        (Use,
+                            H::visit_lvalue(*this, e);
                             ),
-                        (Generic,
+                        (Constant,
+                            H::visit_constant(*this, e);
                             ),
-                        (ItemAddr,
-                            upper_visitor.visit_path(*ce, ::HIR::Visitor::PathContext::VALUE);
-                            )
-                        )
-                    }
-                    static void visit_param(Visitor& upper_visitor, ::MIR::Param& p)
-                    {
-                        TU_MATCHA( (p), (e),
-                        (LValue,
-                            H::visit_lvalue(upper_visitor, e);
+                        (SizedArray,
+                            H::visit_param(*this, e.val);
                             ),
                         (Borrow,
-                            H::visit_lvalue(upper_visitor, e.val);
+                            H::visit_lvalue(*this, e.val);
                             ),
-                        (Constant,
-                            H::visit_constant(upper_visitor, e);
-                            )
-                        )
-                    }
-                };
-                for(auto& ty : mir->locals)
-                    this->visit_type(ty);
-                for(auto& block : mir->blocks)
-                {
-                    for(auto& stmt : block.statements)
-                    {
-                        TU_IFLET(::MIR::Statement, stmt, Assign, se,
-                            H::visit_lvalue(*this, se.dst);
-                            TU_MATCHA( (se.src), (e),
-                            (Use,
-                                H::visit_lvalue(*this, e);
-                                ),
-                            (Constant,
-                                H::visit_constant(*this, e);
-                                ),
-                            (SizedArray,
-                                H::visit_param(*this, e.val);
-                                ),
-                            (Borrow,
-                                H::visit_lvalue(*this, e.val);
-                                ),
-                            (Cast,
-                                H::visit_lvalue(*this, e.val);
-                                this->visit_type(e.type);
-                                ),
-                            (BinOp,
-                                H::visit_param(*this, e.val_l);
-                                H::visit_param(*this, e.val_r);
-                                ),
-                            (UniOp,
-                                H::visit_lvalue(*this, e.val);
-                                ),
-                            (DstMeta,
-                                H::visit_lvalue(*this, e.val);
-                                ),
-                            (DstPtr,
-                                H::visit_lvalue(*this, e.val);
-                                ),
-                            (MakeDst,
-                                H::visit_param(*this, e.ptr_val);
-                                H::visit_param(*this, e.meta_val);
-                                ),
-                            (Tuple,
-                                for(auto& val : e.vals)
-                                    H::visit_param(*this, val);
-                                ),
-                            (Array,
-                                for(auto& val : e.vals)
-                                    H::visit_param(*this, val);
-                                ),
-                            (Variant,
-                                H::visit_param(*this, e.val);
-                                ),
-                            (Struct,
-                                for(auto& val : e.vals)
-                                    H::visit_param(*this, val);
-                                )
+                        (Cast,
+                            H::visit_lvalue(*this, e.val);
+                            this->visit_type(e.type);
+                            ),
+                        (BinOp,
+                            H::visit_param(*this, e.val_l);
+                            H::visit_param(*this, e.val_r);
+                            ),
+                        (UniOp,
+                            H::visit_lvalue(*this, e.val);
+                            ),
+                        (DstMeta,
+                            H::visit_lvalue(*this, e.val);
+                            ),
+                        (DstPtr,
+                            H::visit_lvalue(*this, e.val);
+                            ),
+                        (MakeDst,
+                            H::visit_param(*this, e.ptr_val);
+                            H::visit_param(*this, e.meta_val);
+                            ),
+                        (Tuple,
+                            for(auto& val : e.vals)
+                                H::visit_param(*this, val);
+                            ),
+                        (Array,
+                            for(auto& val : e.vals)
+                                H::visit_param(*this, val);
+                            ),
+                        (Variant,
+                            H::visit_param(*this, e.val);
+                            ),
+                        (Struct,
+                            for(auto& val : e.vals)
+                                H::visit_param(*this, val);
                             )
                         )
-                        else TU_IFLET(::MIR::Statement, stmt, Drop, se,
-                            H::visit_lvalue(*this, se.slot);
-                        )
-                        else {
-                        }
+                    )
+                    else TU_IFLET(::MIR::Statement, stmt, Drop, se,
+                        H::visit_lvalue(*this, se.slot);
+                    )
+                    else {
                     }
-                    TU_MATCHA( (block.terminator), (te),
-                    (Incomplete, ),
-                    (Return, ),
-                    (Diverge, ),
-                    (Goto, ),
-                    (Panic, ),
-                    (If,
-                        H::visit_lvalue(*this, te.cond);
-                        ),
-                    (Switch,
-                        H::visit_lvalue(*this, te.val);
+                }
+                TU_MATCHA( (block.terminator), (te),
+                (Incomplete, ),
+                (Return, ),
+                (Diverge, ),
+                (Goto, ),
+                (Panic, ),
+                (If,
+                    H::visit_lvalue(*this, te.cond);
+                    ),
+                (Switch,
+                    H::visit_lvalue(*this, te.val);
+                    ),
+                (SwitchValue,
+                    H::visit_lvalue(*this, te.val);
+                    ),
+                (Call,
+                    H::visit_lvalue(*this, te.ret_val);
+                    TU_MATCHA( (te.fcn), (e2),
+                    (Value,
+                        H::visit_lvalue(*this, e2);
                         ),
-                    (SwitchValue,
-                        H::visit_lvalue(*this, te.val);
+                    (Path,
+                        visit_path(e2, ::HIR::Visitor::PathContext::VALUE);
                         ),
-                    (Call,
-                        H::visit_lvalue(*this, te.ret_val);
-                        TU_MATCHA( (te.fcn), (e2),
-                        (Value,
-                            H::visit_lvalue(*this, e2);
-                            ),
-                        (Path,
-                            visit_path(e2, ::HIR::Visitor::PathContext::VALUE);
-                            ),
-                        (Intrinsic,
-                            visit_path_params(e2.params);
-                            )
-                        )
-                        for(auto& arg : te.args)
-                            H::visit_param(*this, arg);
+                    (Intrinsic,
+                        visit_path_params(e2.params);
                         )
                     )
-                }
-            }
-            else
-            {
+                    for(auto& arg : te.args)
+                        H::visit_param(*this, arg);
+                    )
+                )
             }
         }
     };
@@ -868,6 +870,22 @@ void ConvertHIR_Bind(::HIR::Crate& crate)
     for(auto& ec : crate.m_ext_crates)
     {
         exp.visit_crate( *ec.second.m_data );
+
+        // Impls and MIR that are decoded later are bound as they're loaded
+        // - A fresh visitor is used for each, as loads can happen on any thread
+        if( auto& loader = ec.second.m_data->m_loader )
+        {
+            const ::HIR::Crate& root = crate;
+            loader->m_hooks.trait_impl = [&root](const ::HIR::SimplePath& trait_path, ::HIR::TraitImpl& impl) {
+                Visitor(root).visit_trait_impl(trait_path, impl);
+                };
+            loader->m_hooks.marker_impl = [&root](const ::HIR::SimplePath& trait_path, ::HIR::MarkerImpl& impl) {
+                Visitor(root).visit_marker_impl(trait_path, impl);
+                };
+            loader->m_hooks.mir = [&root](::MIR::Function& mir) {
+                Visitor(root).visit_mir(mir);
+                };
+        }
     }
 
     exp.visit_crate( crate );
@@ -756,18 +756,20 @@ namespace {
         auto new_end = ::std::remove_if(ig.generic.begin(), ig.generic.end(), [&ig](::std::unique_ptr<T>& ty_impl) {
             const auto& type = ty_impl->m_type;  // Using field accesses in templates feels so dirty
             const ::HIR::SimplePath*    path = type.get_sort_path();
+            unsigned key = type.get_impl_sort_key();
 
             if( path )
             {
                 ig.named[*path].push_back(mv$(ty_impl));
             }
-            else if( type.data().is_Path() || type.data().is_Generic() )
+            else if( key == ~0u )
             {
+                // Generics and non-generic paths stay in the unsorted list
                 return false;
             }
             else
             {
-                ig.non_named.push_back(mv$(ty_impl));
+                ig.non_named[key].push_back(mv$(ty_impl));
             }
             return true;
             });
@@ -790,7 +792,7 @@ void ConvertHIR_ResolveUFCS_SortImpls(::HIR::Crate& crate)
 {
     // Sort impls!
     sort_impl_group(crate.m_type_impls);
-    DEBUG("Type impl counts: " << crate.m_type_impls.named.size() << " path groups, " << crate.m_type_impls.non_named.size() << " primitive, " << crate.m_type_impls.generic.size() << " ungrouped");
+    DEBUG("Type impl counts: " << crate.m_type_impls.named.size() << " path groups, " << crate.m_type_impls.non_named.size() << " unnamed groups, " << crate.m_type_impls.generic.size() << " ungrouped");
     for(auto& impl_group : crate.m_trait_impls)
     {
         sort_impl_group(impl_group.second);
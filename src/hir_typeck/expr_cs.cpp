@@ -16,6 +16,9 @@
 #include "expr_visit.hpp"
 
 namespace {
+    DebugCounter    s_rule_checks("Typecheck rule checks");
+    DebugCounter    s_rule_skips("Typecheck rule checks skipped (inputs unchanged)");
+
     inline HIR::ExprNodeP mk_exprnodep(HIR::ExprNode* en, ::HIR::TypeRef ty){ en->m_res_type = mv$(ty); return HIR::ExprNodeP(en); }
 
     inline ::HIR::SimplePath get_parent_path(const ::HIR::SimplePath& sp) {
@@ -85,6 +88,12 @@ struct Context
         ::HIR::TypeRef  left_ty;
         ::HIR::ExprNodeP* right_node_ptr;
 
+        /// If non-zero, the ivar generation at which this rule was last checked without effect
+        unsigned long   inert_gen = 0;
+        /// Source node/type at the time of that check (the node can be replaced, and its type updated)
+        const ::HIR::ExprNode*  inert_node = nullptr;
+        ::HIR::TypeRef  inert_src_ty;
+
         friend ::std::ostream& operator<<(::std::ostream& os, const Coercion& v) {
             os << "R" << v.rule_idx << " " << v.left_ty << " := " << v.right_node_ptr << " " << &**v.right_node_ptr << " (" << (*v.right_node_ptr)->m_res_type << ")";
             return os;
@@ -104,6 +113,9 @@ struct Context
         // HACK: operators are special - the result when both types are primitives is ALWAYS the lefthand side
         bool    is_operator;
 
+        /// If non-zero, the ivar generation at which this rule was last checked without effect
+        unsigned long   inert_gen = 0;
+
         friend ::std::ostream& operator<<(::std::ostream& os, const Associated& v) {
             os << "R" << v.rule_idx << " ";
             if( v.name == "" ) {
@@ -175,6 +187,9 @@ struct Context
     // - If it is, then we can discount any unsized possibilities
     ::std::vector<bool> m_ivars_sized;
     ::std::vector< IVarPossible>    possible_ivar_vals;
+    /// Count of updates to state that isn't tracked by `m_ivars` (possibilities, revisits, sized flags)
+    /// - Used to tell if a coercion/associated rule check had any effect
+    unsigned long   m_rule_effects = 0;
 
     const ::HIR::SimplePath m_lang_Box;
 
@@ -5319,9 +5334,11 @@ void Context::equate_types_assoc(const Span& sp, const ::HIR::TypeRef& l,  const
 }
 void Context::add_revisit(::HIR::ExprNode& node) {
     this->to_visit.push_back( &node );
+    this->m_rule_effects ++;
 }
 void Context::add_revisit_adv(::std::unique_ptr<Revisitor> ent_ptr) {
     this->adv_revisits.push_back( mv$(ent_ptr) );
+    this->m_rule_effects ++;
 }
 void Context::require_sized(const Span& sp, const ::HIR::TypeRef& ty_)
 {
@@ -5344,7 +5361,13 @@ void Context::require_sized(const Span& sp, const ::HIR::TypeRef& ty_)
             ASSERT_BUG(sp, e->index != ~0u, "Unbound ivar " << ty);
             if(e->index >= m_ivars_sized.size())
                 m_ivars_sized.resize(e->index+1);
-            m_ivars_sized.at(e->index) = true;
+            if( !m_ivars_sized.at(e->index) )
+            {
+                m_ivars_sized.at(e->index) = true;
+                // Sized-ness changes the result of coercion checks on this ivar
+                m_ivars.touch_ivar(e->index);
+                m_rule_effects ++;
+            }
             break;
         }
     }
@@ -5428,6 +5451,7 @@ void Context::possible_equate_type(unsigned int ivar_index, const ::HIR::TypeRef
         : (is_to ? ent.types_coerce_to : ent.types_coerce_from)
         );
     list.push_back( t.clone() );
+    m_rule_effects ++;
 }
 void Context::possible_equate_type_bound(const Span& sp, unsigned int ivar_index, const ::HIR::TypeRef& t) {
     {
@@ -5457,6 +5481,7 @@ void Context::possible_equate_type_bound(const Span& sp, unsigned int ivar_index
         }
     }
     ent.bounded.push_back( t.clone() );
+    m_rule_effects ++;
     if( t.data().is_Infer() )
         DEBUG(ivar_index << " bounded as " << t << " " << this->m_ivars.get_type(t));
     else
@@ -5476,6 +5501,7 @@ void Context::possible_equate_type_disable(unsigned int ivar_index, bool is_to)
     else {
         ent.force_no_from = true;
     }
+    m_rule_effects ++;
 }
 void Context::possible_equate_type_disable_strong(const Span& sp, unsigned int ivar_index)
 {
@@ -5487,6 +5513,7 @@ void Context::possible_equate_type_disable_strong(const Span& sp, unsigned int i
     }
     auto& ent = possible_ivar_vals[ivar_index];
     ent.force_disable = true;
+    m_rule_effects ++;
 }
 
 void Context::add_var(const Span& sp, unsigned int index, const RcString& name, ::HIR::TypeRef type) {
@@ -7249,6 +7276,7 @@ namespace {
             {
                 DEBUG("Set IVar " << i << " = ! (no rules, and is diverge-class ivar)");
                 context.m_ivars.get_type(i) = ::HIR::TypeRef::new_diverge();
+                context.m_ivars.touch_ivar(i);
                 context.m_ivars.mark_change();
                 return true;
             }
@@ -7385,6 +7413,7 @@ namespace {
                     DEBUG("- Diverge with no source types, force setting to !");
                     DEBUG("Set IVar " << i << " = !");
                     context.m_ivars.get_type(i) = ::HIR::TypeRef::new_diverge();
+                    context.m_ivars.touch_ivar(i);
                     context.m_ivars.mark_change();
                     return true;
                 }
@@ -8566,79 +8595,141 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
         TRACE_FUNCTION_F("=== PASS " << count << " ===");
         context.dump();
 
-        // 1. Check coercions for ones that cannot coerce due to RHS type (e.g. `str` which doesn't coerce to anything)
-        // 2. (???) Locate coercions that cannot coerce (due to being the only way to know a type)
-        // - Keep a list in the ivar of what types that ivar could be equated to.
-        DEBUG("--- Coercion checking");
-        for(size_t i = 0; i < context.link_coerce.size(); )
-        {
-            auto ent = mv$(context.link_coerce[i]);
-            const auto& span = (*ent->right_node_ptr)->span();
-            auto& src_ty = (*ent->right_node_ptr)->m_res_type;
-            //src_ty = context.m_resolve.expand_associated_types( span, mv$(src_ty) );
-            ent->left_ty = context.m_resolve.expand_associated_types( span, mv$(ent->left_ty) );
-            if( check_coerce(context, *ent) )
-            {
-                DEBUG("- Consumed coercion R" << ent->rule_idx << " " << ent->left_ty << " := " << src_ty);
-
-#if 0
-                // If this isn't the last item in the list
-                if( i != context.link_coerce.size() - 1 )
+        // Coercion and associated type rules are only re-checked if an ivar they reference has changed since they were last
+        // checked without effect (the check is otherwise deterministic).
+        // - Returns the number of rules skipped
+        // - If `recheck_inert` is set, only the rules that were inert are checked (rules with effects have already been checked this pass)
+        auto check_rules = [&](bool recheck_inert)->unsigned {
+            unsigned n_skipped = 0;
+            // 1. Check coercions for ones that cannot coerce due to RHS type (e.g. `str` which doesn't coerce to anything)
+            // 2. (???) Locate coercions that cannot coerce (due to being the only way to know a type)
+            // - Keep a list in the ivar of what types that ivar could be equated to.
+            DEBUG("--- Coercion checking");
+            size_t  n_kept = 0;
+            for(size_t i = 0; i < context.link_coerce.size(); i ++)
+            {
+                auto ent = mv$(context.link_coerce[i]);
+                const auto& span = (*ent->right_node_ptr)->span();
+                auto& src_ty = (*ent->right_node_ptr)->m_res_type;
+                bool keep;
+                if( recheck_inert ? ent->inert_gen == 0 : (ent->inert_gen != 0
+                    && ent->inert_node == &**ent->right_node_ptr && ent->inert_src_ty == src_ty
+                    && !context.m_ivars.type_changed_since(ent->left_ty, ent->inert_gen)
+                    && !context.m_ivars.type_changed_since(src_ty, ent->inert_gen)
+                    ) )
                 {
-                    // Swap with the last item
-                    context.link_coerce[i] = mv$(context.link_coerce.back());
+                    n_skipped ++;
+                    s_rule_skips.inc();
+                    keep = true;
                 }
-                // Remove the last item.
-                context.link_coerce.pop_back();
-#else
-                context.link_coerce.erase( context.link_coerce.begin() + i );
-#endif
-            }
-            else
-            {
-                context.link_coerce[i] = mv$(ent);
-                ++ i;
-            }
-        }
-        // 3. Check associated type rules
-        DEBUG("--- Associated types");
-        unsigned int link_assoc_iter_limit = context.link_assoc.size() * 4;
-        for(unsigned int i = 0; i < context.link_assoc.size(); ) {
-            // - Move out (and back in later) to avoid holding a bad pointer if the list is updated
-            auto rule = mv$(context.link_assoc[i]);
-
-            DEBUG("- " << rule);
-            for( auto& ty : rule.params.m_types ) {
-                ty = context.m_resolve.expand_associated_types(rule.span, mv$(ty));
-            }
-            if( rule.name != "" ) {
-                rule.left_ty = context.m_resolve.expand_associated_types(rule.span, mv$(rule.left_ty));
-                // HACK: If the left type is `!`, remove the type bound
-                //if( rule.left_ty.data().is_Diverge() ) {
-                //    rule.name = "";
-                //}
-            }
-            rule.impl_ty = context.m_resolve.expand_associated_types(rule.span, mv$(rule.impl_ty));
-
-            if( check_associated(context, rule) ) {
-                DEBUG("- Consumed associated type rule " << i << "/" << context.link_assoc.size() << " - " << rule);
-                if( i != context.link_assoc.size()-1 )
+                else
+                {
+                    s_rule_checks.inc();
+                    auto pre_changes = context.m_ivars.change_count();
+                    auto pre_gen = context.m_ivars.generation();
+                    auto pre_effects = context.m_rule_effects;
+                    //src_ty = context.m_resolve.expand_associated_types( span, mv$(src_ty) );
+                    ent->left_ty = context.m_resolve.expand_associated_types( span, mv$(ent->left_ty) );
+                    if( check_coerce(context, *ent) )
+                    {
+                        DEBUG("- Consumed coercion R" << ent->rule_idx << " " << ent->left_ty << " := " << src_ty);
+                        keep = false;
+                    }
+                    else
+                    {
+                        if( pre_changes == context.m_ivars.change_count() && pre_gen == context.m_ivars.generation() && pre_effects == context.m_rule_effects )
+                        {
+                            const auto& node = **ent->right_node_ptr;
+                            ent->inert_gen = context.m_ivars.generation();
+                            ent->inert_node = &node;
+                            ent->inert_src_ty = node.m_res_type.clone();
+                        }
+                        else
+                        {
+                            ent->inert_gen = 0;
+                        }
+                        keep = true;
+                    }
+                }
+                // Compact the list in-place (rules can be added during iteration)
+                if( keep )
+                {
+                    context.link_coerce[n_kept++] = mv$(ent);
+                }
+            }
+            context.link_coerce.resize(n_kept);
+            // 3. Check associated type rules
+            DEBUG("--- Associated types");
+            unsigned int link_assoc_iter_limit = context.link_assoc.size() * 4;
+            for(unsigned int i = 0; i < context.link_assoc.size(); ) {
+                // - Move out (and back in later) to avoid holding a bad pointer if the list is updated
+                auto rule = mv$(context.link_assoc[i]);
+
+                if( recheck_inert ? rule.inert_gen == 0 : (rule.inert_gen != 0
+                    && !context.m_ivars.type_changed_since(rule.impl_ty, rule.inert_gen)
+                    && !context.m_ivars.pathparams_changed_since(rule.params, rule.inert_gen)
+                    && !(rule.name != "" && context.m_ivars.type_changed_since(rule.left_ty, rule.inert_gen))
+                    ) )
                 {
-                    //assert( context.link_assoc[i] != context.link_assoc.back() );
-                    context.link_assoc[i] = mv$( context.link_assoc.back() );
+                    n_skipped ++;
+                    s_rule_skips.inc();
+                    context.link_assoc[i] = mv$(rule);
+                    i ++;
+                }
+                else
+                {
+                    s_rule_checks.inc();
+                    auto pre_changes = context.m_ivars.change_count();
+                    auto pre_gen = context.m_ivars.generation();
+                    auto pre_effects = context.m_rule_effects;
+
+                    DEBUG("- " << rule);
+                    for( auto& ty : rule.params.m_types ) {
+                        ty = context.m_resolve.expand_associated_types(rule.span, mv$(ty));
+                    }
+                    if( rule.name != "" ) {
+                        rule.left_ty = context.m_resolve.expand_associated_types(rule.span, mv$(rule.left_ty));
+                        // HACK: If the left type is `!`, remove the type bound
+                        //if( rule.left_ty.data().is_Diverge() ) {
+                        //    rule.name = "";
+                        //}
+                    }
+                    rule.impl_ty = context.m_resolve.expand_associated_types(rule.span, mv$(rule.impl_ty));
+
+                    if( check_associated(context, rule) ) {
+                        DEBUG("- Consumed associated type rule " << i << "/" << context.link_assoc.size() << " - " << rule);
+                        if( i != context.link_assoc.size()-1 )
+                        {
+                            //assert( context.link_assoc[i] != context.link_assoc.back() );
+                            context.link_assoc[i] = mv$( context.link_assoc.back() );
+                        }
+                        context.link_assoc.pop_back();
+                    }
+                    else {
+                        if( pre_changes == context.m_ivars.change_count() && pre_gen == context.m_ivars.generation() && pre_effects == context.m_rule_effects )
+                        {
+                            rule.inert_gen = context.m_ivars.generation();
+                        }
+                        else
+                        {
+                            rule.inert_gen = 0;
+                        }
+                        context.link_assoc[i] = mv$(rule);
+                        i ++;
+                    }
                 }
-                context.link_assoc.pop_back();
-            }
-            else {
-                context.link_assoc[i] = mv$(rule);
-                i ++;
-            }
 
-            if( link_assoc_iter_limit -- == 0 )
-            {
-                DEBUG("link_assoc iteration limit exceeded");
-                break;
+                if( link_assoc_iter_limit -- == 0 )
+                {
+                    DEBUG("link_assoc iteration limit exceeded");
+                    break;
+                }
             }
+            return n_skipped;
+            };
+        unsigned n_rules_skipped = check_rules(/*recheck_inert=*/false);
+        if( n_rules_skipped > 0 ) {
+            DEBUG("- Skipped " << n_rules_skipped << " unchanged rules");
         }
         // 4. Revisit nodes that require revisiting
         DEBUG("--- Node revisits");
@@ -8665,12 +8756,24 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
                 auto& ent = *context.adv_revisits[i];
                 adv_revisit_remove_list.push_back( ent.revisit(context, /*is_fallback=*/false) );
             }
-            for(size_t i = len; i --;)
+            // Compact in-place (keeping any callbacks added during the revisits)
+            size_t  n_kept = 0;
+            for(size_t i = 0; i < context.adv_revisits.size(); i ++)
             {
-                if( adv_revisit_remove_list[i] ) {
-                    context.adv_revisits.erase( context.adv_revisits.begin() + i );
-                }
+                if( i < len && adv_revisit_remove_list[i] )
+                    continue ;
+                if( n_kept != i )
+                    context.adv_revisits[n_kept] = mv$(context.adv_revisits[i]);
+                n_kept ++;
             }
+            context.adv_revisits.resize(n_kept);
+        }
+
+        // Before falling back to ivar possibilities, ensure that no skipped rule would have made progress
+        if( ! context.m_ivars.peek_changed() && n_rules_skipped > 0 )
+        {
+            DEBUG("--- Re-checking inert rules");
+            check_rules(/*recheck_inert=*/true);
         }
 
         // If nothing changed this pass, apply ivar possibilities
@@ -10,6 +10,11 @@
 #include <hir/visitor.hpp>
 #include "expr_visit.hpp"
 #include <hir/expr_state.hpp>
+#include <debug_inner.hpp>  // DebugCapture, DebugTimedItem
+#include <thread_pool.hpp>
+#include <atomic>
+#include <exception>  // exception_ptr
+#include <cstdint>    // SIZE_MAX
 
 void Typecheck_Code(const typeck::ModuleState& ms, t_args& args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr) {
     if( expr.m_state->stage < ::HIR::ExprState::Stage::Typecheck )
@@ -105,17 +110,66 @@ namespace typeck {
 
 namespace {
 
+    /// A deferred call to `Typecheck_Code` (parallel mode)
+    struct TypecheckRequest
+    {
+        ::typeck::ModuleState   ms;
+        t_args* args;   // nullptr if the item has no arguments
+        ::HIR::TypeRef  result_type;
+        ::HIR::ExprPtr* expr;
+        // Item name for `--timings-json` (only populated if enabled)
+        ::std::string   name;
+    };
+    /// A unit of work for the parallel mode
+    /// - Requests for the same expression (e.g. a shared array size) are grouped into one job, and run in visit order
+    struct TypecheckJob
+    {
+        ::std::vector<TypecheckRequest> requests;
+        ::std::string   debug_output;
+        ::std::exception_ptr    error;  // Set if checking failed (reported after all workers have finished)
+    };
+    struct TypecheckJobList
+    {
+        ::std::vector<TypecheckJob> jobs;
+        ::std::map<const ::HIR::ExprPtr*, size_t>   job_for_expr;
+    };
 
     class OuterVisitor:
         public ::HIR::Visitor
     {
         ::typeck::ModuleState m_ms;
+        // If non-null, bodies are queued here instead of being checked immediately
+        TypecheckJobList*   m_jobs;
     public:
-        OuterVisitor(::HIR::Crate& crate):
-            m_ms(crate)
+        OuterVisitor(::HIR::Crate& crate, TypecheckJobList* jobs=nullptr):
+            m_ms(crate),
+            m_jobs(jobs)
         {
         }
 
+    private:
+        void typecheck(::std::function<void(::std::ostream&)> name_cb, t_args* args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr)
+        {
+            if( !m_jobs )
+            {
+                DebugTimedItem  timed_item(name_cb);
+                t_args  tmp;
+                Typecheck_Code(m_ms, args ? *args : tmp, result_type, expr);
+                return ;
+            }
+
+            auto it = m_jobs->job_for_expr.find(&expr);
+            if( it == m_jobs->job_for_expr.end() )
+            {
+                it = m_jobs->job_for_expr.insert(::std::make_pair( &expr, m_jobs->jobs.size() )).first;
+                m_jobs->jobs.push_back(TypecheckJob());
+            }
+            ::std::string   name;
+            if( debug_timings_enabled() )
+                name = FMT(FmtLambda(name_cb));
+            m_jobs->jobs[it->second].requests.push_back(TypecheckRequest { m_ms, args, result_type.clone(), &expr, ::std::move(name) });
+        }
+
 
     public:
         void visit_module(::HIR::ItemPath p, ::HIR::Module& mod) override
@@ -175,9 +229,8 @@ namespace {
             {
                 this->visit_type( e->inner );
                 DEBUG("Array size " << ty);
-                t_args  tmp;
                 if( auto* se = e->size.opt_Unevaluated() ) {
-                    Typecheck_Code( m_ms, tmp, ::HIR::TypeRef(::HIR::CoreType::Usize), **se );
+                    this->typecheck( [&](::std::ostream& os){ os << "array size of " << ty; }, nullptr, ::HIR::TypeRef(::HIR::CoreType::Usize), **se );
                 }
             }
             else {
@@ -192,7 +245,7 @@ namespace {
             if( item.m_code )
             {
                 DEBUG("Function code " << p);
-                Typecheck_Code( m_ms, item.m_args, item.m_return, item.m_code );
+                this->typecheck( [&](::std::ostream& os){ os << p; }, &item.m_args, item.m_return, item.m_code );
             }
             else
             {
@@ -204,8 +257,7 @@ namespace {
             if( item.m_value )
             {
                 DEBUG("Static value " << p);
-                t_args  tmp;
-                Typecheck_Code(m_ms, tmp, item.m_type, item.m_value);
+                this->typecheck([&](::std::ostream& os){ os << p; }, nullptr, item.m_type, item.m_value);
             }
         }
         void visit_constant(::HIR::ItemPath p, ::HIR::Constant& item) override {
@@ -213,8 +265,7 @@ namespace {
             if( item.m_value )
             {
                 DEBUG("Const value " << p);
-                t_args  tmp;
-                Typecheck_Code(m_ms, tmp, item.m_type, item.m_value);
+                this->typecheck([&](::std::ostream& os){ os << p; }, nullptr, item.m_type, item.m_value);
             }
         }
         void visit_enum(::HIR::ItemPath p, ::HIR::Enum& item) override {
@@ -229,8 +280,7 @@ namespace {
                     DEBUG("Enum value " << p << " - " << var.name);
                     if( var.expr )
                     {
-                        t_args  tmp;
-                        Typecheck_Code(m_ms, tmp, enum_type, var.expr);
+                        this->typecheck([&](::std::ostream& os){ os << p << "::" << var.name; }, nullptr, enum_type, var.expr);
                     }
                 }
             }
@@ -238,8 +288,69 @@ namespace {
     };
 }
 
-void Typecheck_Expressions(::HIR::Crate& crate)
+void Typecheck_Expressions(::HIR::Crate& crate, unsigned num_threads)
 {
-    OuterVisitor    visitor { crate };
-    visitor.visit_crate( crate );
+    if( num_threads <= 1 )
+    {
+        OuterVisitor    visitor { crate };
+        visitor.visit_crate( crate );
+        return ;
+    }
+
+    // Parallel mode: Collect all bodies (in visit order), then check them on a worker pool.
+    // - Each body is only written by its own job (typeck only reads the rest of the crate), so the result is the same as a
+    //   serial run. Debug output is captured per job and emitted in visit order.
+    TypecheckJobList    jobs;
+    {
+        OuterVisitor    visitor { crate, &jobs };
+        visitor.visit_crate( crate );
+    }
+    DEBUG(jobs.jobs.size() << " bodies to typecheck using " << num_threads << " threads");
+
+    // Fatal errors are caught per job, and the first (in visit order) is reported - along with its debug output - once
+    // all the workers have finished (exiting with live threads isn't safe).
+    // - Jobs after the first known failure are skipped, as their results won't be used
+    bool debug_on = debug_enabled();
+    ::std::atomic<size_t>   first_failed { SIZE_MAX };
+    parallel_for_each_index(num_threads, jobs.jobs.size(), [&](size_t idx) {
+        if( idx > first_failed.load() )
+            return ;
+        auto& job = jobs.jobs[idx];
+        DebugCapture    capture;
+        DeferFatalSpanErrors    defer_errors;
+        try
+        {
+            for(auto& req : job.requests)
+            {
+                DebugTimedItem  timed_item([&](::std::ostream& os){ os << req.name; });
+                t_args  tmp;
+                Typecheck_Code(req.ms, req.args ? *req.args : tmp, req.result_type, *req.expr);
+            }
+        }
+        catch(...)
+        {
+            job.error = ::std::current_exception();
+            auto cur = first_failed.load();
+            while( idx < cur && !first_failed.compare_exchange_weak(cur, idx) )
+                ;
+        }
+        if( debug_on || job.error )
+            job.debug_output = capture.str();
+        });
+
+    for(const auto& job : jobs.jobs)
+    {
+        if( debug_on || job.error )
+            ::std::cout << job.debug_output;
+        if( job.error )
+        {
+            ::std::cout << ::std::flush;
+            try {
+                ::std::rethrow_exception(job.error);
+            }
+            catch(const SpanFatalError& e) {
+                e.report();
+            }
+        }
+    }
 }
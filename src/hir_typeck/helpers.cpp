@@ -6,6 +6,12 @@
  * - Typecheck helpers
  */
 #include "helpers.hpp"
+#include <mutex>
+
+namespace {
+    /// Protects `TraitMarkings::auto_impls` (a cache on the crate, shared by parallel typecheck jobs)
+    ::std::mutex    g_auto_impls_lock;
+}
 
 // --------------------------------------------------------------------
 // HMTypeInferrence
@@ -160,7 +166,10 @@ void HMTypeInferrence::compact_ivars()
             auto index = v.alias;
             unsigned int count = 0;
             assert(index < m_ivars.size());
+            // Keep the latest update of the skipped ivars, so change tracking still sees it
+            auto changed_at = v.changed_at;
             while( m_ivars.at(index).is_alias() ) {
+                changed_at = ::std::max(changed_at, m_ivars.at(index).changed_at);
                 index = m_ivars.at(index).alias;
 
                 if( count >= m_ivars.size() ) {
@@ -170,6 +179,7 @@ void HMTypeInferrence::compact_ivars()
                 count ++;
             }
             v.alias = index;
+            v.changed_at = changed_at;
         }
         i ++;
     }
@@ -191,16 +201,19 @@ bool HMTypeInferrence::apply_defaults()
                     rv = true;
                     DEBUG("- IVar " << e->index << " = !");
                     *v.type = ::HIR::TypeRef::new_diverge();
+                    v.changed_at = ++ m_generation;
                     break;
                 case ::HIR::InferClass::Integer:
                     rv = true;
                     DEBUG("- IVar " << e->index << " = i32");
                     *v.type = ::HIR::TypeRef( ::HIR::CoreType::I32 );
+                    v.changed_at = ++ m_generation;
                     break;
                 case ::HIR::InferClass::Float:
                     rv = true;
                     DEBUG("- IVar " << e->index << " = f64");
                     *v.type = ::HIR::TypeRef( ::HIR::CoreType::F64 );
+                    v.changed_at = ++ m_generation;
                     break;
                 }
             }
@@ -593,6 +606,7 @@ void HMTypeInferrence::set_ivar_to(unsigned int slot, ::HIR::TypeRef type)
         auto& r_ivar = this->get_pointed_ivar(l_e->index);
         r_ivar.alias = slot;
         r_ivar.type.reset();
+        r_ivar.changed_at = root_ivar.changed_at = ++ m_generation;
         #else
         DEBUG("Set IVar " << slot << " = @" << l_e->index);
         root_ivar.alias = l_e->index;
@@ -647,6 +661,7 @@ void HMTypeInferrence::set_ivar_to(unsigned int slot, ::HIR::TypeRef type)
         else
         #endif
         root_ivar.type = box$( type );
+        root_ivar.changed_at = ++ m_generation;
     }
 
     this->mark_change();
@@ -708,6 +723,7 @@ void HMTypeInferrence::ivar_unify(unsigned int left_slot, unsigned int right_slo
         DEBUG("IVar " << root_ivar.type->data().as_Infer().index << " = @" << left_slot);
         root_ivar.alias = left_slot;
         root_ivar.type.reset();
+        root_ivar.changed_at = left_ivar.changed_at = ++ m_generation;
 
         this->mark_change();
     }
@@ -729,6 +745,42 @@ HMTypeInferrence::IVar& HMTypeInferrence::get_pointed_ivar(unsigned int slot) co
     return const_cast<IVar&>(m_ivars.at(index));
 }
 
+void HMTypeInferrence::touch_ivar(unsigned int slot)
+{
+    this->get_pointed_ivar(slot).changed_at = ++ m_generation;
+}
+bool HMTypeInferrence::type_changed_since(const ::HIR::TypeRef& ty, unsigned long gen) const
+{
+    return visit_ty_with(ty, [&](const ::HIR::TypeRef& t)->bool {
+        if( const auto* e = t.data().opt_Infer() )
+        {
+            if( e->index == ~0u )
+                return false;
+            const auto* ivar = &m_ivars.at(e->index);
+            for(;;)
+            {
+                if( ivar->changed_at > gen )
+                    return true;
+                if( !ivar->is_alias() )
+                    break;
+                ivar = &m_ivars.at(ivar->alias);
+            }
+            if( !ivar->type->data().is_Infer() )
+                return this->type_changed_since(*ivar->type, gen);
+        }
+        return false;
+        });
+}
+bool HMTypeInferrence::pathparams_changed_since(const ::HIR::PathParams& pps, unsigned long gen) const
+{
+    for(const auto& ty : pps.m_types)
+    {
+        if( this->type_changed_since(ty, gen) )
+            return true;
+    }
+    return false;
+}
+
 bool HMTypeInferrence::pathparams_contain_ivars(const ::HIR::PathParams& pps) const {
     for( const auto& ty : pps.m_types ) {
         if(this->type_contains_ivars(ty))
@@ -1603,12 +1655,19 @@ void TraitResolution::compact_ivars(HMTypeInferrence& m_ivars)
     for(auto& v : m_ivars.m_ivars)
     {
         if( !v.is_alias() ) {
+            // Expanding removes the inner ivars, so fold their change state into this ivar first
+            if( m_ivars.type_changed_since(*v.type, v.changed_at) ) {
+                v.changed_at = ++ m_ivars.m_generation;
+            }
             m_ivars.expand_ivars( *v.type );
             // Don't expand unless it is needed
             if( this->has_associated_type(*v.type) ) {
                 // TODO: cloning is expensive, BUT printing below is nice
                 auto nt = this->expand_associated_types(Span(), v.type->clone());
                 DEBUG("- " << i << " " << *v.type << " -> " << nt);
+                if( nt != *v.type ) {
+                    v.changed_at = ++ m_ivars.m_generation;
+                }
                 *v.type = mv$(nt);
             }
         }
@@ -1617,7 +1676,9 @@ void TraitResolution::compact_ivars(HMTypeInferrence& m_ivars)
             auto index = v.alias;
             unsigned int count = 0;
             assert(index < m_ivars.m_ivars.size());
+            auto changed_at = v.changed_at;
             while( m_ivars.m_ivars.at(index).is_alias() ) {
+                changed_at = ::std::max(changed_at, m_ivars.m_ivars.at(index).changed_at);
                 index = m_ivars.m_ivars.at(index).alias;
 
                 if( count >= m_ivars.m_ivars.size() ) {
@@ -1627,6 +1688,7 @@ void TraitResolution::compact_ivars(HMTypeInferrence& m_ivars)
                 count ++;
             }
             v.alias = index;
+            v.changed_at = changed_at;
         }
         i ++;
     }
@@ -2470,7 +2532,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
     if( m_crate.get_trait_by_path(sp, trait).m_is_marker )
     {
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        static thread_local ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait )
                 continue ;
@@ -2506,6 +2568,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         // - Cache populated after destructure
         if( markings )
         {
+            ::std::unique_lock<::std::mutex>  lh(g_auto_impls_lock);
             auto it = markings->auto_impls.find( trait );
             if( it != markings->auto_impls.end() )
             {
@@ -2513,6 +2576,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
                     TODO(sp, "Conditional auto trait impl");
                 }
                 else if( it->second.is_impled ) {
+                    lh.unlock();
                     return callback( ImplRef(&type, params_ptr, &null_assoc), ::HIR::Compare::Equal );
                 }
                 else {
@@ -2586,6 +2650,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         {
             if( markings ) {
                 ASSERT_BUG(sp, cmp == ::HIR::Compare::Equal, "Auto trait with no params returned a fuzzy match from destructure - " << trait << " for " << type);
+                ::std::lock_guard<::std::mutex>  lh(g_auto_impls_lock);
                 markings->auto_impls.insert( ::std::make_pair(trait, ::HIR::TraitMarkings::AutoMarking { {}, true }) );
             }
             return callback( ImplRef(&type, params_ptr, &null_assoc), cmp );
@@ -2593,6 +2658,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         else
         {
             if( markings ) {
+                ::std::lock_guard<::std::mutex>  lh(g_auto_impls_lock);
                 markings->auto_impls.insert( ::std::make_pair(trait, ::HIR::TraitMarkings::AutoMarking { {}, false }) );
             }
             return false;
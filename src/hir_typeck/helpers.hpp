@@ -60,20 +60,29 @@ public: // ?? - Needed once, anymore?
         //bool could_be_diverge;    // TODO: use this instead of InferClass::Diverge
         unsigned int alias; // If not ~0, this points to another ivar
         ::std::unique_ptr< ::HIR::TypeRef> type;    // Type (only nullptr if alias!=0)
+        /// Generation of the last update to this ivar (see `HMTypeInferrence::type_changed_since`)
+        unsigned long changed_at;
 
         IVar():
             alias(~0u),
-            type(new ::HIR::TypeRef())
+            type(new ::HIR::TypeRef()),
+            changed_at(0)
         {}
         bool is_alias() const { return alias != ~0u; }
     };
 
     ::std::vector< IVar>    m_ivars;
     bool    m_has_changed;
+    /// Incremented on every ivar update
+    unsigned long   m_generation;
+    /// Incremented on every `mark_change` call
+    unsigned long   m_change_count;
 
 public:
     HMTypeInferrence():
-        m_has_changed(false)
+        m_has_changed(false),
+        m_generation(0),
+        m_change_count(0)
     {}
 
     bool peek_changed() const {
@@ -85,6 +94,7 @@ public:
         return rv;
     }
     void mark_change() {
+        m_change_count ++;
         if( !m_has_changed ) {
             DEBUG("- CHANGE");
             m_has_changed = true;
@@ -94,6 +104,17 @@ public:
     void compact_ivars();
     bool apply_defaults();
 
+    /// Change tracking (used to avoid re-checking rules whose ivars haven't changed)
+    /// \{
+    unsigned long generation() const { return m_generation; }
+    unsigned long change_count() const { return m_change_count; }
+    /// Record that an ivar was updated outside of `set_ivar_to`/`ivar_unify`
+    void touch_ivar(unsigned int slot);
+    /// Returns true if any ivar reachable from the type (including via aliases and known types) was updated after `gen`
+    bool type_changed_since(const ::HIR::TypeRef& ty, unsigned long gen) const;
+    bool pathparams_changed_since(const ::HIR::PathParams& pps, unsigned long gen) const;
+    /// \}
+
     void dump() const;
 
     void print_type(::std::ostream& os, const ::HIR::TypeRef& tr) const;
@@ -12,5 +12,5 @@ namespace HIR {
 };
 
 extern void Typecheck_ModuleLevel(::HIR::Crate& crate);
-extern void Typecheck_Expressions(::HIR::Crate& crate);
+extern void Typecheck_Expressions(::HIR::Crate& crate, unsigned num_threads=1);
 extern void Typecheck_Expressions_Validate(::HIR::Crate& crate);
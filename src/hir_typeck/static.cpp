@@ -9,6 +9,41 @@
 #include <algorithm>
 #include <hir/expr.hpp>
 
+namespace {
+    DebugCounter    s_impl_cache_hits("StaticTraitResolve find_impl cache hits");
+    DebugCounter    s_impl_cache_misses("StaticTraitResolve find_impl cache misses");
+    DebugCounter    s_aty_cache_hits("StaticTraitResolve associated type cache hits");
+    DebugCounter    s_aty_cache_misses("StaticTraitResolve associated type cache misses");
+
+    /// Returns true if the type contains no generics or ivars (so queries on it don't depend on the current scope)
+    bool type_is_concrete(const ::HIR::TypeRef& ty)
+    {
+        return !visit_ty_with(ty, [](const ::HIR::TypeRef& t) { return t.data().is_Generic() || t.data().is_Infer(); });
+    }
+    /// Make a copy of an `ImplRef` that doesn't borrow from the query (for the impl cache)
+    ImplRef clone_impl_ref(const ImplRef& ir, const ::HIR::SimplePath& trait_path)
+    {
+        TU_MATCH_HDRA( (ir.m_data), {)
+        TU_ARMA(TraitImpl, e) {
+            return ImplRef(e.impl_params.clone(), trait_path, *e.impl);
+            }
+        TU_ARMA(BoundedPtr, e) {
+            ::std::map<RcString, ::HIR::TypeRef>    assoc;
+            for(const auto& a : *e.assoc)
+                assoc.insert(::std::make_pair(a.first, a.second.clone()));
+            return ImplRef(e.type->clone(), e.trait_args->clone(), mv$(assoc));
+            }
+        TU_ARMA(Bounded, e) {
+            ::std::map<RcString, ::HIR::TypeRef>    assoc;
+            for(const auto& a : e.assoc)
+                assoc.insert(::std::make_pair(a.first, a.second.clone()));
+            return ImplRef(e.type.clone(), e.trait_args.clone(), mv$(assoc));
+            }
+        }
+        throw "";
+    }
+}
+
 void StaticTraitResolve::prep_indexes()
 {
     static Span sp_AAA;
@@ -18,6 +53,21 @@ void StaticTraitResolve::prep_indexes()
 
     m_copy_cache.clear();
 
+    // The impl/associated type caches only hold concrete queries, which are only affected by concrete bounds
+    // (e.g. `where Foo<u8>: Bar`), so only flush when such a bound enters or leaves scope.
+    bool has_concrete_bounds = this->iterate_bounds([&](const auto& b)->bool {
+        if( const auto* be = b.opt_TraitBound() )
+            return type_is_concrete(be->type);
+        if( const auto* be = b.opt_TypeEquality() )
+            return type_is_concrete(be->type);
+        return false;
+        });
+    if( has_concrete_bounds || m_caches_have_scoped_entries ) {
+        m_impl_cache.clear();
+        m_aty_cache.clear();
+    }
+    m_caches_have_scoped_entries = has_concrete_bounds;
+
     auto add_equality = [&](::HIR::TypeRef long_ty, ::HIR::TypeRef short_ty){
         DEBUG("[prep_indexes] ADD " << long_ty << " => " << short_ty);
         // TODO: Sort the two types by "complexity" (most of the time long >= short)
@@ -102,6 +152,76 @@ bool StaticTraitResolve::find_impl(
     t_cb_find_impl found_cb,
     bool dont_handoff_to_specialised
     ) const
+{
+    // Only fully concrete queries are cached, as they don't depend on the bounds in scope
+    if( dont_handoff_to_specialised || !trait_params || !type_is_concrete(type)
+        || ::std::any_of(trait_params->m_types.begin(), trait_params->m_types.end(), [](const ::HIR::TypeRef& t){ return !type_is_concrete(t); })
+        )
+    {
+        return find_impl__inner(sp, trait_path, trait_params, type, found_cb, dont_handoff_to_specialised);
+    }
+
+    auto key = ::std::make_tuple(trait_path.clone(), trait_params->clone(), type.clone());
+    auto it = m_impl_cache.find(key);
+    if( it != m_impl_cache.end() )
+    {
+        s_impl_cache_hits.inc();
+        const auto& ent = it->second;
+        if( !ent.found )
+            return false;
+        if( found_cb(clone_impl_ref(ent.impl, ::std::get<0>(it->first)), ent.is_fuzzed) )
+            return true;
+        // The callback rejected the cached impl (which would have been the first one seen), so search for the rest
+        bool skip_first = true;
+        return find_impl__inner(sp, trait_path, trait_params, type, [&](ImplRef impl, bool is_fuzzed) {
+            if( skip_first ) {
+                skip_first = false;
+                return false;
+            }
+            return found_cb(mv$(impl), is_fuzzed);
+            }, false);
+    }
+    s_impl_cache_misses.inc();
+
+    // Record the result if the callback was only called once (and accepted that impl), or never called at all.
+    // - Other cases depend on the callback, so can't be cached.
+    unsigned num_seen = 0;
+    bool first_accepted = false;
+    ImplCacheEnt    ent { false, ImplRef(), false };
+    bool rv = find_impl__inner(sp, trait_path, trait_params, type, [&](ImplRef impl, bool is_fuzzed) {
+        num_seen ++;
+        if( num_seen == 1 ) {
+            ent.impl = clone_impl_ref(impl, trait_path);
+            ent.is_fuzzed = is_fuzzed;
+            first_accepted = found_cb(mv$(impl), is_fuzzed);
+            return first_accepted;
+        }
+        return found_cb(mv$(impl), is_fuzzed);
+        }, false);
+
+    if( num_seen == 0 && !rv )
+    {
+        m_impl_cache.insert(::std::make_pair( mv$(key), mv$(ent) ));
+    }
+    else if( num_seen == 1 && first_accepted && rv && !m_crate.get_trait_by_path(sp, trait_path).m_is_marker )
+    {
+        // NOTE: Auto traits are not cached, as a result can depend on an assumption made by the recursion check
+        ent.found = true;
+        auto ins = m_impl_cache.insert(::std::make_pair( mv$(key), mv$(ent) ));
+        // Re-point the trait path at the key (instead of the caller's copy)
+        auto& ir = ins.first->second.impl;
+        if( ir.m_data.is_TraitImpl() )
+            ir.m_data.as_TraitImpl().trait_path = &::std::get<0>(ins.first->first);
+    }
+    return rv;
+}
+bool StaticTraitResolve::find_impl__inner(
+    const Span& sp,
+    const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+    const ::HIR::TypeRef& type,
+    t_cb_find_impl found_cb,
+    bool dont_handoff_to_specialised
+    ) const
 {
     TRACE_FUNCTION_F(trait_path << FMT_CB(os, if(trait_params) { os << *trait_params; } else { os << "<?>"; }) << " for " << type);
     auto cb_ident = [](const ::HIR::TypeRef&ty)->const ::HIR::TypeRef& { return ty; };
@@ -444,7 +564,7 @@ bool StaticTraitResolve::find_impl(
             return rv;
 
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        static thread_local ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait_path )
                 continue ;
@@ -1046,6 +1166,21 @@ void StaticTraitResolve::expand_associated_types_inner(const Span& sp, ::HIR::Ty
             // - Only try resolving if the binding isn't known
             if( !e.binding.is_Unbound() )
                 return ;
+            if( type_is_concrete(input) )
+            {
+                auto it = m_aty_cache.find(input);
+                if( it != m_aty_cache.end() )
+                {
+                    s_aty_cache_hits.inc();
+                    input = it->second.clone();
+                    return;
+                }
+                s_aty_cache_misses.inc();
+                auto key = input.clone();
+                this->expand_associated_types__UfcsKnown(sp, input);
+                m_aty_cache.insert(::std::make_pair( mv$(key), input.clone() ));
+                return;
+            }
             this->expand_associated_types__UfcsKnown(sp, input);
             return;
             ),
@@ -10,6 +10,7 @@
 #include <hir/hir.hpp>
 #include "common.hpp"
 #include "impl_ref.hpp"
+#include <tuple>
 
 enum class MetadataType {
     Unknown,    // Unknown still
@@ -46,6 +47,21 @@ private:
     mutable ::std::map< ::HIR::TypeRef, bool >  m_clone_cache;
     mutable ::std::map< ::HIR::TypeRef, bool >  m_drop_cache;
 
+    /// Cached result of a fully-concrete `find_impl` query
+    struct ImplCacheEnt {
+        /// `false` if there's no impl
+        bool    found;
+        /// Owned copy of the impl (the first and only impl passed to the callback)
+        ImplRef impl;
+        bool    is_fuzzed;
+    };
+    typedef ::std::tuple< ::HIR::SimplePath, ::HIR::PathParams, ::HIR::TypeRef>  t_impl_cache_key;
+    mutable ::std::map< t_impl_cache_key, ImplCacheEnt >   m_impl_cache;
+    /// Fully-concrete associated types, and their expansion
+    mutable ::std::map< ::HIR::TypeRef, ::HIR::TypeRef >  m_aty_cache;
+    /// Set if the above caches were populated while a concrete bound was in scope
+    bool    m_caches_have_scoped_entries = false;
+
 public:
     StaticTraitResolve(const ::HIR::Crate& crate):
         m_crate(crate),
@@ -140,6 +156,13 @@ public:
         ) const;
 
 private:
+    bool find_impl__inner(
+        const Span& sp,
+        const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+        const ::HIR::TypeRef& type,
+        t_cb_find_impl found_cb,
+        bool dont_handoff_to_specialised
+        ) const;
     bool find_impl__check_bound(
         const Span& sp,
         const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
@@ -28,6 +28,29 @@ bool Ident::Hygiene::is_visible(const Hygiene& src) const
     return false;
 }
 
+bool Ident::Hygiene::operator==(const Hygiene& x) const
+{
+    if( this->contexts != x.contexts )
+        return false;
+    if( this->search_module == x.search_module )
+        return true;
+    if( !this->search_module || !x.search_module )
+        return false;
+    return this->search_module->ents == x.search_module->ents;
+}
+size_t Ident::Hygiene::hash() const
+{
+    size_t  rv = this->contexts.size();
+    for(auto c : this->contexts)
+        rv = rv * 31 + c;
+    if( this->search_module )
+    {
+        for(const auto& e : this->search_module->ents)
+            rv = rv * 31 + e.hash();
+    }
+    return rv;
+}
+
 ::std::ostream& operator<<(::std::ostream& os, const Ident& x) {
     os << x.name << x.hygiene;
     return os;
@@ -11,8 +11,10 @@
 #include <sstream>
 #include <cassert>
 #include <functional>
+#include <atomic>
+#include <vector>
 
-extern int g_debug_indent_level;
+extern thread_local int g_debug_indent_level;
 
 #ifndef DEBUG_EXTRA_ENABLE
 # define DEBUG_EXTRA_ENABLE  // Files can override this with their own flag if needed (e.g. `&& g_my_debug_on`)
@@ -37,6 +39,8 @@ extern int g_debug_indent_level;
 
 extern bool debug_enabled();
 extern ::std::ostream& debug_output(int indent, const char* function);
+/// Raw debug stream (stdout, or the current thread's capture buffer)
+extern ::std::ostream& debug_stream();
 
 struct RepeatLitStr
 {
@@ -85,4 +89,20 @@ struct FmtLambda
 #define FMT_CB(os, ...)  ::FmtLambda( [&](auto& os) { __VA_ARGS__; } )
 #define FMT_CB_S(...)  ::FmtLambda( [&](auto& _os) { _os << __VA_ARGS__; } )
 
+/// Statistics counter, reported (and reset) at the end of each `DebugTimedPhase` if non-zero
+/// - Must have static storage duration
+class DebugCounter
+{
+    const char* m_name;
+    ::std::atomic<unsigned long>    m_value;
+    DebugCounter*   m_next;
+public:
+    DebugCounter(const char* name);
+    DebugCounter(const DebugCounter&) = delete;
 
+    void inc() { m_value.fetch_add(1, ::std::memory_order_relaxed); }
+    void add(unsigned long v) { m_value.fetch_add(v, ::std::memory_order_relaxed); }
+
+    /// Print (and reset) all non-zero counters, optionally also collecting them into `out`
+    static void report_and_reset(::std::ostream& os, ::std::vector< ::std::pair<const char*, unsigned long> >* out=nullptr);
+};
@@ -2,15 +2,55 @@
  */
 #pragma once
 #include <ctime>
+#include <chrono>
+#include <functional>
 #include <initializer_list>
+#include <sstream>
 
 extern void debug_init_phases(const char* env_var_name, std::initializer_list<const char*> il);
 
+/// Record a profile of each phase (times, memory, allocations, counters, and the slowest items), and write it to `path`
+/// as JSON when the program exits (`--timings-json`)
+extern void debug_enable_timings_json(const ::std::string& path);
+extern bool debug_timings_enabled();
+
+struct DebugPhaseRecord;
 class DebugTimedPhase
 {
     const char* m_name;
     clock_t m_start;
+    ::std::chrono::steady_clock::time_point m_wall_start;
+    unsigned long   m_allocations_start;
+    // Profile record for this phase, and the one for the enclosing phase (only if timings are enabled)
+    DebugPhaseRecord*   m_record;
+    DebugPhaseRecord*   m_parent_record;
 public:
     DebugTimedPhase(const char* name);
     ~DebugTimedPhase();
 };
+
+/// Times a single item (e.g. one function body) within the current phase, for the hot spot list of `--timings-json`
+/// - `name_cb` is only called if the item is one of the slowest in the phase so far
+class DebugTimedItem
+{
+    ::std::function<void(::std::ostream&)>  m_name_cb;
+    ::std::chrono::steady_clock::time_point m_start;
+public:
+    DebugTimedItem(::std::function<void(::std::ostream&)> name_cb);
+    DebugTimedItem(const DebugTimedItem&) = delete;
+    ~DebugTimedItem();
+};
+
+/// Redirects debug output from the current thread into a buffer (used by worker threads, so output can be emitted in a deterministic order)
+class DebugCapture
+{
+    ::std::ostream* m_saved;
+    int m_saved_indent;
+    ::std::stringstream m_buffer;
+public:
+    DebugCapture();
+    DebugCapture(const DebugCapture&) = delete;
+    ~DebugCapture();
+
+    ::std::string str() const { return m_buffer.str(); }
+};
@@ -70,8 +70,10 @@ struct Ident
 
         // Returns true if an ident with hygine `source` can see an ident with this hygine
         bool is_visible(const Hygiene& source) const;
-        //bool operator==(const Hygiene& x) const { return scope_index == x.scope_index; }
-        //bool operator!=(const Hygiene& x) const { return scope_index != x.scope_index; }
+        // Exact equality (same scope chain and search module), used to key caches
+        bool operator==(const Hygiene& x) const;
+        bool operator!=(const Hygiene& x) const { return !(*this == x); }
+        size_t hash() const;
 
         friend ::std::ostream& operator<<(::std::ostream& os, const Hygiene& v);
     };
@@ -20,9 +20,13 @@ namespace AST {
 extern AST::Crate Parse_Crate(::std::string mainfile, AST::Edition edition);
 
 extern void Expand_Init();
+/// Opt-in: replay the recorded output of `macro_rules!` invocations with identical input (and hygiene)
+extern void Macro_EnableExpansionCache();
 extern void Expand(::AST::Crate& crate);
 extern void Expand_TestHarness(::AST::Crate& crate);
 extern void Expand_ProcMacro(::AST::Crate& crate);
+/// Shut down the proc macro servers started during expansion, reporting the time spent in each macro crate
+extern void ProcMacro_StopServers();
 
 /// Dump the crate AST as annotated rust
 extern void Dump_Rust(const char *Filename, const AST::Crate& crate);
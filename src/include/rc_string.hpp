@@ -9,11 +9,22 @@
 
 #include <cstring>
 #include <ostream>
+#include <atomic>
 #include "../common.hpp"
 
 class RcString
 {
-    unsigned int*   m_ptr;
+    // NOTE: The refcount is atomic so strings can be shared between worker threads (see `-j`)
+    struct Inner {
+        ::std::atomic<unsigned> refcount;
+        unsigned    size;
+        // Set only on strings owned by the intern table (so two interned strings are equal iff they're the same pointer)
+        bool    is_interned;
+        // Precomputed hash (only valid if `is_interned`)
+        size_t  hash;
+        char    data[1];
+    };
+    Inner*  m_ptr;
 public:
     RcString():
         m_ptr(nullptr)
@@ -28,13 +39,18 @@ public:
     {
     }
 
-    static RcString new_interned(const ::std::string& s);
-    static RcString new_interned(const char* s);
+    static RcString new_interned(const char* s, size_t len);
+    static RcString new_interned(const ::std::string& s) {
+        return new_interned(s.data(), s.size());
+    }
+    static RcString new_interned(const char* s) {
+        return new_interned(s, ::std::strlen(s));
+    }
 
     RcString(const RcString& x):
         m_ptr(x.m_ptr)
     {
-        if( m_ptr ) *m_ptr += 1;
+        if( m_ptr ) m_ptr->refcount += 1;
     }
     RcString(RcString&& x):
         m_ptr(x.m_ptr)
@@ -50,7 +66,7 @@ public:
         {
             this->~RcString();
             m_ptr = x.m_ptr;
-            if( m_ptr ) *m_ptr += 1;
+            if( m_ptr ) m_ptr->refcount += 1;
         }
         return *this;
     }
@@ -68,11 +84,11 @@ public:
     const char* begin() const { return c_str(); }
     const char* end() const { return c_str() + size(); }
 
-    size_t size() const { return m_ptr ? m_ptr[1] : 0; }
+    size_t size() const { return m_ptr ? m_ptr->size : 0; }
     const char* c_str() const {
         if( m_ptr )
         {
-            return reinterpret_cast<const char*>(m_ptr + 2);
+            return m_ptr->data;
         }
         else
         {
@@ -80,6 +96,9 @@ public:
         }
     }
 
+    bool is_interned() const { return m_ptr && m_ptr->is_interned; }
+    size_t hash() const;
+
     char back() const {
         assert(size() > 0 );
         return *(c_str() + size() - 1);
@@ -92,14 +111,16 @@ public:
         return ord(s.c_str(), s.size());
     }
     bool operator==(const RcString& s) const {
+        if( m_ptr == s.m_ptr )
+            return true;
+        if( this->is_interned() && s.is_interned() )
+            return false;
         if(s.size() != this->size())
             return false;
-        return this->ord(s) == OrdEqual;
+        return memcmp(this->c_str(), s.c_str(), this->size()) == 0;
     }
     bool operator!=(const RcString& s) const {
-        if(s.size() != this->size())
-            return true;
-        return this->ord(s) != OrdEqual;
+        return !(*this == s);
     }
     bool operator<(const RcString& s) const { return this->ord(s) == OrdLess; }
     bool operator>(const RcString& s) const { return this->ord(s) == OrdGreater; }
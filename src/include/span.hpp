@@ -10,6 +10,7 @@
 #include <rc_string.hpp>
 #include <functional>
 #include <memory>
+#include <string>
 
 enum ErrorType
 {
@@ -76,6 +77,26 @@ public:
 
     friend ::std::ostream& operator<<(::std::ostream& os, const Span& sp);
 };
+
+/// A fatal error (`Span::bug`/`Span::error`) raised while `DeferFatalSpanErrors` is active
+/// - Not a `std::exception`, so it isn't swallowed by handlers for recoverable errors
+struct SpanFatalError
+{
+    ::std::string   message;    // The formatted message (including the notes for parent spans)
+
+    /// Print the message and exit (as `Span::bug`/`Span::error` would have)
+    [[noreturn]] void report() const;
+};
+/// While alive, fatal span errors on the current thread throw `SpanFatalError` instead of exiting (used by worker
+/// threads, so the error can be reported once all workers have finished)
+class DeferFatalSpanErrors
+{
+    bool    m_saved;
+public:
+    DeferFatalSpanErrors();
+    DeferFatalSpanErrors(const DeferFatalSpanErrors&) = delete;
+    ~DeferFatalSpanErrors();
+};
 struct SpanInner
 {
     friend struct Span;
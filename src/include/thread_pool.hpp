@@ -0,0 +1,55 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/thread_pool.hpp
+ * - Minimal worker pool for running independent jobs in parallel
+ */
+#pragma once
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <jobserver.h>  // tools/common/jobserver.h
+
+/// Call `fcn(idx)` for every `idx` in `0 .. count`, using up to `num_threads` threads
+///
+/// Jobs are claimed in index order (so a job can safely wait on the completion of a lower-indexed job).
+/// If `num_threads` is less than two, all jobs are run on the calling thread.
+/// When running under a jobserver, each thread only claims jobs once it holds a job token.
+template<typename Fcn>
+void parallel_for_each_index(unsigned num_threads, size_t count, Fcn fcn)
+{
+    if( num_threads <= 1 || count <= 1 )
+    {
+        for(size_t i = 0; i < count; i ++)
+            fcn(i);
+        return ;
+    }
+
+    ::std::atomic<size_t>   next_idx { 0 };
+    auto worker = [&]() {
+        // Give up waiting for a token once every job has been claimed by other threads
+        while( !Jobserver_TryAcquire(50) )
+        {
+            if( next_idx >= count )
+                return ;
+        }
+        for(;;)
+        {
+            size_t idx = next_idx ++;
+            if( idx >= count )
+                break;
+            fcn(idx);
+        }
+        Jobserver_Release();
+    };
+
+    ::std::vector< ::std::thread>   threads;
+    threads.reserve(num_threads - 1);
+    for(unsigned i = 1; i < num_threads; i ++)
+        threads.push_back( ::std::thread(worker) );
+    worker();
+    for(auto& t : threads)
+        t.join();
+}
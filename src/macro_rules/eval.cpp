@@ -15,6 +15,7 @@
 #include <parse/interpolated_fragment.hpp>
 #include <ast/expr.hpp>
 #include <ast/crate.hpp>
+#include <unordered_map>
 
 class ParameterMappings
 {
@@ -404,7 +405,7 @@ private:
 class MacroExpander:
     public TokenStream
 {
-    const RcString  m_macro_filename;
+    const uint32_t  m_macro_file_idx;  // Source map index of "Macro:<name>"
 
     const RcString  m_crate_name;
     Span m_invocation_span;
@@ -422,7 +423,7 @@ public:
 
     MacroExpander(const ::std::string& macro_name, const Span& sp, AST::Edition edition, const Ident::Hygiene& parent_hygiene, const ::std::vector<MacroExpansionEnt>& contents, ParameterMappings mappings, RcString crate_name):
         TokenStream(ParseState(AST::Edition::Rust2015)),    // TODO: Get from the source crate
-        m_macro_filename( FMT("Macro:" << macro_name) ),
+        m_macro_file_idx( Position::intern_filename(RcString(FMT("Macro:" << macro_name))) ),
         m_crate_name( mv$(crate_name) ),
         m_invocation_span( sp ),
         m_invocation_edition( edition ),
@@ -436,7 +437,148 @@ public:
     Span outerSpan() const override { return m_invocation_span; }
     Ident::Hygiene realGetHygiene() const override;
     Token realGetToken() override;
+
+    /// Hygiene given to tokens that come from the macro body (instead of from captured fragments)
+    const Ident::Hygiene& expansion_hygiene() const { return m_hygiene; }
 };
+// ----------------------------------------------------------------
+/// Recorded output of a `macro_rules!` invocation (see `Macro_InvokeRules`)
+struct CachedExpansion
+{
+    struct Ent
+    {
+        Token   tok;
+        /// Set if this token came from the macro body, and thus needs the fresh per-expansion hygiene when replayed
+        bool    is_local;
+        Ident::Hygiene  hygiene;
+
+        Ent(Token tok, bool is_local, Ident::Hygiene hygiene):
+            tok(mv$(tok)),
+            is_local(is_local),
+            hygiene(mv$(hygiene))
+        {
+        }
+        // NOTE: Not copyable, so `std::vector` moves (instead of copying fragments) on resize
+        Ent(const Ent&) = delete;
+        Ent(Ent&&) = default;
+    };
+
+    // Key
+    uint64_t    rules_uid;
+    ::std::string   name;
+    TokenTree   input;
+
+    ::std::vector<Ent>  tokens;
+};
+/// Token stream that replays a cached expansion
+class MacroExpansionReplay:
+    public TokenStream
+{
+    const uint32_t  m_macro_file_idx;  // Source map index of "Macro:<name>"
+    Span    m_invocation_span;
+    ::std::shared_ptr<const CachedExpansion>   m_expansion;
+    Ident::Hygiene  m_local_hygiene;
+    size_t  m_next_idx;
+
+public:
+    MacroExpansionReplay(const Span& sp, ::std::shared_ptr<const CachedExpansion> expansion, Ident::Hygiene local_hygiene):
+        TokenStream(ParseState(AST::Edition::Rust2015)),    // Matches `MacroExpander`
+        m_macro_file_idx( Position::intern_filename(RcString(FMT("Macro:" << expansion->name))) ),
+        m_invocation_span( sp ),
+        m_expansion( mv$(expansion) ),
+        m_local_hygiene( mv$(local_hygiene) ),
+        m_next_idx(0)
+    {
+    }
+
+    Position getPosition() const override {
+        if( m_next_idx == 0 || m_next_idx > m_expansion->tokens.size() )
+            return Position(m_macro_file_idx, 0, 0);
+        return m_expansion->tokens[m_next_idx-1].tok.get_pos();
+    }
+    Span outerSpan() const override { return m_invocation_span; }
+    Ident::Hygiene realGetHygiene() const override {
+        if( m_next_idx == 0 || m_next_idx > m_expansion->tokens.size() )
+            return m_local_hygiene;
+        const auto& ent = m_expansion->tokens[m_next_idx-1];
+        return ent.is_local ? m_local_hygiene : ent.hygiene;
+    }
+    Token realGetToken() override {
+        if( m_next_idx >= m_expansion->tokens.size() ) {
+            m_next_idx = m_expansion->tokens.size() + 1;
+            return Token(TOK_EOF);
+        }
+        return m_expansion->tokens[m_next_idx++].tok.clone();
+    }
+};
+
+namespace {
+    bool    s_expansion_cache_enabled = false;
+    /// Cached expansions, keyed on a hash of the macro identity and input (entries are compared in full on lookup)
+    ::std::unordered_map<size_t, ::std::vector< ::std::shared_ptr<const CachedExpansion> > >   s_expansion_cache;
+    /// Limit on the total number of tokens held by the cache (new expansions are not recorded once reached)
+    const size_t    EXPANSION_CACHE_MAX_TOKENS = 4*1024*1024;
+    size_t  s_expansion_cache_tokens = 0;
+
+    DebugCounter    s_expansion_cache_hits("macro_rules expansion cache hits");
+    DebugCounter    s_expansion_cache_misses("macro_rules expansion cache misses");
+    DebugCounter    s_expansion_cache_bypassed("macro_rules expansion cache bypassed (interpolated input/output)");
+    DebugCounter    s_expansion_cache_full("macro_rules expansion cache full (not recorded)");
+
+    bool is_interpolated_for_cache(const Token& tok)
+    {
+        return TOK_INTERPOLATED_IDENT <= tok.type() && tok.type() <= TOK_INTERPOLATED_VIS;
+    }
+
+    /// Hash a TokenTree for the expansion cache, returns false if it contains fragments (which can't be compared)
+    bool hash_tt_for_cache(const TokenTree& tt, size_t& h)
+    {
+        h = h * 31 + tt.hygiene().hash();
+        if( tt.is_token() )
+        {
+            const auto& tok = tt.tok();
+            if( is_interpolated_for_cache(tok) )
+                return false;
+            h = h * 31 + tok.type();
+            // NOTE: Only idents/lifetimes contribute their value, everything else is checked by the full comparison
+            if( tok.type() == TOK_IDENT || tok.type() == TOK_LIFETIME )
+                h = h * 31 + tok.istr().hash();
+        }
+        else
+        {
+            h = h * 31 + tt.size();
+            for(size_t i = 0; i < tt.size(); i ++)
+            {
+                if( !hash_tt_for_cache(tt[i], h) )
+                    return false;
+            }
+        }
+        return true;
+    }
+    /// Structural equality of two (fragment-free) TokenTrees, including hygiene but ignoring source positions
+    bool tt_equal_for_cache(const TokenTree& a, const TokenTree& b)
+    {
+        if( a.hygiene() != b.hygiene() )
+            return false;
+        if( a.is_token() != b.is_token() )
+            return false;
+        if( a.is_token() )
+            return a.tok() == b.tok();
+        if( a.size() != b.size() )
+            return false;
+        for(size_t i = 0; i < a.size(); i ++)
+        {
+            if( !tt_equal_for_cache(a[i], b[i]) )
+                return false;
+        }
+        return true;
+    }
+}
+
+void Macro_EnableExpansionCache()
+{
+    s_expansion_cache_enabled = true;
+}
 
 void Macro_InitDefaults()
 {
@@ -523,6 +665,32 @@ InterpolatedFragment Macro_HandlePatternCap(TokenStream& lex, MacroPatEnt::Type
     TRACE_FUNCTION_F("'" << name << "', " << input);
     DEBUG("rules.m_hygiene = " << rules.m_hygiene);
 
+    // Look for a previous expansion of the same macro with identical input (tokens and hygiene)
+    size_t  cache_hash = ::std::hash<uint64_t>()(rules.m_uid);
+    bool    use_cache = s_expansion_cache_enabled && hash_tt_for_cache(input, cache_hash);
+    if( s_expansion_cache_enabled && !use_cache ) {
+        s_expansion_cache_bypassed.inc();
+    }
+    ::std::shared_ptr<CachedExpansion>  new_ent;
+    if( use_cache )
+    {
+        for(const auto& ent : s_expansion_cache[cache_hash])
+        {
+            if( ent->rules_uid == rules.m_uid && ent->name == name && tt_equal_for_cache(ent->input, input) )
+            {
+                DEBUG("Cached expansion (" << ent->tokens.size() << " tokens)");
+                s_expansion_cache_hits.inc();
+                // Tokens from the macro body get a fresh scope, exactly as `MacroExpander` would have given them
+                return ::std::unique_ptr<TokenStream>(new MacroExpansionReplay(sp, ent, Ident::Hygiene::new_scope_chained(rules.m_hygiene)));
+            }
+        }
+        s_expansion_cache_misses.inc();
+        new_ent = ::std::make_shared<CachedExpansion>();
+        new_ent->rules_uid = rules.m_uid;
+        new_ent->name = name;
+        new_ent->input = input.clone();
+    }
+
     ParameterMappings   bound_tts;
     unsigned int    rule_index = Macro_InvokeRules_MatchPattern(sp, rules, mv$(input), crate, mod,  bound_tts);
 
@@ -540,6 +708,39 @@ InterpolatedFragment Macro_HandlePatternCap(TokenStream& lex, MacroPatEnt::Type
 
     TokenStream* ret_ptr = new MacroExpander(name, sp, crate.m_edition, rules.m_hygiene, rule.m_contents, mv$(bound_tts), rules.m_source_crate);
 
+    if( new_ent )
+    {
+        // Run the expansion to completion, recording each token along with its hygiene, then replay the recording
+        auto& expander = *static_cast<MacroExpander*>(ret_ptr);
+        ::std::unique_ptr<TokenStream>  expander_ptr(ret_ptr);
+        bool    has_fragments = false;
+        for(;;)
+        {
+            auto tok = expander.getToken();
+            if( tok.type() == TOK_EOF )
+                break;
+            auto h = expander.getHygiene();
+            bool is_local = (h == expander.expansion_hygiene());
+            has_fragments |= is_interpolated_for_cache(tok);
+            new_ent->tokens.push_back(CachedExpansion::Ent(mv$(tok), is_local, mv$(h)));
+        }
+        DEBUG("Recorded expansion (" << new_ent->tokens.size() << " tokens)");
+        auto local_hygiene = expander.expansion_hygiene();
+        // Fragments (e.g. `$e:expr` captures) hold parsed AST that refers to the invoking module (e.g. anonymous
+        // modules for blocks), so can't be shared with other invocations - only use this recording once.
+        if( has_fragments ) {
+            s_expansion_cache_bypassed.inc();
+        }
+        else if( s_expansion_cache_tokens + new_ent->tokens.size() > EXPANSION_CACHE_MAX_TOKENS ) {
+            s_expansion_cache_full.inc();
+        }
+        else {
+            s_expansion_cache_tokens += new_ent->tokens.size();
+            s_expansion_cache[cache_hash].push_back(new_ent);
+        }
+        ret_ptr = new MacroExpansionReplay(sp, mv$(new_ent), mv$(local_hygiene));
+    }
+
     return ::std::unique_ptr<TokenStream>( ret_ptr );
 }
 
@@ -1790,8 +1991,8 @@ unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& ru
 
     ::std::vector< ::std::pair<size_t, ::std::vector<bool>> >    matches;
     ::std::vector< std::pair<size_t, eTokenType> >  fail_pos;
-    for(size_t i = 0; i < rules.m_rules.size(); i ++)
-    {
+    // Attempt to match the input against arm `i`, returns true if it matched
+    auto try_arm = [&](size_t i)->bool {
         auto lex = TokenStreamRO(input);
         auto arm_stream = MacroPatternStream(rules.m_rules[i].m_pattern);
 
@@ -1866,12 +2067,30 @@ unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& ru
         {
             matches.push_back( ::std::make_pair(i, arm_stream.take_history()) );
             DEBUG(i << " MATCHED");
+            return true;
         }
         else
         {
             DEBUG(i << " FAILED");
             fail_pos.push_back( std::make_pair(lex.position(), lex.next()) );
+            return false;
         }
+        };
+
+    // Only the first matching arm is used, so only try arms that can accept the first token, and stop at the first match.
+    const auto candidates = rules.get_candidate_arms( TokenStreamRO(input).next() );
+    DEBUG(candidates.size() << " candidate arms");
+    for(auto i : candidates)
+    {
+        if( try_arm(i) )
+            break;
+    }
+    if( matches.size() == 0 && candidates.size() != rules.m_rules.size() )
+    {
+        // Re-run against every arm, so the error lists where each arm failed
+        fail_pos.clear();
+        for(size_t i = 0; i < rules.m_rules.size(); i ++)
+            try_arm(i);
     }
 
     if( matches.size() == 0 )
@@ -1969,7 +2188,7 @@ void Macro_InvokeRules_CountSubstUses(ParameterMappings& bound_tts, const ::std:
 Position MacroExpander::getPosition() const
 {
     // TODO: Return the attached position of the last fetched token
-    return Position(m_macro_filename, 0, m_state.top_pos());
+    return Position(m_macro_file_idx, 0, m_state.top_pos());
 }
 Ident::Hygiene MacroExpander::realGetHygiene() const
 {
@@ -172,11 +172,29 @@ public:
     /// Expansion rules
     ::std::vector<MacroRulesArm>  m_rules;
 
-    MacroRules()
+    /// Arms that start by expecting a specific token type (indexed by that type)
+    ::std::map<eTokenType, ::std::vector<unsigned>>  m_first_token_arms;
+    /// Arms that can start with any token
+    ::std::vector<unsigned> m_any_first_token_arms;
+    /// Set by `build_first_token_index` (if not set, every arm is a candidate)
+    bool    m_first_token_index_valid = false;
+
+    /// Unique identifier for this macro (used as a cache key, as addresses can be reused once a macro is freed)
+    uint64_t    m_uid;
+
+    MacroRules():
+        m_uid( alloc_uid() )
     {
     }
     virtual ~MacroRules();
     MacroRules(MacroRules&&) = default;
+
+    /// Populate the first token dispatch index (must be called after `m_rules` is updated)
+    void build_first_token_index();
+    /// Get the indexes of arms that could match input starting with the given token type (in arm order)
+    ::std::vector<unsigned> get_candidate_arms(eTokenType first_tok) const;
+private:
+    static uint64_t alloc_uid();
 };
 
 extern ::std::unique_ptr<TokenStream>   Macro_InvokeRules(const char *name, const MacroRules& rules, const Span& sp, TokenTree input, const AST::Crate& crate, AST::Module& mod);
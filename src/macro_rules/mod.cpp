@@ -11,6 +11,7 @@
 #include <parse/tokentree.hpp>
 #include <parse/common.hpp>
 #include <limits.h>
+#include <algorithm>    // std::merge
 
 #include "pattern_checks.hpp"
 
@@ -291,6 +292,46 @@ MacroRulesPtr::~MacroRulesPtr()
 MacroRules::~MacroRules()
 {
 }
+uint64_t MacroRules::alloc_uid()
+{
+    static uint64_t s_next_uid = 1;
+    return s_next_uid ++;
+}
+void MacroRules::build_first_token_index()
+{
+    m_first_token_arms.clear();
+    m_any_first_token_arms.clear();
+    for(unsigned i = 0; i < m_rules.size(); i ++)
+    {
+        const auto& pat = m_rules[i].m_pattern;
+        // An arm that starts with `ExpectTok` can only match if the first input token is equal (which requires the same type)
+        // - Anything else (a fragment, a loop, or an empty pattern) is checked against all inputs
+        if( !pat.empty() && pat.front().is_ExpectTok() ) {
+            m_first_token_arms[pat.front().as_ExpectTok().type()].push_back(i);
+        }
+        else {
+            m_any_first_token_arms.push_back(i);
+        }
+    }
+    m_first_token_index_valid = true;
+}
+::std::vector<unsigned> MacroRules::get_candidate_arms(eTokenType first_tok) const
+{
+    ::std::vector<unsigned> rv;
+    if( !m_first_token_index_valid )
+    {
+        for(unsigned i = 0; i < m_rules.size(); i ++)
+            rv.push_back(i);
+        return rv;
+    }
+    auto it = m_first_token_arms.find(first_tok);
+    if( it == m_first_token_arms.end() )
+        return m_any_first_token_arms;
+    // Merge the two sorted lists, so arms are still tried in definition order
+    rv.resize(it->second.size() + m_any_first_token_arms.size());
+    ::std::merge(it->second.begin(), it->second.end(), m_any_first_token_arms.begin(), m_any_first_token_arms.end(), rv.begin());
+    return rv;
+}
 MacroRulesArm::~MacroRulesArm()
 {
 }
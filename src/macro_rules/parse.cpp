@@ -381,6 +381,7 @@ MacroRulesPtr Parse_MacroRules(TokenStream& lex)
     {
         rv->m_rules.push_back( Parse_MacroRules_MakeArm(rule.m_pat_span, mv$(rule.m_pattern), mv$(rule.m_contents)) );
     }
+    rv->build_first_token_index();
 
     return rv;
 }
@@ -29,6 +29,7 @@
 
 #include "expand/cfg.hpp"
 #include <target_detect.h>	// tools/common/target_detect.h
+#include <jobserver.h>	// tools/common/jobserver.h
 #include <debug_inner.hpp>
 
 #ifdef _WIN32
@@ -57,6 +58,8 @@ struct ProgramParams
     ::std::string   target = DEFAULT_TARGET_NAME;
 
     ::std::string   emit_depfile;
+    // File created once the crate's metadata (`.hir`) is written (used by pipelined builds)
+    ::std::string   emit_metadata_marker;
 
     AST::Edition      edition = AST::Edition::Rust2015;
     ::AST::Crate::Type  crate_type = ::AST::Crate::Type::Unknown;
@@ -66,12 +69,19 @@ struct ProgramParams
     unsigned opt_level = 0;
     bool emit_debug_info = false;
 
+    // Number of worker threads to use for parallelisable passes
+    unsigned num_threads = 1;
+
     bool test_harness = false;
 
     // NOTE: If populated, nothing happens except for loading the target
     ::std::string   target_saveback;
     // NOTE: if true, no parse/compilation performed (target is loaded though)
     bool    print_cfgs = false;
+    bool    print_c_compiler = false;
+
+    // If non-empty, a per-phase profile is written here (as JSON)
+    ::std::string   timings_json_path;
 
     ::std::vector<const char*> lib_search_dirs;
     ::std::vector<const char*> libraries;
@@ -87,10 +97,19 @@ struct ProgramParams
         bool dump_ast = false;
         bool dump_hir = false;
         bool dump_mir = false;
+
+        // Reuse `macro_rules!` expansions when the macro is invoked again with identical input
+        bool macro_expansion_cache = false;
+        // Record/use monomorphisations emitted by library crates instead of re-generating them downstream
+        bool share_generics = false;
+        // Hash-cons fully resolved types created during monomorphisation
+        bool intern_types = false;
     } debug;
     struct {
         ::std::string   codegen_type;
         ::std::string   emit_build_command;
+        unsigned int    codegen_units = 1;
+        HirCompression  hir_compression;
     } codegen;
 
     ProgramParams(int argc, char *argv[]);
@@ -228,6 +247,12 @@ int main(int argc, char *argv[])
 {
     init_debug_list();
     ProgramParams   params(argc, argv);
+    if( params.timings_json_path != "" )
+    {
+        debug_enable_timings_json(params.timings_json_path);
+    }
+    // Share the job limit of the calling make/minicargo (limits worker threads and C compiler invocations)
+    Jobserver_InitClient();
 
     // Set up cfg values
     CompilePhaseV("Setup", [&]() {
@@ -253,6 +278,11 @@ int main(int argc, char *argv[])
         Cfg_Dump(std::cout);
         return 0;
     }
+    if( params.print_c_compiler )
+    {
+        ::std::cout << "c-compiler=" << Trans_GetCCompiler() << ::std::endl;
+        return 0;
+    }
     if( params.target_saveback != "" )
     {
         Target_ExportCurSpec(params.target_saveback);
@@ -271,6 +301,14 @@ int main(int argc, char *argv[])
     }
 
     Expand_Init();
+    if( params.debug.macro_expansion_cache )
+    {
+        Macro_EnableExpansionCache();
+    }
+    if( params.debug.intern_types )
+    {
+        ::HIR::TypeRef::enable_interning();
+    }
 
     try
     {
@@ -305,6 +343,7 @@ int main(int argc, char *argv[])
         // Iterate all items in the AST, applying syntax extensions
         CompilePhaseV("Expand", [&]() {
             Expand(crate);
+            ProcMacro_StopServers();
             });
 
         if( params.test_harness )
@@ -486,9 +525,10 @@ int main(int argc, char *argv[])
 
             of << params.outfile << ":";
             // - Iterate all loaded crates files
+            // - Only the metadata is read, so depend on that (the library itself may still be being generated by a pipelined build)
             for(const auto& ec : crate.m_extern_crates)
             {
-                of << " " << ec.second.m_filename;
+                of << " " << ec.second.m_filename << ".hir";
             }
             // - Iterate all extra files (include! and friends)
         }
@@ -590,7 +630,7 @@ int main(int argc, char *argv[])
             });
         // Check the rest of the expressions (including function bodies)
         CompilePhaseV("Typecheck Expressions", [&]() {
-            Typecheck_Expressions(*hir_crate);
+            Typecheck_Expressions(*hir_crate, params.num_threads);
             });
         // === HIR Expansion ===
         // Annotate how each node's result is used
@@ -670,7 +710,7 @@ int main(int argc, char *argv[])
 
         // Optimise the MIR
         CompilePhaseV("MIR Optimise", [&]() {
-            MIR_OptimiseCrate(*hir_crate, params.debug.disable_mir_optimisations);
+            MIR_OptimiseCrate(*hir_crate, params.debug.disable_mir_optimisations, params.num_threads);
             });
 
         if( params.debug.dump_mir )
@@ -703,6 +743,7 @@ int main(int argc, char *argv[])
         TransOptions    trans_opt;
         trans_opt.mode = params.codegen.codegen_type == "" ? "c" : params.codegen.codegen_type;
         trans_opt.build_command_file = params.codegen.emit_build_command;
+        trans_opt.codegen_units = params.codegen.codegen_units;
         trans_opt.opt_level = params.opt_level;
         for(const char* libdir : params.lib_search_dirs ) {
             // Store these paths for use in final linking.
@@ -733,12 +774,12 @@ int main(int argc, char *argv[])
             case ::AST::Crate::Type::RustLib:
             case ::AST::Crate::Type::RustDylib:
             case ::AST::Crate::Type::CDylib:
-                return Trans_Enumerate_Public(*hir_crate);
+                return Trans_Enumerate_Public(*hir_crate, params.debug.share_generics);
             case ::AST::Crate::Type::ProcMacro:
                 // TODO: proc macros enumerate twice, once as a library (why?) and again as an executable
-                return Trans_Enumerate_Public(*hir_crate);
+                return Trans_Enumerate_Public(*hir_crate, params.debug.share_generics);
             case ::AST::Crate::Type::Executable:
-                return Trans_Enumerate_Main(*hir_crate);
+                return Trans_Enumerate_Main(*hir_crate, params.debug.share_generics);
             }
             throw ::std::runtime_error("Invalid crate_type value");
             });
@@ -753,16 +794,29 @@ int main(int argc, char *argv[])
         CompilePhaseV("MIR Optimise Inline", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items); });
         // - Clean up no-unused functions
         CompilePhaseV("Trans Enumerate Cleanup", [&]() { Trans_Enumerate_Cleanup(*hir_crate, items); });
+        // - Record emitted monomorphisations for downstream crates to use
+        if( params.debug.share_generics && (crate_type == ::AST::Crate::Type::RustLib || crate_type == ::AST::Crate::Type::RustDylib) )
+        {
+            Trans_Enumerate_RecordShared(*hir_crate, items);
+        }
 
         memory_dump("Trans");
 
+        // Signal to a pipelining build tool that the `.hir` is complete (dependent crates can start before codegen finishes)
+        auto mark_metadata_ready = [&]() {
+            if( params.emit_metadata_marker != "" ) {
+                ::std::ofstream of { params.emit_metadata_marker };
+            }
+            };
+
         switch(crate_type)
         {
         case ::AST::Crate::Type::Unknown:
             throw "";
         case ::AST::Crate::Type::RustLib:
             // Save a loadable HIR dump
-            CompilePhaseV("HIR Serialise", [&]() { HIR_Serialise(params.outfile + ".hir", *hir_crate); });
+            CompilePhaseV("HIR Serialise", [&]() { HIR_Serialise(params.outfile + ".hir", *hir_crate, params.codegen.hir_compression); });
+            mark_metadata_ready();
             // Generate a loadable .o
             CompilePhaseV("Trans Codegen", [&]() { Trans_Codegen(params.outfile, CodegenOutput::StaticLibrary, trans_opt, *hir_crate, items, params.outfile + ".hir"); });
             break;
@@ -770,9 +824,10 @@ int main(int argc, char *argv[])
             // Save a loadable HIR dump
             CompilePhaseV("HIR Serialise", [&]() {
                 //auto saved_ext_crates = ::std::move(hir_crate->m_ext_crates);
-                HIR_Serialise(params.outfile + ".hir", *hir_crate);
+                HIR_Serialise(params.outfile + ".hir", *hir_crate, params.codegen.hir_compression);
                 //hir_crate->m_ext_crates = ::std::move(saved_ext_crates);
                 });
+            mark_metadata_ready();
             // Generate a .so
             CompilePhaseV("Trans Codegen", [&]() { Trans_Codegen(params.outfile, CodegenOutput::DynamicLibrary, trans_opt, *hir_crate, items, params.outfile + ".hir"); });
             break;
@@ -784,16 +839,17 @@ int main(int argc, char *argv[])
             // Needs: An executable (the actual macro handler), metadata (for `extern crate foo;`)
 
             // 1. Generate code for the plugin itself
-            TransList items = CompilePhase<TransList>("Trans Enumerate PM", [&]() { return Trans_Enumerate_Main(*hir_crate); });
+            TransList items = CompilePhase<TransList>("Trans Enumerate PM", [&]() { return Trans_Enumerate_Main(*hir_crate, params.debug.share_generics); });
             CompilePhaseV("Trans Auto Impls PM", [&]() { Trans_AutoImpls(*hir_crate, items); });
             CompilePhaseV("Trans Monomorph PM", [&]() { Trans_Monomorphise_List(*hir_crate, items); });
             CompilePhaseV("MIR Optimise Inline PM", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items); });
             // - Save a very basic HIR dump, making sure that there's no lang items in it (e.g. `mrustc-main`)
             CompilePhaseV("HIR Serialise", [&]() {
                 auto saved_lang_items = ::std::move(hir_crate->m_lang_items); hir_crate->m_lang_items.clear();
-                HIR_Serialise(params.outfile + ".hir", *hir_crate);
+                HIR_Serialise(params.outfile + ".hir", *hir_crate, params.codegen.hir_compression);
                 hir_crate->m_lang_items = ::std::move(saved_lang_items);
                 });
+            mark_metadata_ready();
             CompilePhaseV("Trans Codegen", [&]() { Trans_Codegen(params.outfile, CodegenOutput::Executable, trans_opt, *hir_crate, items, params.outfile + ".hir"); });
             break; }
         case ::AST::Crate::Type::Executable:
@@ -870,6 +926,26 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     this->libraries.push_back( arg+1 );
                 }
                 continue ;
+            case 'j': {
+                const char* count_str;
+                if( arg[1] == '\0' ) {
+                    if( i == argc - 1 ) {
+                        ::std::cerr << "Option " << arg << " requires an argument" << ::std::endl;
+                        exit(1);
+                    }
+                    count_str = argv[++i];
+                }
+                else {
+                    count_str = arg+1;
+                }
+                char* end;
+                auto v = ::std::strtoul(count_str, &end, 10);
+                if( *end != '\0' || v == 0 ) {
+                    ::std::cerr << "Invalid thread count for -j - '" << count_str << "'" << ::std::endl;
+                    exit(1);
+                }
+                this->num_threads = static_cast<unsigned>(v);
+                } continue;
             case 'C': {
                 ::std::string optname;
                 ::std::string optval;
@@ -909,10 +985,55 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     get_optval();
                     this->codegen.codegen_type = optval;
                 }
+                else if( optname == "codegen-units" ) {
+                    get_optval();
+                    char* end;
+                    auto v = strtoul(optval.c_str(), &end, 10);
+                    if( *end != '\0' || v == 0 ) {
+                        ::std::cerr << "Invalid value for -C codegen-units: '" << optval << "'" << ::std::endl;
+                        exit(1);
+                    }
+                    this->codegen.codegen_units = static_cast<unsigned int>(v);
+                }
+                else if( optname == "hir-compression" ) {
+                    // `zlib` (the default, best compression), `zlib:<level>`, `zlib-fast` (alias for `zlib:1`), or `none` (stored as-is, so it can be mapped)
+                    get_optval();
+                    auto colon_pos = optval.find(':');
+                    auto codec = optval.substr(0, colon_pos);
+                    auto& c = this->codegen.hir_compression;
+                    c.level = -1;
+                    if( codec == "none" ) {
+                        c.codec = HirCompression::Codec::None;
+                    }
+                    else if( codec == "zlib" ) {
+                        c.codec = HirCompression::Codec::Zlib;
+                    }
+                    else if( codec == "zlib-fast" ) {
+                        c.codec = HirCompression::Codec::Zlib;
+                        c.level = 1;
+                    }
+                    else {
+                        ::std::cerr << "Unknown HIR compression codec '" << codec << "' (expected none, zlib, or zlib-fast)" << ::std::endl;
+                        exit(1);
+                    }
+                    if( colon_pos != ::std::string::npos ) {
+                        char* end;
+                        auto level = strtol(optval.c_str() + colon_pos + 1, &end, 10);
+                        if( *end != '\0' || level < 0 || level > 9 || c.codec == HirCompression::Codec::None ) {
+                            ::std::cerr << "Invalid level in -C hir-compression=" << optval << ::std::endl;
+                            exit(1);
+                        }
+                        c.level = static_cast<int>(level);
+                    }
+                }
                 else if( optname == "emit-depfile" ) {
                     get_optval();
                     this->emit_depfile = optval;
                 }
+                else if( optname == "emit-metadata-marker" ) {
+                    get_optval();
+                    this->emit_metadata_marker = optval;
+                }
                 else {
                     ::std::cerr << "Unknown codegen option: '" << optname << "'" << ::std::endl;
                     exit(1);
@@ -990,10 +1111,26 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                         exit(1);
                     }
                 }
+                else if( optname == "macro-expansion-cache" ) {
+                    no_optval();
+                    this->debug.macro_expansion_cache = true;
+                }
+                else if( optname == "share-generics" ) {
+                    no_optval();
+                    this->debug.share_generics = true;
+                }
+                else if( optname == "intern-types" ) {
+                    no_optval();
+                    this->debug.intern_types = true;
+                }
                 else if( optname == "print-cfgs") {
                     no_optval();
                     this->print_cfgs = true;
                 }
+                else if( optname == "print-c-compiler") {
+                    no_optval();
+                    this->print_c_compiler = true;
+                }
                 else {
                     ::std::cerr << "Unknown debug option: '" << optname << "'" << ::std::endl;
                     exit(1);
@@ -1061,6 +1198,14 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     this->output_dir += '/';
                 }
             }
+            // --timings-json <file>   >> Write per-phase timings/memory usage (and the slowest items) to a file
+            else if( strcmp(arg, "--timings-json") == 0 ) {
+                if (i == argc - 1) {
+                    ::std::cerr << "Flag " << arg << " requires an argument" << ::std::endl;
+                    exit(1);
+                }
+                this->timings_json_path = argv[++i];
+            }
             // --extern <name>=<path>   >> Override the file to load for `extern crate <name>;`
             else if( strcmp(arg, "--extern") == 0 ) {
                 if( i == argc - 1 ) {
@@ -1260,6 +1405,7 @@ void ProgramParams::show_help() const
         "-o <filename>      : Write compiler output (library or executable) to this file\n"
         "-O                 : Enable optimisation\n"
         "-g                 : Emit debugging information\n"
+        "-j <count>         : Use multiple threads for parallelisable passes (e.g. typecheck, MIR optimisation)\n"
         "--out-dir <dir>    : Specify the output directory (alternative to `-o`)\n"
         "--extern <crate>=<path>\n"
         "                   : Specify the path for a given crate (instead of searching for it)\n"
@@ -1270,6 +1416,8 @@ void ProgramParams::show_help() const
         "--cfg flag=\"val\"   : Set a string #[cfg]/cfg! flag\n"
         "--target <name>    : Compile code for the given target\n"
         "--test             : Generate a unit test executable\n"
+        "--timings-json <file>\n"
+        "                   : Write a per-phase profile (times, memory, slowest items) to this file\n"
         "-C <option>        : Code-generation options\n"
         "-Z <option>        : Debugging/experimental options\n"
         ;
@@ -1175,7 +1175,7 @@ void MIR_Helper_GetLifetimes_DetermineValueLifetime(
             return this->end == Position { ~0u, ~0u };
         }
     };
-    static unsigned NEXT_INDEX = 0;
+    static ::std::atomic<unsigned> NEXT_INDEX { 0 };
     struct State
     {
         unsigned int index = 0;
@@ -722,3 +722,105 @@ namespace MIR {
     throw "";
 }
 
+
+namespace {
+    ::MIR::CallTarget clone_call_target(const ::MIR::CallTarget& ct)
+    {
+        TU_MATCHA( (ct), (e),
+        (Value,
+            return e.clone();
+            ),
+        (Path,
+            return e.clone();
+            ),
+        (Intrinsic,
+            return ::MIR::CallTarget::make_Intrinsic({ e.name, e.params.clone() });
+            )
+        )
+        throw "";
+    }
+    ::MIR::Terminator clone_terminator(const ::MIR::Terminator& term)
+    {
+        TU_MATCHA( (term), (e),
+        (Incomplete,
+            return ::MIR::Terminator::make_Incomplete({});
+            ),
+        (Return,
+            return ::MIR::Terminator::make_Return({});
+            ),
+        (Diverge,
+            return ::MIR::Terminator::make_Diverge({});
+            ),
+        (Goto,
+            return ::MIR::Terminator::make_Goto(e);
+            ),
+        (Panic,
+            return ::MIR::Terminator::make_Panic({ e.dst });
+            ),
+        (If,
+            return ::MIR::Terminator::make_If({ e.cond.clone(), e.bb0, e.bb1 });
+            ),
+        (Switch,
+            return ::MIR::Terminator::make_Switch({ e.val.clone(), e.targets });
+            ),
+        (SwitchValue,
+            return ::MIR::Terminator::make_SwitchValue({ e.val.clone(), e.def_target, e.targets, e.values.clone() });
+            ),
+        (Call,
+            decltype(e.args)    args;
+            args.reserve(e.args.size());
+            for(const auto& a : e.args)
+                args.push_back( a.clone() );
+            return ::MIR::Terminator::make_Call({ e.ret_block, e.panic_block, e.ret_val.clone(), clone_call_target(e.fcn), mv$(args) });
+            )
+        )
+        throw "";
+    }
+    ::MIR::Statement clone_statement(const ::MIR::Statement& stmt)
+    {
+        TU_MATCHA( (stmt), (e),
+        (Assign,
+            return ::MIR::Statement::make_Assign({ e.dst.clone(), e.src.clone() });
+            ),
+        (Asm,
+            decltype(e.outputs) outputs;
+            for(const auto& v : e.outputs)
+                outputs.push_back(::std::make_pair( v.first, v.second.clone() ));
+            decltype(e.inputs) inputs;
+            for(const auto& v : e.inputs)
+                inputs.push_back(::std::make_pair( v.first, v.second.clone() ));
+            return ::MIR::Statement::make_Asm({ e.tpl, mv$(outputs), mv$(inputs), e.clobbers, e.flags });
+            ),
+        (SetDropFlag,
+            return ::MIR::Statement::make_SetDropFlag({ e.idx, e.new_val, e.other });
+            ),
+        (Drop,
+            return ::MIR::Statement::make_Drop({ e.kind, e.slot.clone(), e.flag_idx });
+            ),
+        (ScopeEnd,
+            return ::MIR::Statement::make_ScopeEnd({ e.slots });
+            )
+        )
+        throw "";
+    }
+}
+
+::MIR::Function MIR::Function::clone() const
+{
+    ::MIR::Function rv;
+    rv.locals.reserve(this->locals.size());
+    for(const auto& ty : this->locals)
+        rv.locals.push_back( ty.clone() );
+    rv.drop_flags = this->drop_flags;
+    rv.blocks.reserve(this->blocks.size());
+    for(const auto& bb : this->blocks)
+    {
+        ::MIR::BasicBlock   new_bb;
+        new_bb.statements.reserve(bb.statements.size());
+        for(const auto& stmt : bb.statements)
+            new_bb.statements.push_back( clone_statement(stmt) );
+        new_bb.terminator = clone_terminator(bb.terminator);
+        rv.blocks.push_back( mv$(new_bb) );
+    }
+    return rv;
+}
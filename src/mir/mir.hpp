@@ -697,6 +697,9 @@ public:
 
     // Cache filled/used by enumerate
     mutable EnumCachePtr trans_enum_state;
+
+    /// Deep copy (excluding `trans_enum_state`)
+    Function clone() const;
 };
 
 };
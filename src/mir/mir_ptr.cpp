@@ -3,7 +3,7 @@
  * - By John Hodge (Mutabah/thePowersGang)
  *
  * mir/mir_ptr.cpp
- * - Destructor for MIR function pointers (cold path code)
+ * - Destructor and lazy loading for MIR function pointers (cold path code)
  */
 #include "mir_ptr.hpp"
 #include "mir.hpp"
@@ -11,9 +11,21 @@
 
 void ::MIR::FunctionPointer::reset()
 {
-    if( this->ptr ) {
-        delete this->ptr;
+    if( auto* p = this->ptr.load() ) {
+        delete p;
         this->ptr = nullptr;
     }
+    m_loader.reset();
+}
+::MIR::Function* ::MIR::FunctionPointer::get_lazy() const
+{
+    // NOTE: Locked, as lazily-loaded MIR can be requested from multiple threads (e.g. by parallel MIR optimisation)
+    // - Only reached until the body has been published, later accesses just do the atomic load in `get`
+    ::std::lock_guard< ::std::mutex>    lh { m_loader->m_lock };
+    auto* p = this->ptr.load(::std::memory_order_relaxed);
+    if( !p ) {
+        p = m_loader->load(m_loader_key);
+        this->ptr.store(p, ::std::memory_order_release);
+    }
+    return p;
 }
-
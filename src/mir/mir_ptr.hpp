@@ -6,38 +6,71 @@
  * - Pointer to a blob of MIR
  */
 #pragma once
+#include <memory>
+#include <mutex>
+#include <atomic>
 
 namespace MIR {
 
 class Function;
 
+/// Source of MIR that is only deserialised when first used (see HIR_Deserialise)
+class FunctionLoader
+{
+    friend class FunctionPointer;
+protected:
+    // Serialises all loads from the same source (see HirLazyLoader)
+    ::std::mutex    m_lock;
+public:
+    virtual ~FunctionLoader() {}
+    /// Load the function identified by `key` (called with the lock held)
+    virtual ::MIR::Function* load(size_t key) = 0;
+};
+
 class FunctionPointer
 {
-    ::MIR::Function*    ptr;
+    // Atomic so that a lazily loaded body can be read without taking the loader lock (only needed for the first load)
+    mutable ::std::atomic< ::MIR::Function*>   ptr;
+    // If set, `ptr` is populated on first access
+    ::std::shared_ptr<FunctionLoader>   m_loader;
+    size_t  m_loader_key;
 public:
-    FunctionPointer(): ptr(nullptr) {}
-    FunctionPointer(::MIR::Function* p): ptr(p) {}
-    FunctionPointer(FunctionPointer&& x): ptr(x.ptr) { x.ptr = nullptr; }
+    FunctionPointer(): ptr(nullptr), m_loader_key(0) {}
+    FunctionPointer(::MIR::Function* p): ptr(p), m_loader_key(0) {}
+    FunctionPointer(::std::shared_ptr<FunctionLoader> loader, size_t key): ptr(nullptr), m_loader(::std::move(loader)), m_loader_key(key) {}
+    FunctionPointer(FunctionPointer&& x): ptr(x.ptr.load()), m_loader(::std::move(x.m_loader)), m_loader_key(x.m_loader_key) { x.ptr = nullptr; }
 
     ~FunctionPointer() {
         reset();
     }
     FunctionPointer& operator=(FunctionPointer&& x) {
         reset();
-        ptr = x.ptr;
+        ptr = x.ptr.load();
+        m_loader = ::std::move(x.m_loader);
+        m_loader_key = x.m_loader_key;
         x.ptr = nullptr;
         return *this;
     }
 
     void reset();
 
-          ::MIR::Function* operator->()       { if(!ptr) throw ""; return ptr; }
-    const ::MIR::Function* operator->() const { if(!ptr) throw ""; return ptr; }
-          ::MIR::Function& operator*()       { if(!ptr) throw ""; return *ptr; }
-    const ::MIR::Function& operator*() const { if(!ptr) throw ""; return *ptr; }
+          ::MIR::Function* operator->()       { return &**this; }
+    const ::MIR::Function* operator->() const { return &**this; }
+          ::MIR::Function& operator*()       { auto* p = get(); if(!p) throw ""; return *p; }
+    const ::MIR::Function& operator*() const { auto* p = get(); if(!p) throw ""; return *p; }
 
-    operator bool() const { return ptr != nullptr; }
+    operator bool() const { return ptr.load(::std::memory_order_relaxed) != nullptr || m_loader; }
+    /// Check if the body is available without loading it
+    bool is_loaded() const { return ptr.load(::std::memory_order_acquire) != nullptr; }
+private:
+    ::MIR::Function* get() const {
+        if( !m_loader )
+            return ptr.load(::std::memory_order_relaxed);
+        // Pairs with the release store in `get_lazy`
+        auto* p = ptr.load(::std::memory_order_acquire);
+        return p ? p : get_lazy();
+    }
+    ::MIR::Function* get_lazy() const;
 };
 
 }
-
@@ -15,6 +15,11 @@
 #include <mir/visit_crate_mir.hpp>
 #include <algorithm>
 #include <iomanip>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <thread_pool.hpp>
+#include <debug_inner.hpp>  // DebugCapture, DebugTimedItem
 #include <trans/target.hpp>
 #include <trans/trans_list.hpp> // Note: This is included for inlining after enumeration and monomorph
 
@@ -52,6 +57,11 @@ bool MIR_Optimise_UselessReborrows(::MIR::TypeResolve& state, ::MIR::Function& f
 bool MIR_Optimise_GarbageCollect_Partial(::MIR::TypeResolve& state, ::MIR::Function& fcn);
 bool MIR_Optimise_GarbageCollect(::MIR::TypeResolve& state, ::MIR::Function& fcn);
 
+namespace {
+    // Parallel optimisation support (see `MIR_OptimiseCrate`)
+    const ::MIR::Function* parallel_get_called_mir(const ::MIR::Function* mir);
+}
+
 
 /// A minimum set of optimisations:
 /// - Inlines `#[inline(always)]` functions
@@ -116,6 +126,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
 {
     static Span sp;
     TRACE_FUNCTION_F(path);
+    DebugTimedItem  timed_item([&](::std::ostream& os){ os << path; });
     ::MIR::TypeResolve   state { sp, resolve, FMT_CB(ss, ss << path;), ret_type, args, fcn };
 
     bool change_happened;
@@ -131,7 +142,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_BlockSimplify(state, fcn) )
         {
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -144,7 +155,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_ConstPropagate(state, fcn) )
         {
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -160,7 +171,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
             {
             }
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -173,7 +184,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_SplitAggregates(state, fcn) )
         {
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -187,7 +198,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_PropagateKnownValues(state, fcn) )
         {
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -206,7 +217,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
             {
             }
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -228,7 +239,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_UnifyBlocks(state, fcn) )
         {
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -239,7 +250,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_DeadDropFlags(state, fcn) )
         {
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -250,7 +261,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_DeadAssignments(state, fcn) )
         {
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -261,7 +272,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_NoopRemoval(state, fcn) )
         {
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -273,7 +284,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_UselessReborrows(state, fcn) )
         {
             #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
             #endif
             #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -285,7 +296,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         if( MIR_Optimise_GotoAssign(state, fcn) )
         {
             #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
             #endif
             #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -300,9 +311,9 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
             {
                 // Apply cleanup again (as monomorpisation in inlining may have exposed a vtable call)
                 MIR_Cleanup(resolve, path, fcn, args, ret_type);
-                //MIR_Dump_Fcn(::std::cout, fcn);
+                //MIR_Dump_Fcn(debug_stream(), fcn);
 #if DUMP_AFTER_ALL
-                if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+                if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
                 MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -315,7 +326,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         {
             #if DUMP_AFTER_PASS
             if( debug_enabled() ) {
-                MIR_Dump_Fcn(::std::cout, fcn);
+                MIR_Dump_Fcn(debug_stream(), fcn);
             }
             #endif
             #if CHECK_AFTER_PASS && !CHECK_AFTER_ALL
@@ -328,7 +339,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         {
             change_happened = true;
 #if DUMP_AFTER_ALL
-            if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+            if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
 #if CHECK_AFTER_ALL
             MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -362,7 +373,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
 
     #if DUMP_AFTER_DONE
     if( debug_enabled() ) {
-        MIR_Dump_Fcn(::std::cout, fcn);
+        MIR_Dump_Fcn(debug_stream(), fcn);
     }
     #endif
     #if CHECK_AFTER_DONE
@@ -661,6 +672,10 @@ namespace
                 MIR_BUG(state, "Enumeration failure - Function " << path << " not in TransList");
             }
             const auto& hir_fcn = *it->second->ptr;
+            if( it->second->is_shared ) {
+                // Emitted by an upstream crate (and its callees weren't enumerated), so can't be inlined
+                return nullptr;
+            }
             if( it->second->monomorphised.code ) {
                 return &*it->second->monomorphised.code;
             }
@@ -1524,7 +1539,7 @@ bool MIR_Optimise_Inlining(::MIR::TypeResolve& state, ::MIR::Function& fcn, bool
             }
 
             Cloner  cloner { state.sp, state.m_resolve, *te };
-            const auto* called_mir = get_called_mir(state, list, path,  cloner.params);
+            const auto* called_mir = parallel_get_called_mir( get_called_mir(state, list, path,  cloner.params) );
             if( !called_mir )
                 continue ;
             if( called_mir == &fcn )
@@ -3025,7 +3040,7 @@ bool MIR_Optimise_PropagateKnownValues(::MIR::TypeResolve& state, ::MIR::Functio
 bool MIR_Optimise_ConstPropagate(::MIR::TypeResolve& state, ::MIR::Function& fcn)
 {
 #if DUMP_BEFORE_ALL || DUMP_BEFORE_CONSTPROPAGATE
-    if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
+    if( debug_enabled() ) MIR_Dump_Fcn(debug_stream(), fcn);
 #endif
     bool changed = false;
     TRACE_FUNCTION_FR("", changed);
@@ -5681,23 +5696,147 @@ void MIR_SortBlocks(const StaticTraitResolve& resolve, const ::HIR::ItemPath& pa
 }
 
 
-void MIR_OptimiseCrate(::HIR::Crate& crate, bool do_minimal_optimisation)
+namespace {
+    /// A single function body queued for parallel optimisation
+    struct ParallelOptimiseJob
+    {
+        ::std::string   path;
+        const ::HIR::GenericParams* impl_generics;
+        const ::HIR::GenericParams* item_generics;
+        const ::HIR::Function::args_t*  args;   // nullptr = no arguments
+        ::HIR::TypeRef  ret_ty;
+
+        // The MIR as stored in the HIR - Left untouched until all jobs are complete
+        ::MIR::Function*    hir_mir;
+        // The copy being optimised
+        ::MIR::Function result;
+        ::std::string   debug_output;
+
+        bool    done = false;
+    };
+    struct ParallelOptimiseState
+    {
+        ::std::vector< ::std::unique_ptr<ParallelOptimiseJob> >  jobs;
+        ::std::unordered_map<const ::MIR::Function*, size_t>    job_for_mir;
+
+        ::std::mutex    lock;
+        ::std::condition_variable   cv;
+    };
+    thread_local ParallelOptimiseState* tl_parallel_state = nullptr;
+    thread_local size_t tl_parallel_job = 0;
+
+    /// Obtain the view of a called function's MIR that the serial visitor would have seen
+    /// - Functions visited earlier are seen after optimisation (waiting for them if required)
+    /// - Functions visited later are seen before optimisation
+    const ::MIR::Function* parallel_get_called_mir(const ::MIR::Function* mir)
+    {
+        if( !tl_parallel_state || !mir )
+            return mir;
+        auto& ps = *tl_parallel_state;
+        auto it = ps.job_for_mir.find(mir);
+        if( it == ps.job_for_mir.end() )
+            return mir;
+        auto& job = *ps.jobs[it->second];
+        if( it->second == tl_parallel_job )
+        {
+            return &job.result;
+        }
+        else if( it->second < tl_parallel_job )
+        {
+            ::std::unique_lock<::std::mutex>    lh(ps.lock);
+            ps.cv.wait(lh, [&]{ return job.done; });
+            return &job.result;
+        }
+        else
+        {
+            return mir;
+        }
+    }
+}
+
+void MIR_OptimiseCrate(::HIR::Crate& crate, bool do_minimal_optimisation, unsigned num_threads)
 {
-    ::MIR::OuterVisitor ov { crate, [do_minimal_optimisation](const auto& res, const auto& p, auto& expr, const auto& args, const auto& ty)
+    if( num_threads <= 1 )
+    {
+        ::MIR::OuterVisitor ov { crate, [do_minimal_optimisation](const auto& res, const auto& p, auto& expr, const auto& args, const auto& ty)
+            {
+                //if( ! dynamic_cast<::HIR::ExprNode_Block*>(expr.get()) ) {
+                //    return ;
+                //}
+                auto& mir = expr.get_mir_or_error_mut(Span());
+                if( do_minimal_optimisation ) {
+                    MIR_OptimiseMin(res, p, mir, args, ty);
+                }
+                else {
+                    MIR_Optimise(res, p, mir, args, ty);
+                }
+            }
+            };
+        ov.visit_crate(crate);
+        return ;
+    }
+
+    // Parallel mode: Collect all bodies (in the order the serial visitor uses), then optimise them on a worker pool.
+    // - Each job works on a copy of the MIR, and inlining sees callees in the same state that a serial run would
+    //   (see `parallel_get_called_mir`), so the output is identical to the serial run.
+    ParallelOptimiseState   ps;
+    ::MIR::OuterVisitor ov { crate, [&](const auto& res, const auto& p, auto& expr, const auto& args, const auto& ty)
         {
-            //if( ! dynamic_cast<::HIR::ExprNode_Block*>(expr.get()) ) {
-            //    return ;
-            //}
-            auto& mir = expr.get_mir_or_error_mut(Span());
+            auto job = ::std::make_unique<ParallelOptimiseJob>();
+            job->path = FMT(p);
+            job->impl_generics = res.m_impl_generics;
+            job->item_generics = res.m_item_generics;
+            job->args = args.empty() ? nullptr : &args;
+            job->ret_ty = ty.clone();
+            job->hir_mir = &expr.get_mir_or_error_mut(Span());
+            ps.job_for_mir.insert(::std::make_pair( job->hir_mir, ps.jobs.size() ));
+            ps.jobs.push_back(mv$(job));
+        }
+        };
+    ov.visit_crate(crate);
+    DEBUG(ps.jobs.size() << " bodies to optimise using " << num_threads << " threads");
+
+    bool debug_on = debug_enabled();
+    parallel_for_each_index(num_threads, ps.jobs.size(), [&](size_t idx) {
+        static const ::HIR::Function::args_t    empty_args;
+        auto& job = *ps.jobs[idx];
+        ::HIR::ItemPath ip(job.path);
+
+        tl_parallel_state = &ps;
+        tl_parallel_job = idx;
+        {
+            DebugCapture    capture;
+            StaticTraitResolve  resolve { crate };
+            if( job.impl_generics ) resolve.set_impl_generics_raw(*job.impl_generics);
+            if( job.item_generics ) resolve.set_item_generics_raw(*job.item_generics);
+
+            job.result = job.hir_mir->clone();
+            const auto& args = job.args ? *job.args : empty_args;
             if( do_minimal_optimisation ) {
-                MIR_OptimiseMin(res, p, mir, args, ty);
+                MIR_OptimiseMin(resolve, ip, job.result, args, job.ret_ty);
             }
             else {
-                MIR_Optimise(res, p, mir, args, ty);
+                MIR_Optimise(resolve, ip, job.result, args, job.ret_ty);
             }
+            if( debug_on )
+                job.debug_output = capture.str();
         }
-        };
-    ov.visit_crate(crate);
+        tl_parallel_state = nullptr;
+
+        {
+            ::std::lock_guard<::std::mutex> lh(ps.lock);
+            job.done = true;
+        }
+        ps.cv.notify_all();
+        });
+
+    // Store the results back into the HIR, and emit debug output in visit order
+    for(auto& job : ps.jobs)
+    {
+        *job->hir_mir = mv$(job->result);
+        if( debug_on )
+            ::std::cout << job->debug_output;
+    }
 }
 
 void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list)
@@ -5712,7 +5851,7 @@ void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list)
     {
         did_inline_on_pass = false;
 
-        for(auto& fcn_ent : list.m_functions)
+        for(const auto& fcn_ent : TransList_SortedEntries(list.m_functions))
         {
             const auto& path = fcn_ent.first;
             //const auto& pp = fcn_ent.second->pp;
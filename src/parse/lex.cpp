@@ -15,25 +15,42 @@
 #include <typeinfo>
 #include <algorithm>    // std::count
 #include <cctype>
+#include <cstring>  // memcpy
 //#define TRACE_CHARS
 //#define TRACE_RAW_TOKENS
 
 Lexer::Lexer(const ::std::string& filename, ParseState ps):
     TokenStream(ps),
-    m_path(filename.c_str()),
+    m_file_idx( Position::intern_filename(RcString(filename)) ),
     m_line(1),
     m_line_ofs(0),
-    m_istream(filename.c_str()),
     m_last_char_valid(false),
     m_hygiene( Ident::Hygiene::new_scope() )
 {
-    if( !m_istream.is_open() )
+    // Read the whole file in one go, the lexer then works directly on the buffer
     {
-        throw ::std::runtime_error("Unable to open file '" + filename + "'");
+        ::std::ifstream is(filename.c_str(), ::std::ios::binary);
+        if( !is.is_open() )
+        {
+            throw ::std::runtime_error("Unable to open file '" + filename + "'");
+        }
+        is.seekg(0, ::std::ios::end);
+        auto len = is.tellg();
+        is.seekg(0, ::std::ios::beg);
+        if( len > 0 )
+        {
+            m_data.resize(static_cast<size_t>(len));
+            is.read(&m_data[0], len);
+            m_data.resize(static_cast<size_t>(is.gcount()));
+        }
     }
+    m_cur = m_data.data();
+    m_end = m_data.data() + m_data.size();
+
     // Consume the BOM
-    if( this->getc_byte() == '\xef' )
+    if( m_cur != m_end && *m_cur == '\xef' )
     {
+        m_cur ++;
         if( this->getc_byte() != '\xbb' ) {
             throw ::std::runtime_error("Incomplete BOM - missing \\xBB in second position");
         }
@@ -42,10 +59,6 @@ Lexer::Lexer(const ::std::string& filename, ParseState ps):
         }
         m_line_ofs = 0;
     }
-    else
-    {
-        m_istream.unget();
-    }
 }
 
 
@@ -245,7 +258,7 @@ bool issym(Codepoint ch)
 
 Position Lexer::getPosition() const
 {
-    return Position(m_path, m_line, m_line_ofs);
+    return Position(m_file_idx, m_line, m_line_ofs);
 }
 Ident::Hygiene Lexer::realGetHygiene() const
 {
@@ -317,6 +330,7 @@ Token Lexer::getTokenInt()
             return Token(TOK_NEWLINE);
         if( ch.isspace() )
         {
+            this->take_ascii_space();
             while( (ch = this->getc()).isspace() && ch != '\n' )
                 ;
             this->ungetc();
@@ -600,6 +614,7 @@ Token Lexer::getTokenInt()
                 while(ch != '\n' && ch != '\r')
                 {
                     str += ch;
+                    this->take_ascii_until('\n', '\r', '\n', '\r', str);
                     ch = this->getc();
                 }
                 this->ungetc();
@@ -662,6 +677,7 @@ Token Lexer::getTokenInt()
                         }
                         else {
                             str += ch;
+                            this->take_ascii_until('/', '*', '\n', '\r', str);
                         }
                     }
                     ch = this->getc();
@@ -828,6 +844,7 @@ Token Lexer::getTokenInt_Identifier(Codepoint leader, Codepoint leader2)
     while( issym(ch) )
     {
         str += ch;
+        this->take_ascii_ident(str);
         ch = this->getc();
     }
 
@@ -953,18 +970,15 @@ uint32_t Lexer::parseEscape(char enclosing)
 
 char Lexer::getc_byte()
 {
-    int rv = m_istream.get();
-    if( rv == EOF || m_istream.eof() )
+    if( m_cur == m_end )
         throw Lexer::EndOfFile();
+    char rv = *m_cur++;
 
     if( rv == '\r' )
     {
-        if( m_istream.get() != '\n' )
-        {
-            m_istream.unget();
-        }
-        else
+        if( m_cur != m_end && *m_cur == '\n' )
         {
+            m_cur ++;
             rv = '\n';
         }
     }
@@ -1061,6 +1075,67 @@ Codepoint Lexer::getc_cp()
     }
 }
 
+namespace {
+    const uint64_t  SWAR_ONES = 0x0101010101010101ull;
+    const uint64_t  SWAR_HIGH = 0x8080808080808080ull;
+    /// Non-zero if any byte in `v` is zero
+    inline uint64_t swar_has_zero(uint64_t v) {
+        return (v - SWAR_ONES) & ~v & SWAR_HIGH;
+    }
+    inline uint64_t swar_has_byte(uint64_t v, char b) {
+        return swar_has_zero(v ^ (SWAR_ONES * static_cast<uint8_t>(b)));
+    }
+    inline bool is_ascii_ident(char c) {
+        return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_';
+    }
+}
+void Lexer::take_ascii_run(const char* run_end, ::std::string* out)
+{
+    assert(!m_last_char_valid);
+    if( out )
+        out->append(m_cur, run_end);
+    // All of these are single-byte codepoints, and none are newlines
+    m_line_ofs += static_cast<unsigned>(run_end - m_cur);
+    m_cur = run_end;
+}
+void Lexer::take_ascii_ident(::std::string& out)
+{
+    if( m_last_char_valid )
+        return ;
+    const char* p = m_cur;
+    while( p != m_end && is_ascii_ident(*p) )
+        p ++;
+    this->take_ascii_run(p, &out);
+}
+void Lexer::take_ascii_space()
+{
+    if( m_last_char_valid )
+        return ;
+    const char* p = m_cur;
+    while( p != m_end && (*p == ' ' || *p == '\t' || *p == '\x0c') )
+        p ++;
+    this->take_ascii_run(p, nullptr);
+}
+// Takes ASCII bytes up to (but not including) one of the stop bytes or any non-ASCII byte
+void Lexer::take_ascii_until(char s1, char s2, char s3, char s4, ::std::string& out)
+{
+    if( m_last_char_valid )
+        return ;
+    const char* p = m_cur;
+    // Check eight bytes at a time
+    while( m_end - p >= 8 )
+    {
+        uint64_t    v;
+        memcpy(&v, p, 8);
+        if( (v & SWAR_HIGH) || swar_has_byte(v, s1) || swar_has_byte(v, s2) || swar_has_byte(v, s3) || swar_has_byte(v, s4) )
+            break;
+        p += 8;
+    }
+    while( p != m_end && !(*p & 0x80) && *p != s1 && *p != s2 && *p != s3 && *p != s4 )
+        p ++;
+    this->take_ascii_run(p, &out);
+}
+
 void Lexer::ungetc()
 {
 #ifdef TRACE_CHARS
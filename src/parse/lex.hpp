@@ -35,11 +35,14 @@ typedef Codepoint   uchar;
 class Lexer:
     public TokenStream
 {
-    RcString    m_path;
+    uint32_t    m_file_idx; // Source map index of the file path
     unsigned int m_line;
     unsigned int m_line_ofs;
 
-    ::std::ifstream m_istream;
+    // Entire file contents (read up-front, then scanned in-place)
+    ::std::string   m_data;
+    const char* m_cur;
+    const char* m_end;
     bool    m_last_char_valid;
     Codepoint   m_last_char;
     ::std::vector<Token>    m_next_tokens;
@@ -74,6 +77,13 @@ private:
     Codepoint getc_cp();
     char getc_byte();
 
+    /// Fast paths: Consume a run of plain ASCII bytes directly from the buffer (appending them to `out`)
+    /// - These do nothing if there is an un-got character
+    void take_ascii_run(const char* run_end, ::std::string* out);
+    void take_ascii_ident(::std::string& out);
+    void take_ascii_space();
+    void take_ascii_until(char s1, char s2, char s3, char s4, ::std::string& out);
+
     class EndOfFile {};
 };
 
@@ -1998,6 +1998,7 @@ namespace {
                 mr->m_hygiene.set_mod_path(::std::move(mp));
             }
             mr->m_rules.push_back(Parse_MacroRules_MakeArm(pat_span, ::std::move(arm_pat), ::std::move(body)));
+            mr->build_first_token_index();
 
             item_name = name;
             item_data = ::AST::Item( MacroRulesPtr(mr) );
@@ -9,6 +9,9 @@
 #include <ast/types.hpp>
 #include <ast/ast.hpp>
 #include <ast/expr.hpp> // for reasons
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
 
 Token::~Token()
 {
@@ -53,23 +56,23 @@ Token::Token(enum eTokenType type):
 {
 }
 Token::Token(enum eTokenType type, RcString str):
-    m_type(type),
-    m_data(Data::make_IString(mv$(str)))
+    m_data(Data::make_IString(mv$(str))),
+    m_type(type)
 {
 }
 Token::Token(enum eTokenType type, ::std::string str):
-    m_type(type),
-    m_data(Data::make_String(mv$(str)))
+    m_data(Data::make_String(mv$(str))),
+    m_type(type)
 {
 }
 Token::Token(uint64_t val, enum eCoreType datatype):
-    m_type(TOK_INTEGER),
-    m_data( Data::make_Integer({datatype, val}) )
+    m_data( Data::make_Integer({datatype, val}) ),
+    m_type(TOK_INTEGER)
 {
 }
 Token::Token(double val, enum eCoreType datatype):
-    m_type(TOK_FLOAT),
-    m_data( Data::make_Float({datatype, val}) )
+    m_data( Data::make_Float({datatype, val}) ),
+    m_type(TOK_FLOAT)
 {
 }
 Token::Token(const InterpolatedFragment& frag)
@@ -161,9 +164,9 @@ Token::Token(TagTakeIP, InterpolatedFragment frag)
 }
 
 Token::Token(const Token& t):
-    m_type(t.m_type),
     m_data( Data::make_None({}) ),
-    m_pos( t.m_pos )
+    m_pos( t.m_pos ),
+    m_type(t.m_type)
 {
     assert( t.m_data.tag() != Data::TAGDEAD );
     TU_MATCH(Data, (t.m_data), (e),
@@ -547,6 +550,51 @@ struct EscapedString {
 }
 ::std::ostream& operator<<(::std::ostream& os, const Position& p)
 {
-    return os << ::std::dec << p.filename << ":" << p.line;
+    return os << ::std::dec << p.filename() << ":" << p.line;
+}
+
+namespace {
+    // Source map: file names referenced by `Position`
+    // - Append-only, stored in fixed-size chunks that are never moved or freed. Entries below `s_filenames_count` are
+    //   complete, so `Position::filename` can read them without taking the lock.
+    const size_t FILENAMES_CHUNK_SIZE = 1024;
+    const size_t FILENAMES_MAX_CHUNKS = 1024;
+    ::std::mutex    s_filenames_lock;   // Held by writers only
+    RcString*   s_filename_chunks[FILENAMES_MAX_CHUNKS];
+    ::std::atomic<uint32_t> s_filenames_count { 1 };    // Index 0 is the empty name
+    ::std::unordered_map<RcString, uint32_t>    s_filename_indexes;
+}
+uint32_t Position::intern_filename(const RcString& filename)
+{
+    if( filename == "" )
+        return 0;
+    ::std::lock_guard<::std::mutex> lh { s_filenames_lock };
+    auto it = s_filename_indexes.find(filename);
+    if( it != s_filename_indexes.end() )
+        return it->second;
+    uint32_t rv = s_filenames_count.load(::std::memory_order_relaxed);
+    size_t chunk = rv / FILENAMES_CHUNK_SIZE;
+    if( chunk >= FILENAMES_MAX_CHUNKS ) {
+        ::std::cerr << "Too many source files (limit " << FILENAMES_CHUNK_SIZE * FILENAMES_MAX_CHUNKS << ")" << ::std::endl;
+        abort();
+    }
+    if( !s_filename_chunks[chunk] )
+        s_filename_chunks[chunk] = new RcString[FILENAMES_CHUNK_SIZE];
+    s_filename_chunks[chunk][rv % FILENAMES_CHUNK_SIZE] = filename;
+    s_filename_indexes.insert(::std::make_pair(filename, rv));
+    // Publish the entry (after it's fully written)
+    s_filenames_count.store(rv + 1, ::std::memory_order_release);
+    return rv;
+}
+const RcString& Position::filename() const
+{
+    static const RcString   empty;
+    if( m_file_idx == 0 )
+        return empty;
+    // Pairs with the release in `intern_filename`, so the entry (and its chunk) is visible
+    auto count = s_filenames_count.load(::std::memory_order_acquire);
+    assert( m_file_idx < count );
+    (void)count;
+    return s_filename_chunks[m_file_idx / FILENAMES_CHUNK_SIZE][m_file_idx % FILENAMES_CHUNK_SIZE];
 }
 
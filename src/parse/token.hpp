@@ -20,24 +20,38 @@ enum eTokenType
     #undef _
 };
 
+/// Source location of a token
+///
+/// The file name is stored as an index into a global table of names (see `Position::intern_filename`), so positions
+/// can be copied without touching a reference count.
 class Position
 {
+    uint32_t    m_file_idx;
 public:
-    RcString    filename;
     unsigned int    line;
     unsigned int    ofs;
 
     Position():
-        filename(""),
+        m_file_idx(0),
         line(0),
         ofs(0)
     {}
-    Position(RcString filename, unsigned int line, unsigned int ofs):
-        filename(filename),
+    Position(uint32_t file_idx, unsigned int line, unsigned int ofs):
+        m_file_idx(file_idx),
         line(line),
         ofs(ofs)
     {
     }
+    Position(const RcString& filename, unsigned int line, unsigned int ofs):
+        Position(intern_filename(filename), line, ofs)
+    {
+    }
+
+    /// Obtain the table index for a file name (index zero is the empty name)
+    static uint32_t intern_filename(const RcString& filename);
+
+    bool has_filename() const { return m_file_idx != 0; }
+    const RcString& filename() const;
 };
 extern ::std::ostream& operator<<(::std::ostream& os, const Position& p);
 
@@ -77,18 +91,19 @@ class Token
     (Fragment, void*)
     );
 
-    enum eTokenType m_type;
+    // NOTE: `m_type` is last so it packs against the (12 byte) position
     Data    m_data;
     Position    m_pos;
+    enum eTokenType m_type;
 
     Token(enum eTokenType t, Data d, Position p):
-        m_type(t),
         m_data( ::std::move(d) ),
-        m_pos( ::std::move(p) )
+        m_pos( ::std::move(p) ),
+        m_type(t)
     {
     }
 public:
-    virtual ~Token();
+    ~Token();
     Token();
     Token& operator=(Token&& t)
     {
@@ -98,9 +113,9 @@ public:
         return *this;
     }
     Token(Token&& t):
-        m_type(t.m_type),
         m_data( ::std::move(t.m_data) ),
-        m_pos( ::std::move(t.m_pos) )
+        m_pos( ::std::move(t.m_pos) ),
+        m_type(t.m_type)
     {
         t.m_type = TOK_NULL;
     }
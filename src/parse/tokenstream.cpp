@@ -27,7 +27,7 @@ TokenStream::~TokenStream()
 Token TokenStream::innerGetToken()
 {
     Token ret = this->realGetToken();
-    if( ret != TOK_EOF && ret.get_pos().filename == "" )
+    if( ret != TOK_EOF && !ret.get_pos().has_filename() )
         ret.set_pos( this->getPosition() );
     //DEBUG("ret.get_pos() = " << ret.get_pos());
     return ret;
@@ -120,7 +120,7 @@ ProtoSpan TokenStream::start_span() const
 {
     auto p = this->getPosition();
     return ProtoSpan {
-        p.filename,
+        p.filename(),
         p.line, p.ofs
         };
 }
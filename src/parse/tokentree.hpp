@@ -18,7 +18,7 @@ class TokenTree
     Token   m_tok;
     ::std::vector<TokenTree>    m_subtrees;
 public:
-    virtual ~TokenTree() {}
+    ~TokenTree() {}
     TokenTree() {}
     TokenTree(TokenTree&&) = default;
     TokenTree& operator=(TokenTree&&) = default;
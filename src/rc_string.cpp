@@ -10,16 +10,23 @@
 #include <string>
 #include <iostream>
 #include <algorithm>    // std::max
+#include <mutex>
+#include <unordered_map>
+#include <cstddef>  // offsetof
+#include <new>  // placement new
 
 RcString::RcString(const char* s, size_t len):
     m_ptr(nullptr)
 {
     if( len > 0 )
     {
-        m_ptr = new unsigned int[2 + (len+1 + sizeof(unsigned int)-1) / sizeof(unsigned int)];
-        m_ptr[0] = 1;
-        m_ptr[1] = static_cast<unsigned>(len);
-        char* data_mut = reinterpret_cast<char*>(m_ptr + 2);
+        void* mem = ::operator new(offsetof(Inner, data) + len+1);
+        m_ptr = new(mem) Inner;
+        m_ptr->refcount = 1;
+        m_ptr->size = static_cast<unsigned>(len);
+        m_ptr->is_interned = false;
+        m_ptr->hash = 0;
+        char* data_mut = m_ptr->data;
         for(unsigned int j = 0; j < len; j ++ )
             data_mut[j] = s[j];
         data_mut[len] = '\0';
@@ -31,11 +38,11 @@ RcString::~RcString()
 {
     if(m_ptr)
     {
-        *m_ptr -= 1;
-        //::std::cout << "RcString(" << m_ptr << " \"" << *this << "\") - " << *m_ptr << " refs left (drop)" << ::std::endl;
-        if( *m_ptr == 0 )
+        //::std::cout << "RcString(" << m_ptr << " \"" << *this << "\") - " << m_ptr->refcount << " refs left (drop)" << ::std::endl;
+        if( --m_ptr->refcount == 0 )
         {
-            delete[] m_ptr;
+            m_ptr->~Inner();
+            ::operator delete(m_ptr);
             m_ptr = nullptr;
         }
     }
@@ -81,46 +88,60 @@ Ordering RcString::ord(const char* s) const
 }
 
 
-::std::set<RcString>    RcString_interned_strings;
-
-RcString RcString::new_interned(const ::std::string& s)
-{
-#if 0
-    auto it = RcString_interned_strings.find(s);
-    if( it == RcString_interned_strings.end() )
+namespace {
+    // djb2 (http://www.cse.yorku.ca/~oz/hash.html)
+    size_t hash_bytes(const char* s, size_t len)
     {
-        it = RcString_interned_strings.insert(RcString(s)).first;
+        size_t h = 5381;
+        for(size_t i = 0; i < len; i ++) {
+            h = h * 33 + (unsigned)s[i];
+        }
+        return h;
     }
-    return *it;
-#else
-    // TODO: interning flag, so comparisons can just be a pointer comparison
-    // - Only want to set this flag on the cached instance
-    return *RcString_interned_strings.insert(RcString(s)).first;
-#endif
+
+    // Key into the intern table (points at the interned string's data)
+    struct InternKey {
+        const char* s;
+        size_t  len;
+        size_t  hash;
+        bool operator==(const InternKey& x) const {
+            return len == x.len && memcmp(s, x.s, len) == 0;
+        }
+    };
+    struct InternKeyHash {
+        size_t operator()(const InternKey& k) const { return k.hash; }
+    };
+    ::std::unordered_map<InternKey, RcString, InternKeyHash>    RcString_interned_strings;
+    ::std::mutex    RcString_interned_strings_lock;
 }
-RcString RcString::new_interned(const char* s)
+
+RcString RcString::new_interned(const char* s, size_t len)
 {
-#if 0
-    auto it = RcString_interned_strings.find(s);
-    if( it == RcString_interned_strings.end() )
-    {
-        it = RcString_interned_strings.insert(RcString(s)).first;
-    }
-    return *it;
-#else
-    // TODO: interning flag, so comparisons can just be a pointer comparison
-    // - Only want to set this flag on the cached instance
-    return *RcString_interned_strings.insert(RcString(s)).first;
-#endif
+    if( len == 0 )
+        return RcString();
+    InternKey   key { s, len, hash_bytes(s, len) };
+
+    ::std::lock_guard<::std::mutex> lh(RcString_interned_strings_lock);
+    auto it = RcString_interned_strings.find(key);
+    if( it != RcString_interned_strings.end() )
+        return it->second;
+
+    RcString    rv(s, len);
+    rv.m_ptr->is_interned = true;
+    rv.m_ptr->hash = key.hash;
+    key.s = rv.c_str();
+    RcString_interned_strings.insert(::std::make_pair(key, rv));
+    return rv;
+}
+
+size_t RcString::hash() const
+{
+    if( this->is_interned() )
+        return m_ptr->hash;
+    return hash_bytes(this->c_str(), this->size());
 }
 
 size_t std::hash<RcString>::operator()(const RcString& s) const noexcept
 {
-    // http://www.cse.yorku.ca/~oz/hash.html "djb2"
-    size_t h = 5381;
-    for(auto c : s) {
-        h = h * 33 + (unsigned)c;
-    }
-    return h;
-    //return hash<std::string_view>(s.c_str(), s.size());
+    return s.hash();
 }
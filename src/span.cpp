@@ -17,7 +17,7 @@ Span::Span(Span parent, RcString filename, unsigned int start_line, unsigned int
     m_ptr(SpanInner::alloc( parent, ::std::move(filename), start_line, start_ofs, end_line, end_ofs ))
 {}
 Span::Span(Span parent, const Position& pos):
-    m_ptr(SpanInner::alloc( parent, pos.filename, pos.line,pos.ofs, pos.line,pos.ofs ))
+    m_ptr(SpanInner::alloc( parent, pos.filename(), pos.line,pos.ofs, pos.line,pos.ofs ))
 {
 }
 Span::Span(const Span& x):
@@ -39,9 +39,10 @@ Span::~Span()
 }
 
 namespace {
-    void print_span_message(const Span& sp, ::std::function<void(::std::ostream&)> tag, ::std::function<void(::std::ostream&)> msg)
+    thread_local bool   t_defer_fatal = false;
+
+    void print_span_message(::std::ostream& sink, const Span& sp, ::std::function<void(::std::ostream&)> tag, ::std::function<void(::std::ostream&)> msg)
     {
-        auto& sink = ::std::cerr;
         sink << sp->filename << ":" << sp->start_line << ": ";
         tag(sink);
         sink << ":";
@@ -53,30 +54,58 @@ namespace {
             sink << parent->filename << ":" << parent->start_line << ": note: From here" << ::std::endl;
         }
     }
-}
-void Span::bug(::std::function<void(::std::ostream&)> msg) const
-{
-    print_span_message(*this, [](auto& os){os << "BUG";}, msg);
+    void print_span_message(const Span& sp, ::std::function<void(::std::ostream&)> tag, ::std::function<void(::std::ostream&)> msg)
+    {
+        print_span_message(::std::cerr, sp, tag, msg);
+    }
+    [[noreturn]] void fatal_span_message(const Span& sp, ::std::function<void(::std::ostream&)> tag, ::std::function<void(::std::ostream&)> msg)
+    {
+        if( t_defer_fatal )
+        {
+            ::std::stringstream ss;
+            print_span_message(ss, sp, tag, msg);
+            throw SpanFatalError { ss.str() };
+        }
+        print_span_message(sp, tag, msg);
 #ifndef _WIN32
-    abort();
+        abort();
 #else
-    exit(1);
+        exit(1);
 #endif
+    }
+}
+void Span::bug(::std::function<void(::std::ostream&)> msg) const
+{
+    fatal_span_message(*this, [](auto& os){os << "BUG";}, msg);
 }
 
 void Span::error(ErrorType tag, ::std::function<void(::std::ostream&)> msg) const {
-    print_span_message(*this, [&](auto& os){os << "error:" << tag;}, msg);
+    fatal_span_message(*this, [&](auto& os){os << "error:" << tag;}, msg);
+}
+void Span::warning(WarningType tag, ::std::function<void(::std::ostream&)> msg) const {
+    print_span_message(*this, [&](auto& os){os << "warn:" << tag;}, msg);
+}
+void Span::note(::std::function<void(::std::ostream&)> msg) const {
+    print_span_message(*this, [](auto& os){os << "note:";}, msg);
+}
+
+void SpanFatalError::report() const
+{
+    ::std::cerr << message << ::std::flush;
 #ifndef _WIN32
     abort();
 #else
     exit(1);
 #endif
 }
-void Span::warning(WarningType tag, ::std::function<void(::std::ostream&)> msg) const {
-    print_span_message(*this, [&](auto& os){os << "warn:" << tag;}, msg);
+DeferFatalSpanErrors::DeferFatalSpanErrors():
+    m_saved(t_defer_fatal)
+{
+    t_defer_fatal = true;
 }
-void Span::note(::std::function<void(::std::ostream&)> msg) const {
-    print_span_message(*this, [](auto& os){os << "note:";}, msg);
+DeferFatalSpanErrors::~DeferFatalSpanErrors()
+{
+    t_defer_fatal = m_saved;
 }
 
 ::std::ostream& operator<<(::std::ostream& os, const Span& sp)
@@ -211,7 +211,7 @@ void Trans_AutoImpls(::HIR::Crate& crate, TransList& trans_list)
     State   state { crate, trans_list };
 
     // Generate for all 
-    for(const auto& ty : trans_list.auto_clone_impls)
+    for(const auto& ty : TransList_SortedEntries(trans_list.auto_clone_impls))
     {
         state.done_list.insert( ty.clone() );
         Trans_AutoImpl_Clone(state, ty.clone());
@@ -26,7 +26,7 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
     }
     else if( opt.mode == "c" )
     {
-        codegen = Trans_Codegen_GetGeneratorC(crate, outfile);
+        codegen = Trans_Codegen_GetGeneratorC(crate, outfile, opt);
     }
     else
     {
@@ -65,12 +65,12 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
             codegen->emit_type(ty.first);
         }
     }
-    for(const auto& ty : list.m_typeids)
+    for(const auto& ty : TransList_SortedEntries(list.m_typeids))
     {
         codegen->emit_type_id(ty);
     }
     // Emit required constructor methods (and other wrappers)
-    for(const auto& path : list.m_constructors)
+    for(const auto& path : TransList_SortedEntries(list.m_constructors))
     {
         // Get the item type
         // - Function (must be an intrinsic)
@@ -98,20 +98,25 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
         codegen->emit_constructor_struct(sp, path, te.as_Struct());
     }
 
+    // Sorted by path, so the output doesn't depend on hash order
+    auto functions = TransList_SortedEntries(list.m_functions);
+    auto statics = TransList_SortedEntries(list.m_statics);
+
     // 2. Emit function prototypes
-    for(const auto& ent : list.m_functions)
+    for(const auto& ent : functions)
     {
         DEBUG("FUNCTION " << ent.first);
         assert( ent.second->ptr );
         const auto& fcn = *ent.second->ptr;
         // Extern if there isn't any HIR
-        bool is_extern = ! static_cast<bool>(fcn.m_code);
+        // - Shared monomorphisations are defined by an upstream crate, so are a plain declaration
+        bool is_extern = ! static_cast<bool>(fcn.m_code) && !ent.second->is_shared;
         if( fcn.m_code.m_mir ) {
             codegen->emit_function_proto(ent.first, fcn, ent.second->pp, is_extern);
         }
     }
     // - External functions
-    for(const auto& ent : list.m_functions)
+    for(const auto& ent : functions)
     {
         //DEBUG("FUNCTION " << ent.first);
         assert( ent.second->ptr );
@@ -129,7 +134,7 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
         }
     }
     // VTables (may be needed by statics)
-    for(const auto& ent : list.m_vtables)
+    for(const auto& ent : TransList_SortedEntries(list.m_vtables))
     {
         const auto& trait = ent.first.m_data.as_UfcsKnown().trait;
         const auto& type = ent.first.m_data.as_UfcsKnown().type;
@@ -138,7 +143,7 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
         codegen->emit_vtable(ent.first, crate.get_trait_by_path(Span(), trait.m_path));
     }
     // 3. Emit statics
-    for(const auto& ent : list.m_statics)
+    for(const auto& ent : statics)
     {
         DEBUG("STATIC proto " << ent.first);
         assert(ent.second->ptr);
@@ -153,7 +158,7 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
             codegen->emit_static_ext(ent.first, stat, ent.second->pp);
         }
     }
-    for(const auto& ent : list.m_statics)
+    for(const auto& ent : statics)
     {
         DEBUG("STATIC " << ent.first);
         assert(ent.second->ptr);
@@ -167,9 +172,9 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
 
 
     // 4. Emit function code
-    for(const auto& ent : list.m_functions)
+    for(const auto& ent : functions)
     {
-        if( ent.second->ptr && ent.second->ptr->m_code.m_mir )
+        if( ent.second->ptr && ent.second->ptr->m_code.m_mir && !ent.second->is_shared )
         {
             const auto& path = ent.first;
             const auto& fcn = *ent.second->ptr;
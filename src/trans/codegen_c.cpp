@@ -8,8 +8,11 @@
 #include "codegen.hpp"
 #include "mangling.hpp"
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <thread_pool.hpp>
 #include <hir/hir.hpp>
 #include <mir/mir.hpp>
 #include <hir_typeck/static.hpp>
@@ -132,6 +135,31 @@ namespace {
     return os;
 }
 
+::std::string Trans_GetCCompiler()
+{
+    const auto& backend = Target_GetCurSpec().m_backend_c;
+    if( backend.m_codegen_mode == CodegenMode::Msvc )
+        return "cl.exe";
+    // Pick the compiler
+    // - from `CC-${TRIPLE}` environment variable
+    // - from the $CC environment variable
+    // - `gcc-${TRIPLE}` (if available)
+    // - `gcc` as fallback
+    ::std::string varname = "CC-" +  backend.m_c_compiler;
+    if( getenv(varname.c_str()) ) {
+        return getenv(varname.c_str());
+    }
+    else if (system(("which " + backend.m_c_compiler + "-gcc" + " >/dev/null 2>&1").c_str()) == 0) {
+        return backend.m_c_compiler + "-gcc";
+    }
+    else if( getenv("CC") ) {
+        return getenv("CC");
+    }
+    else {
+        return "gcc";
+    }
+}
+
 namespace {
     struct MsvcDetection
     {
@@ -181,9 +209,21 @@ namespace {
         ::std::string   m_outfile_path;
         ::std::string   m_outfile_path_c;
 
-        ::std::ofstream m_of;
+        ::std::filebuf  m_of_file;
+        ::std::ostream  m_of;
         const ::MIR::TypeResolve* m_mir_res;
 
+        // Split output (`-C codegen-units=N`)
+        // - Types, prototypes and vtables go into a shared header
+        // - Function bodies are spread across the units (unit 0 also gets statics and the entrypoint)
+        struct CodegenUnit {
+            ::std::string   path_c;
+            ::std::stringbuf    buf;
+            size_t  size = 0;
+        };
+        ::std::stringbuf    m_header_buf;
+        ::std::vector< ::std::unique_ptr<CodegenUnit> > m_units;
+
         Compiler    m_compiler = Compiler::Gcc;
         struct {
             bool emulated_i128 = false;
@@ -193,12 +233,12 @@ namespace {
         ::std::vector< ::std::pair< ::HIR::GenericPath, const ::HIR::Struct*> >   m_box_glue_todo;
         ::std::set< ::HIR::TypeRef> m_emitted_fn_types;
     public:
-        CodeGenerator_C(const ::HIR::Crate& crate, const ::std::string& outfile):
+        CodeGenerator_C(const ::HIR::Crate& crate, const ::std::string& outfile, const TransOptions& opt):
             m_crate(crate),
             m_resolve(crate),
             m_outfile_path(outfile),
             m_outfile_path_c(outfile + ".c"),
-            m_of(m_outfile_path_c)
+            m_of(nullptr)
         {
             m_options.emulated_i128 = Target_GetCurSpec().m_backend_c.m_emulated_i128;
             switch(Target_GetCurSpec().m_backend_c.m_codegen_mode)
@@ -221,6 +261,25 @@ namespace {
                 break;
             }
 
+            if( opt.codegen_units > 1 && m_compiler == Compiler::Gcc )
+            {
+                for(unsigned i = 0; i < opt.codegen_units; i ++)
+                {
+                    m_units.push_back(::std::make_unique<CodegenUnit>());
+                    m_units.back()->path_c = (i == 0 ? m_outfile_path_c : FMT(m_outfile_path << ".cu" << i << ".c"));
+                }
+                m_of.rdbuf(&m_header_buf);
+            }
+            else
+            {
+                if( opt.codegen_units > 1 )
+                {
+                    WARNING(Span(), W0000, "Multiple codegen units are only supported with GCC-compatible compilers");
+                }
+                m_of_file.open(m_outfile_path_c, ::std::ios::out);
+                m_of.rdbuf(&m_of_file);
+            }
+
             m_of
                 << "/*\n"
                 << " * AUTOGENERATED by mrustc\n"
@@ -737,10 +796,14 @@ namespace {
         void finalise(const TransOptions& opt, CodegenOutput out_ty, const ::std::string& hir_file) override
         {
             // Emit box drop glue after everything else to avoid definition ordering issues
+            if( is_split() )
+                m_of.rdbuf(&m_header_buf);
             for(auto& e : m_box_glue_todo)
             {
                 emit_box_drop_glue( mv$(e.first), *e.second );
             }
+            if( is_split() )
+                switch_to_unit(0);
 
             const bool create_shims = (out_ty == CodegenOutput::Executable);
 
@@ -870,7 +933,14 @@ namespace {
             }
 
             m_of.flush();
-            m_of.close();
+            if( is_split() )
+            {
+                write_split_files();
+            }
+            else
+            {
+                m_of_file.close();
+            }
 
             ::std::vector<const char*> link_dirs;
             auto add_link_dir = [&link_dirs](const char* d) {
@@ -893,6 +963,7 @@ namespace {
 
             // Execute $CC with the required libraries
             StringList  args;
+            ::std::vector< ::std::string>   unit_cmds;
 #ifdef _WIN32
             bool is_windows = true;
 #else
@@ -901,26 +972,7 @@ namespace {
             switch( m_compiler )
             {
             case Compiler::Gcc:
-                // Pick the compiler
-                // - from `CC-${TRIPLE}` environment variable
-                // - from the $CC environment variable
-                // - `gcc-${TRIPLE}` (if available)
-                // - `gcc` as fallback
-                {
-                    ::std::string varname = "CC-" +  Target_GetCurSpec().m_backend_c.m_c_compiler;
-                    if( getenv(varname.c_str()) ) {
-                        args.push_back( getenv(varname.c_str()) );
-                    }
-                    else if (system(("which " + Target_GetCurSpec().m_backend_c.m_c_compiler + "-gcc" + " >/dev/null 2>&1").c_str()) == 0) {
-                        args.push_back( Target_GetCurSpec().m_backend_c.m_c_compiler + "-gcc" );
-                    }
-                    else if( getenv("CC") ) {
-                        args.push_back( getenv("CC") );
-                    }
-                    else {
-                        args.push_back("gcc");
-                    }
-                }
+                args.push_back( Trans_GetCCompiler() );
                 for( const auto& a : Target_GetCurSpec().m_backend_c.m_compiler_opts )
                 {
                     args.push_back( a.c_str() );
@@ -940,6 +992,21 @@ namespace {
                     args.push_back("-g");
                 }
                 args.push_back("-fPIC");
+                if( is_split() )
+                {
+                    // Compile each unit to an object, then link/combine them below
+                    for(size_t i = 0; i < m_units.size(); i ++)
+                    {
+                        StringList  unit_args;
+                        for(const char* a : args.get_vec())
+                            unit_args.push_back(a);
+                        unit_args.push_back("-c");
+                        unit_args.push_back("-o");
+                        unit_args.push_back(unit_object_path(i));
+                        unit_args.push_back(m_units[i]->path_c.c_str());
+                        unit_cmds.push_back( make_shell_command(unit_args, is_windows) );
+                    }
+                }
                 args.push_back("-o");
                 switch(out_ty)
                 {
@@ -952,7 +1019,15 @@ namespace {
                     args.push_back(m_outfile_path+".o");
                     break;
                 }
-                args.push_back(m_outfile_path_c.c_str());
+                if( is_split() )
+                {
+                    for(size_t i = 0; i < m_units.size(); i ++)
+                        args.push_back(unit_object_path(i));
+                }
+                else
+                {
+                    args.push_back(m_outfile_path_c.c_str());
+                }
                 switch(out_ty)
                 {
                 case CodegenOutput::DynamicLibrary:
@@ -1026,7 +1101,16 @@ namespace {
                     break;
                 case CodegenOutput::StaticLibrary:
                 case CodegenOutput::Object:
-                    args.push_back("-c");
+                    if( is_split() )
+                    {
+                        // Combine the units into a single relocatable object
+                        args.push_back("-r");
+                        args.push_back("-nostdlib");
+                    }
+                    else
+                    {
+                        args.push_back("-c");
+                    }
                     break;
                 }
                 break;
@@ -1116,6 +1200,66 @@ namespace {
                 break;
             }
 
+            auto cmd = make_shell_command(args, is_windows);
+            // When split, the combined object has to have the crate-local (hidden) symbols made local again
+            ::std::string   localise_cmd;
+            if( is_split() && (out_ty == CodegenOutput::StaticLibrary || out_ty == CodegenOutput::Object) )
+            {
+                const char* objcopy = getenv("OBJCOPY") ? getenv("OBJCOPY") : "objcopy";
+                StringList  localise_args;
+                localise_args.push_back(objcopy);
+                localise_args.push_back("--localize-hidden");
+                localise_args.push_back(out_ty == CodegenOutput::StaticLibrary ? m_outfile_path + ".o" : m_outfile_path);
+                localise_cmd = make_shell_command(localise_args, is_windows);
+            }
+            if( opt.build_command_file != "" )
+            {
+                ::std::ofstream os(opt.build_command_file);
+                if( !unit_cmds.empty() )
+                {
+                    os << "set -e" << ::std::endl;
+                    for(const auto& c : unit_cmds)
+                    {
+                        ::std::cerr << "INVOKE CC: " << c << ::std::endl;
+                        os << c << " &" << ::std::endl;
+                    }
+                    os << "wait" << ::std::endl;
+                }
+                ::std::cerr << "INVOKE CC: " << cmd << ::std::endl;
+                os << cmd << ::std::endl;
+                if( localise_cmd != "" )
+                    os << localise_cmd << ::std::endl;
+            }
+            else
+            {
+                // Compile the units concurrently (one job per unit)
+                // - Failures are only acted on once all the workers have finished (exiting with live threads isn't safe)
+                ::std::atomic<bool> unit_failed { false };
+                parallel_for_each_index(static_cast<unsigned>(unit_cmds.size()), unit_cmds.size(), [&](size_t i) {
+                    if( !unit_failed && !run_command(unit_cmds[i]) )
+                        unit_failed = true;
+                    });
+                if( unit_failed )
+                    exit(1);
+                if( !run_command(cmd) )
+                    exit(1);
+                if( localise_cmd != "" && !run_command(localise_cmd) )
+                    exit(1);
+            }
+
+            // HACK! Static libraries aren't implemented properly yet, just touch the output file
+            if( out_ty == CodegenOutput::StaticLibrary )
+            {
+                ::std::ofstream of( m_outfile_path );
+                if( !of.good() )
+                {
+                    // TODO: Error?
+                }
+            }
+        }
+
+        static ::std::string make_shell_command(const StringList& args, bool is_windows)
+        {
             ::std::stringstream cmd_ss;
             if (is_windows)
             {
@@ -1134,36 +1278,64 @@ namespace {
                     cmd_ss << "\"" << FmtShell(arg, is_windows) << "\" ";
                 }
             }
-            //DEBUG("- " << cmd_ss.str());
-            ::std::cout << "Running command - " << cmd_ss.str() << ::std::endl;
-            if( opt.build_command_file != "" )
+            return cmd_ss.str();
+        }
+        /// Run a shell command (can be called from worker threads), returns false if it failed
+        static bool run_command(const ::std::string& cmd)
+        {
+            //DEBUG("- " << cmd);
+            // NOTE: Each message is written as a single string, so output from concurrent commands doesn't interleave
+            ::std::cout << ("Running command - " + cmd + "\n") << ::std::flush;
+            int ec = system(cmd.c_str());
+            if( ec == -1 )
+            {
+                ::std::cerr << "C Compiler failed to execute (system returned -1)\n" << ::std::flush;
+                perror("system");
+                return false;
+            }
+            else if( ec != 0 )
             {
-                ::std::cerr << "INVOKE CC: " << cmd_ss.str() << ::std::endl;
-                ::std::ofstream(opt.build_command_file) << cmd_ss.str() << ::std::endl;
+                ::std::cerr << ("C Compiler failed to execute - error code " + ::std::to_string(ec) + "\n") << ::std::flush;
+                return false;
             }
-            else
+            return true;
+        }
+
+        bool is_split() const {
+            return !m_units.empty();
+        }
+        ::std::string unit_object_path(size_t idx) const {
+            return FMT(m_outfile_path << ".cu" << idx << ".o");
+        }
+        void switch_to_unit(size_t idx) {
+            m_of.rdbuf(&m_units.at(idx)->buf);
+        }
+        /// Write the shared header and each unit's source file
+        void write_split_files()
+        {
+            auto header_path = m_outfile_path + ".h";
+            // NOTE: Units include the header by its file name (it lives next to them)
+            auto slash_pos = header_path.find_last_of("/\\");
+            auto header_name = (slash_pos == ::std::string::npos ? header_path : header_path.substr(slash_pos+1));
             {
-                int ec = system(cmd_ss.str().c_str());
-                if( ec == -1 )
+                ::std::ofstream os(header_path);
+                os << "#pragma once\n";
+                os << m_header_buf.str();
+                if( !os.good() )
                 {
-                    ::std::cerr << "C Compiler failed to execute (system returned -1)" << ::std::endl;
-                    perror("system");
-                    exit(1);
-                }
-                else if( ec != 0 )
-                {
-                    ::std::cerr << "C Compiler failed to execute - error code " << ec << ::std::endl;
+                    ::std::cerr << "Failed to write " << header_path << ::std::endl;
                     exit(1);
                 }
             }
-
-            // HACK! Static libraries aren't implemented properly yet, just touch the output file
-            if( out_ty == CodegenOutput::StaticLibrary )
+            for(const auto& u : m_units)
             {
-                ::std::ofstream of( m_outfile_path );
-                if( !of.good() )
+                ::std::ofstream os(u->path_c);
+                os << "#include \"" << header_name << "\"\n";
+                os << u->buf.str();
+                if( !os.good() )
                 {
-                    // TODO: Error?
+                    ::std::cerr << "Failed to write " << u->path_c << ::std::endl;
+                    exit(1);
                 }
             }
         }
@@ -2030,6 +2202,11 @@ namespace {
 
             TRACE_FUNCTION_F(p);
             auto type = params.monomorph(m_resolve, item.m_type);
+            // When split, the prototype is in the shared header (and the definition is in the first unit)
+            if( is_split() )
+            {
+                m_of << "extern ";
+            }
             emit_ctype( type, FMT_CB(ss, ss << Trans_Mangle(p);) );
             m_of << ";";
             m_of << "\t// static " << p << " : " << type;
@@ -2044,10 +2221,21 @@ namespace {
             m_mir_res = &top_mir_res;
 
             TRACE_FUNCTION_F(p);
+            if( is_split() )
+            {
+                switch_to_unit(0);
+            }
 
             auto type = params.monomorph(m_resolve, item.m_type);
             // statics that are zero do not require initializers, since they will be initialized to zero on program startup.
-            if (!is_zero_literal(type, item.m_value_res, params)) {
+            // - Unless the prototype was `extern`, in which case a (zero-initialised) definition is still needed
+            if( is_split() && is_zero_literal(type, item.m_value_res, params) ) {
+                emit_ctype(type, FMT_CB(ss, ss << Trans_Mangle(p);));
+                m_of << ";";
+                m_of << "\t// static " << p << " : " << type;
+                m_of << "\n";
+            }
+            else if (!is_zero_literal(type, item.m_value_res, params)) {
                 emit_ctype(type, FMT_CB(ss, ss << Trans_Mangle(p);));
                 m_of << " = ";
                 emit_literal(type, item.m_value_res, params);
@@ -2606,7 +2794,7 @@ namespace {
             }
             if( is_extern_def )
             {
-                m_of << "static ";
+                emit_local_linkage();
             }
             emit_function_header(p, item, params);
             m_of << ";\n";
@@ -2616,6 +2804,27 @@ namespace {
         void emit_function_code(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params, bool is_extern_def, const ::MIR::FunctionPointer& code) override
         {
             TRACE_FUNCTION_F(p);
+            CodegenUnit* unit = nullptr;
+            if( is_split() )
+            {
+                // Place in the unit with the least code so far (deterministic, as it only depends on the emitted code)
+                size_t idx = 0;
+                for(size_t i = 1; i < m_units.size(); i ++)
+                {
+                    if( m_units[i]->size < m_units[idx]->size )
+                        idx = i;
+                }
+                unit = m_units[idx].get();
+                switch_to_unit(idx);
+            }
+            emit_function_code_inner(p, item, params, is_extern_def, code);
+            if( unit )
+            {
+                unit->size = unit->buf.pubseekoff(0, ::std::ios::cur, ::std::ios::out);
+            }
+        }
+        void emit_function_code_inner(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params, bool is_extern_def, const ::MIR::FunctionPointer& code)
+        {
 
             ::MIR::TypeResolve::args_t  arg_types;
             for(const auto& ent : item.m_args)
@@ -2629,7 +2838,7 @@ namespace {
 
             m_of << "// " << p << "\n";
             if( is_extern_def ) {
-                m_of << "static ";
+                emit_local_linkage();
             }
             emit_function_header(p, item, params);
             m_of << "\n";
@@ -4454,6 +4663,17 @@ namespace {
             }
         }
 
+        /// Linkage for functions that are only visible within this crate
+        void emit_local_linkage()
+        {
+            // Split units need to see each other's functions, so they're hidden (and made local after the units are combined)
+            if( is_split() ) {
+                m_of << "__attribute__((visibility(\"hidden\"))) ";
+            }
+            else {
+                m_of << "static ";
+            }
+        }
         void emit_function_header(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params)
         {
             ::HIR::TypeRef  tmp;
@@ -6633,7 +6853,7 @@ namespace {
     Span CodeGenerator_C::sp;
 }
 
-::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile)
+::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile, const TransOptions& opt)
 {
-    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_C(crate, outfile));
+    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_C(crate, outfile, opt));
 }
@@ -22,14 +22,16 @@ namespace {
     struct EnumState
     {
         const ::HIR::Crate& crate;
+        bool    use_shared_generics;
         TransList   rv;
 
         // Queue of items to enumerate
         ::std::deque<TransList_Function*>  fcn_queue;
         ::std::vector<TransList_Function*> fcns_to_type_visit;
 
-        EnumState(const ::HIR::Crate& crate):
-            crate(crate)
+        EnumState(const ::HIR::Crate& crate, bool use_shared_generics):
+            crate(crate),
+            use_shared_generics(use_shared_generics)
         {}
 
         void enum_fcn(::HIR::Path p, const ::HIR::Function& fcn, Trans_Params pp)
@@ -39,9 +41,30 @@ namespace {
                 fcns_to_type_visit.push_back(e);
                 e->ptr = &fcn;
                 e->pp = mv$(pp);
-                fcn_queue.push_back(e);
+                e->is_shared = is_shared_upstream(*e->path);
+                // Shared functions are only declared, so there's no need to visit the body
+                if( !e->is_shared )
+                {
+                    fcn_queue.push_back(e);
+                }
             }
         }
+
+        /// Check if an upstream crate recorded that it emitted this monomorphisation
+        bool is_shared_upstream(const ::HIR::Path& p) const
+        {
+            if( !use_shared_generics )
+                return false;
+            for(const auto& ext : crate.m_ext_crates)
+            {
+                if( ext.second.m_data->m_shared_monomorphs.count(p) )
+                {
+                    DEBUG("Shared by " << ext.first << " - " << p);
+                    return true;
+                }
+            }
+            return false;
+        }
     };
 }
 
@@ -100,11 +123,11 @@ namespace MIR {
 
 
 /// Enumerate trans items starting from `::main` (binary crate)
-TransList Trans_Enumerate_Main(const ::HIR::Crate& crate)
+TransList Trans_Enumerate_Main(const ::HIR::Crate& crate, bool use_shared_generics)
 {
     static Span sp;
 
-    EnumState   state { crate };
+    EnumState   state { crate, use_shared_generics };
 
     auto c_start_path = crate.get_lang_item_path_opt("mrustc-start");
     if( c_start_path == ::HIR::SimplePath() )
@@ -284,10 +307,10 @@ namespace {
 }
 
 /// Enumerate trans items for all public non-generic items (library crate)
-TransList Trans_Enumerate_Public(::HIR::Crate& crate)
+TransList Trans_Enumerate_Public(::HIR::Crate& crate, bool use_shared_generics)
 {
     static Span sp;
-    EnumState   state { crate };
+    EnumState   state { crate, use_shared_generics };
 
     Trans_Enumerate_Public_Mod(state, crate.m_root_module,  ::HIR::SimplePath(crate.m_crate_name,{}), true);
 
@@ -303,9 +326,12 @@ TransList Trans_Enumerate_Public(::HIR::Crate& crate)
                 Trans_Enumerate_Public_TraitImpl(state, resolve, trait_path, *impl);
             }
         }
-        for(auto& impl : impl_group.second.non_named)
+        for(auto& impl_list : impl_group.second.non_named)
         {
-            Trans_Enumerate_Public_TraitImpl(state, resolve, trait_path, *impl);
+            for(auto& impl : impl_list.second)
+            {
+                Trans_Enumerate_Public_TraitImpl(state, resolve, trait_path, *impl);
+            }
         }
         for(auto& impl : impl_group.second.generic)
         {
@@ -349,9 +375,12 @@ TransList Trans_Enumerate_Public(::HIR::Crate& crate)
             H1::enumerate_type_impl(state, *impl);
         }
     }
-    for(auto& impl : crate.m_type_impls.non_named)
+    for(auto& impl_grp : crate.m_type_impls.non_named)
     {
-        H1::enumerate_type_impl(state, *impl);
+        for(auto& impl : impl_grp.second)
+        {
+            H1::enumerate_type_impl(state, *impl);
+        }
     }
     for(auto& impl : crate.m_type_impls.generic)
     {
@@ -429,7 +458,7 @@ void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list)
     // NOTE: Disabled, as full filtering is nigh-on impossible
     // - Could do partial filtering of unused locally generated versions of trait impls and inlines
 #if 0
-    EnumState   state { crate };
+    EnumState   state { crate, false };
 
 
     // Visit every function used and determine the items it uses
@@ -494,6 +523,24 @@ void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list)
 #endif
 }
 
+void Trans_Enumerate_RecordShared(::HIR::Crate& crate, const TransList& list)
+{
+    crate.m_shared_monomorphs.clear();
+    for(const auto& ent : list.m_functions)
+    {
+        const auto& fcn = *ent.second->ptr;
+        // Only functions from this crate are emitted with external linkage (extern ones get a local copy)
+        if( !fcn.m_code || !fcn.m_code.m_mir )
+            continue ;
+        bool is_method = ( fcn.m_args.size() > 0 && visit_ty_with(fcn.m_args[0].second, [&](const auto& x){return x == ::HIR::TypeRef("Self",0xFFFF);}) );
+        if( ent.second->pp.has_types() || is_method )
+        {
+            DEBUG("Shared " << ent.first);
+            crate.m_shared_monomorphs.insert( ent.first.clone() );
+        }
+    }
+}
+
 /// Common post-processing
 void Trans_Enumerate_CommonPost_Run(EnumState& state)
 {
@@ -747,7 +794,7 @@ namespace
             DEBUG("Add type " << ty << (shallow ? " (Shallow)": ""));
         }
 
-        void __attribute__ ((noinline)) visit_function(const ::HIR::Path& path, const ::HIR::Function& fcn, const Trans_Params& pp)
+        void __attribute__ ((noinline)) visit_function(const ::HIR::Path& path, const ::HIR::Function& fcn, const Trans_Params& pp, bool signature_only)
         {
             Span    sp;
             auto& tv = *this;
@@ -782,7 +829,7 @@ namespace
             for(const auto& arg : fcn.m_args)
                 tv.visit_type( monomorph(arg.second) );
 
-            if( fcn.m_code.m_mir )
+            if( fcn.m_code.m_mir && !signature_only )
             {
                 const auto& mir = *fcn.m_code.m_mir;
                 for(const auto& ty : mir.locals)
@@ -1021,12 +1068,12 @@ void Trans_Enumerate_Types(EnumState& state)
             const auto& pp = p->pp;
 
             TRACE_FUNCTION_F("Function " << fcn_path);
-            tv.visit_function(fcn_path, fcn, pp);
+            tv.visit_function(fcn_path, fcn, pp, /*signature_only=*/p->is_shared);
         }
         state.fcns_to_type_visit.clear();
         // TODO: Similarly restrict revisiting of statics.
         // - Challenging, as they're stored as a std::map
-        for(const auto& ent : state.rv.m_statics)
+        for(const auto& ent : TransList_SortedEntries(state.rv.m_statics))
         {
             TRACE_FUNCTION_F("Enumerate static " << ent.first);
             assert(ent.second->ptr);
@@ -1035,7 +1082,7 @@ void Trans_Enumerate_Types(EnumState& state)
 
             tv.visit_type( pp.monomorph(tv.m_resolve, stat.m_type) );
         }
-        for(const auto& ent : state.rv.m_vtables)
+        for(const auto& ent : TransList_SortedEntries(state.rv.m_vtables))
         {
             TRACE_FUNCTION_F("vtable " << ent.first);
             const auto& gpath = ent.first.m_data.as_UfcsKnown().trait;
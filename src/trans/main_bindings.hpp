@@ -19,6 +19,8 @@ struct TransOptions
     unsigned int opt_level = 0;
     bool emit_debug_info = false;
     ::std::string   build_command_file;
+    /// Number of C files to split the generated code across (compiled in parallel)
+    unsigned int codegen_units = 1;
 
     ::std::vector< ::std::string>   library_search_dirs;
     ::std::vector< ::std::string>   libraries;
@@ -31,15 +33,20 @@ enum class CodegenOutput {
     Executable, // no suffix, includes main stub (TODO: Can't that just be added earlier?)
 };
 
-extern TransList Trans_Enumerate_Main(const ::HIR::Crate& crate);
+// NOTE: If `use_shared_generics` is set, monomorphisations listed by upstream crates are declared instead of re-generated
+extern TransList Trans_Enumerate_Main(const ::HIR::Crate& crate, bool use_shared_generics);
 // NOTE: This also sets the saveout flags
-extern TransList Trans_Enumerate_Public(::HIR::Crate& crate);
+extern TransList Trans_Enumerate_Public(::HIR::Crate& crate, bool use_shared_generics);
 
 /// Re-run enumeration on monomorphised functions, removing now-unused items
 extern void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list);
+/// Record the monomorphised functions this crate emits (with external linkage) in the crate metadata
+extern void Trans_Enumerate_RecordShared(::HIR::Crate& crate, const TransList& list);
 
 extern void Trans_AutoImpls(::HIR::Crate& crate, TransList& trans_list);
 
 extern void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list);
 
+/// The C compiler command the C backend invokes for the current target
+extern ::std::string Trans_GetCCompiler();
 extern void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const TransOptions& opt, const ::HIR::Crate& crate, const TransList& list, const ::std::string& hir_file);
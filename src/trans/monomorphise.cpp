@@ -332,9 +332,12 @@ namespace {
 void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list)
 {
     ::StaticTraitResolve    resolve { crate };
-    for(auto& fcn_ent : list.m_functions)
+    for(const auto& fcn_ent : TransList_SortedEntries(list.m_functions))
     {
         const auto& fcn = *fcn_ent.second->ptr;
+        // Already emitted by an upstream crate
+        if( fcn_ent.second->is_shared )
+            continue ;
         // Trait methods (which are the only case where `Self` can exist in the argument list at this stage) always need to be monomorphised.
         bool is_method = ( fcn.m_args.size() > 0 && visit_ty_with(fcn.m_args[0].second, [&](const auto& x){return x == ::HIR::TypeRef("Self",0xFFFF);}) );
         if(fcn_ent.second->pp.has_types() || is_method)
@@ -367,7 +370,8 @@ void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list)
 
     // Also do constants and statics (stored in where?)
     // - NOTE: Done in reverse order, because consteval needs used constants to be evaluated
-    for(auto& ent : reverse(list.m_constants))
+    auto constants = TransList_SortedEntries(list.m_constants);
+    for(const auto& ent : reverse(constants))
     {
         const auto& path = ent.first;
         const auto& pp = ent.second->pp;
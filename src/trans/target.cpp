@@ -10,6 +10,8 @@
 #include "../expand/cfg.hpp"
 #include <fstream>
 #include <map>
+#include <unordered_map>
+#include <mutex>
 #include <hir/hir.hpp>
 #include <hir_typeck/helpers.hpp>
 #include <toml.h>   // tools/common
@@ -1287,17 +1289,24 @@ namespace {
 }
 const TypeRepr* Target_GetTypeRepr(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ty)
 {
-    // TODO: Thread safety
     // Map of generic types to type representations.
-    static ::std::map<::HIR::TypeRef, ::std::unique_ptr<TypeRepr>>  s_cache;
+    static ::std::unordered_map<::HIR::TypeRef, ::std::unique_ptr<TypeRepr>>  s_cache;
+    // NOTE: The lock isn't held while calculating the repr (as that recurses), so two threads may race to calculate
+    // the same type. The loser's result is discarded.
+    static ::std::mutex s_cache_lock;
 
-    auto it = s_cache.find(ty);
-    if( it != s_cache.end() )
     {
-        return it->second.get();
+        ::std::lock_guard<::std::mutex> lh(s_cache_lock);
+        auto it = s_cache.find(ty);
+        if( it != s_cache.end() )
+        {
+            return it->second.get();
+        }
     }
 
-    auto ires = s_cache.insert(::std::make_pair( ty.clone(), make_type_repr(sp, resolve, ty) ));
+    auto repr = make_type_repr(sp, resolve, ty);
+    ::std::lock_guard<::std::mutex> lh(s_cache_lock);
+    auto ires = s_cache.insert(::std::make_pair( ty.clone(), mv$(repr) ));
     return ires.first->second.get();
 }
 const ::HIR::TypeRef& Target_GetInnerType(const Span& sp, const StaticTraitResolve& resolve, const TypeRepr& repr, size_t idx, const ::std::vector<size_t>& sub_fields, size_t ofs)
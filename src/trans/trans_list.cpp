@@ -54,6 +54,12 @@ TransList_Const* TransList::add_const(::HIR::Path p)
     }
 }
 
+void Trans_Params::expand_and_intern(const ::StaticTraitResolve& resolve, ::HIR::TypeRef& ty) const
+{
+    resolve.expand_associated_types(sp, ty);
+    ty = ty.intern();
+}
+
 ::HIR::Path Trans_Params::monomorph(const ::StaticTraitResolve& resolve, const ::HIR::Path& p) const
 {
     TRACE_FUNCTION_F(p);
@@ -62,22 +68,22 @@ TransList_Const* TransList::add_const(::HIR::Path p)
     TU_MATCH_HDRA( (rv.m_data), {)
     TU_ARMA(Generic, e2) {
         for(auto& arg : e2.m_params.m_types)
-            resolve.expand_associated_types(sp, arg);
+            expand_and_intern(resolve, arg);
         }
     TU_ARMA(UfcsInherent, e2) {
-        resolve.expand_associated_types(sp, e2.type);
+        expand_and_intern(resolve, e2.type);
         for(auto& arg : e2.params.m_types)
-            resolve.expand_associated_types(sp, arg);
+            expand_and_intern(resolve, arg);
         // TODO: impl params too?
         for(auto& arg : e2.impl_params.m_types)
-            resolve.expand_associated_types(sp, arg);
+            expand_and_intern(resolve, arg);
         }
     TU_ARMA(UfcsKnown, e2) {
-        resolve.expand_associated_types(sp, e2.type);
+        expand_and_intern(resolve, e2.type);
         for(auto& arg : e2.trait.m_params.m_types)
-            resolve.expand_associated_types(sp, arg);
+            expand_and_intern(resolve, arg);
         for(auto& arg : e2.params.m_types)
-            resolve.expand_associated_types(sp, arg);
+            expand_and_intern(resolve, arg);
         }
     TU_ARMA(UfcsUnknown, e2) {
         BUG(sp, "Encountered UfcsUnknown");
@@ -95,11 +101,12 @@ TransList_Const* TransList::add_const(::HIR::Path p)
 {
     auto rv = this->monomorph_path_params(sp, p, false);
     for(auto& arg : rv.m_types)
-        resolve.expand_associated_types(sp, arg);
+        expand_and_intern(resolve, arg);
     return rv;
 }
 
 ::HIR::TypeRef Trans_Params::monomorph(const ::StaticTraitResolve& resolve, const ::HIR::TypeRef& ty) const
 {
-    return resolve.monomorph_expand(sp, ty, *this);
+    // Monomorphised types are fully resolved, so can be shared (if `-Z intern-types` is enabled)
+    return resolve.monomorph_expand(sp, ty, *this).intern();
 }
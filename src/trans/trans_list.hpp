@@ -10,6 +10,9 @@
 #include <hir/type.hpp>
 #include <hir/path.hpp>
 #include <hir_typeck/common.hpp>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 
 class StaticTraitResolve;
 namespace HIR {
@@ -43,6 +46,9 @@ struct Trans_Params:
     ::HIR::Path monomorph(const ::StaticTraitResolve& resolve, const ::HIR::Path& p) const;
     ::HIR::GenericPath monomorph(const ::StaticTraitResolve& resolve, const ::HIR::GenericPath& p) const;
     ::HIR::PathParams monomorph(const ::StaticTraitResolve& resolve, const ::HIR::PathParams& p) const;
+private:
+    void expand_and_intern(const ::StaticTraitResolve& resolve, ::HIR::TypeRef& ty) const;
+public:
 
     bool has_types() const {
         return pp_method.m_types.size() > 0 || pp_impl.m_types.size() > 0;
@@ -67,15 +73,18 @@ struct CachedFunction {
 };
 struct TransList_Function
 {
-    const ::HIR::Path*  path;   // Pointer into the list (std::map pointers are stable)
+    const ::HIR::Path*  path;   // Pointer into the list (std::unordered_map node pointers are stable)
     const ::HIR::Function*  ptr;
     Trans_Params    pp;
     // If `pp.has_types` is true, the below is valid
     CachedFunction  monomorphised;
+    /// This monomorphisation was already emitted by an upstream crate (see `-Z share-generics`), only declare it
+    bool    is_shared;
 
     TransList_Function(const ::HIR::Path& path):
         path(&path),
-        ptr(nullptr)
+        ptr(nullptr),
+        is_shared(false)
     {}
 };
 struct TransList_Static
@@ -89,6 +98,58 @@ struct TransList_Const
     Trans_Params    pp;
 };
 
+/// Key-ordered view of one of the hashed containers in `TransList`
+/// - Gives the same iteration order as the `std::map`/`std::set` these containers used to be
+template<typename T>
+class TransList_Sorted
+{
+    ::std::vector<const T*> m_ents;
+
+    template<typename K>
+    static const K& get_key(const K& k) { return k; }
+    template<typename K, typename V>
+    static const K& get_key(const ::std::pair<const K, V>& e) { return e.first; }
+public:
+    class iterator
+    {
+        typename ::std::vector<const T*>::const_iterator    m_it;
+    public:
+        typedef ::std::bidirectional_iterator_tag   iterator_category;
+        typedef T   value_type;
+        typedef ::std::ptrdiff_t    difference_type;
+        typedef const T*    pointer;
+        typedef const T&    reference;
+
+        iterator() {}
+        iterator(typename ::std::vector<const T*>::const_iterator it): m_it(it) {}
+        const T& operator*() const { return **m_it; }
+        const T* operator->() const { return *m_it; }
+        iterator& operator++() { ++m_it; return *this; }
+        iterator& operator--() { --m_it; return *this; }
+        bool operator==(const iterator& x) const { return m_it == x.m_it; }
+        bool operator!=(const iterator& x) const { return m_it != x.m_it; }
+    };
+    typedef ::std::reverse_iterator<iterator>   reverse_iterator;
+
+    template<typename C>
+    TransList_Sorted(const C& c)
+    {
+        m_ents.reserve(c.size());
+        for(const auto& e : c)
+            m_ents.push_back(&e);
+        ::std::sort(m_ents.begin(), m_ents.end(), [](const T* a, const T* b){ return get_key(*a) < get_key(*b); });
+    }
+
+    iterator begin() const { return iterator(m_ents.begin()); }
+    iterator end() const { return iterator(m_ents.end()); }
+    reverse_iterator rbegin() const { return reverse_iterator(end()); }
+    reverse_iterator rend() const { return reverse_iterator(begin()); }
+};
+template<typename C>
+TransList_Sorted<typename C::value_type> TransList_SortedEntries(const C& c) {
+    return TransList_Sorted<typename C::value_type>(c);
+}
+
 class TransList
 {
 public:
@@ -98,17 +159,19 @@ public:
     TransList& operator=(TransList&&) = default;
     TransList& operator=(const TransList&) = delete;
 
-    ::std::map< ::HIR::Path, ::std::unique_ptr<TransList_Function> > m_functions;
-    ::std::map< ::HIR::Path, ::std::unique_ptr<TransList_Static> > m_statics;
+    // NOTE: These are hashed for fast lookup, anything that depends on the iteration order (e.g. codegen) should
+    // iterate via `TransList_SortedEntries` to get a deterministic order.
+    ::std::unordered_map< ::HIR::Path, ::std::unique_ptr<TransList_Function> > m_functions;
+    ::std::unordered_map< ::HIR::Path, ::std::unique_ptr<TransList_Static> > m_statics;
     /// Constants that are still Defer
-    ::std::map< ::HIR::Path, ::std::unique_ptr<TransList_Const> > m_constants;
-    ::std::map< ::HIR::Path, Trans_Params> m_vtables;
+    ::std::unordered_map< ::HIR::Path, ::std::unique_ptr<TransList_Const> > m_constants;
+    ::std::unordered_map< ::HIR::Path, Trans_Params> m_vtables;
     /// Required type_id values
-    ::std::set< ::HIR::TypeRef> m_typeids;
+    ::std::unordered_set< ::HIR::TypeRef> m_typeids;
     /// Required struct/enum constructor impls
-    ::std::set< ::HIR::GenericPath> m_constructors;
+    ::std::unordered_set< ::HIR::GenericPath> m_constructors;
     // Automatic Clone impls
-    ::std::set< ::HIR::TypeRef>  auto_clone_impls;
+    ::std::unordered_set< ::HIR::TypeRef>  auto_clone_impls;
 
     // .second is `true` if this is a from a reference to the type
     ::std::vector< ::std::pair<::HIR::TypeRef, bool> >  m_types;
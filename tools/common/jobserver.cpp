@@ -0,0 +1,293 @@
+/*
+ * mrustc common code
+ * - by John Hodge (Mutabah)
+ *
+ * tools/common/jobserver.cpp
+ * - GNU make jobserver protocol
+ *
+ * Tokens are single bytes in a pipe (or named fifo) on unix, and a named semaphore on windows. The pool location is
+ * passed to child processes in `MAKEFLAGS` as `--jobserver-auth=<R>,<W>` / `--jobserver-auth=fifo:<path>` (unix) or
+ * `--jobserver-auth=<semaphore name>` (windows).
+ */
+#if defined(__MINGW32__)
+# define DISABLE_MULTITHREAD    // Mingw32 doesn't have c++11 threads
+#endif
+#include "jobserver.h"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>   // sscanf
+#ifndef DISABLE_MULTITHREAD
+# include <mutex>
+#endif
+#ifdef _WIN32
+# include <Windows.h>
+#else
+# include <unistd.h>
+# include <fcntl.h>
+# include <poll.h>
+# include <cerrno>
+#endif
+
+namespace {
+    // Length of each wait for a token before re-checking the implicit token (released by another thread)
+    const unsigned WAIT_SLICE_MS = 50;
+
+    struct State
+    {
+        bool    active = false;
+#ifdef _WIN32
+        HANDLE  semaphore = NULL;
+#else
+        int     read_fd = -1;
+        int     write_fd = -1;
+#endif
+        // The token this process was started with
+        bool    implicit_used = false;
+        // Tokens taken from the pool (returned as they were read)
+        ::std::vector<char> held;
+#ifndef DISABLE_MULTITHREAD
+        ::std::mutex    mutex;
+#else
+        int mutex;
+#endif
+    } s_state;
+
+#ifndef DISABLE_MULTITHREAD
+    typedef ::std::lock_guard<::std::mutex>  state_lock_t;
+#else
+    struct state_lock_t {
+        state_lock_t(int) {}
+    };
+#endif
+
+    /// Get the value of the last `--jobserver-auth=` (or pre-4.2 `--jobserver-fds=`) option in MAKEFLAGS
+    ::std::string get_auth()
+    {
+        const char* makeflags = getenv("MAKEFLAGS");
+        if( !makeflags )
+            return "";
+        ::std::string   flags = makeflags;
+        for(const char* opt : { "--jobserver-auth=", "--jobserver-fds=" })
+        {
+            auto pos = flags.rfind(opt);
+            if( pos != ::std::string::npos )
+            {
+                auto start = pos + strlen(opt);
+                auto end = flags.find(' ', start);
+                return flags.substr(start, end == ::std::string::npos ? ::std::string::npos : end - start);
+            }
+        }
+        return "";
+    }
+
+    bool connect(const ::std::string& auth)
+    {
+#ifdef _WIN32
+        s_state.semaphore = OpenSemaphoreA(SEMAPHORE_MODIFY_STATE|SYNCHRONIZE, FALSE, auth.c_str());
+        if( s_state.semaphore == NULL )
+        {
+            ::std::cerr << "warning: Unable to open jobserver semaphore '" << auth << "', ignoring" << ::std::endl;
+            return false;
+        }
+#else
+        if( auth.compare(0, 5, "fifo:") == 0 )
+        {
+            auto path = auth.substr(5);
+            s_state.read_fd = open(path.c_str(), O_RDONLY|O_NONBLOCK|O_CLOEXEC);
+            s_state.write_fd = open(path.c_str(), O_WRONLY|O_CLOEXEC);
+            if( s_state.read_fd < 0 || s_state.write_fd < 0 )
+            {
+                ::std::cerr << "warning: Unable to open jobserver fifo '" << path << "', ignoring" << ::std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            int read_fd, write_fd;
+            char    c;
+            if( sscanf(auth.c_str(), "%d,%d%c", &read_fd, &write_fd, &c) != 2 )
+            {
+                return false;
+            }
+            // NOTE: make closes the pipe for commands it doesn't know are recursive (i.e. not marked with `+`)
+            if( read_fd < 0 || write_fd < 0 || fcntl(read_fd, F_GETFD) == -1 || fcntl(write_fd, F_GETFD) == -1 )
+            {
+                return false;
+            }
+            s_state.read_fd = read_fd;
+            s_state.write_fd = write_fd;
+# ifdef __linux__
+            // Re-open the read end so it can be non-blocking (the inherited one is shared with every other process)
+            ::std::stringstream ss;
+            ss << "/proc/self/fd/" << read_fd;
+            int fd = open(ss.str().c_str(), O_RDONLY|O_NONBLOCK|O_CLOEXEC);
+            if( fd >= 0 )
+            {
+                s_state.read_fd = fd;
+            }
+# endif
+        }
+#endif
+        s_state.active = true;
+        return true;
+    }
+
+    /// Attempt to take a token from the pool, waiting for at most `timeout_ms`
+    bool read_token(char* out, unsigned timeout_ms)
+    {
+#ifdef _WIN32
+        switch( WaitForSingleObject(s_state.semaphore, timeout_ms) )
+        {
+        case WAIT_OBJECT_0:
+            *out = '+';
+            return true;
+        case WAIT_TIMEOUT:
+            return false;
+        default:
+            break;
+        }
+#else
+        struct pollfd   pfd;
+        pfd.fd = s_state.read_fd;
+        pfd.events = POLLIN;
+        int rv = poll(&pfd, 1, static_cast<int>(timeout_ms));
+        if( rv == 0 || (rv < 0 && errno == EINTR) )
+            return false;
+        if( rv > 0 )
+        {
+            // NOTE: If the read end is shared (and blocking), another process may take the token first and this will
+            // block until the next one is available.
+            auto n = read(s_state.read_fd, out, 1);
+            if( n == 1 )
+                return true;
+            if( n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) )
+                return false;
+        }
+#endif
+        // The pool has gone away, stop using it
+        ::std::cerr << "warning: Lost connection to the jobserver, ignoring job limit" << ::std::endl;
+        s_state.active = false;
+        return false;
+    }
+    void write_token(char c)
+    {
+#ifdef _WIN32
+        (void)c;
+        ReleaseSemaphore(s_state.semaphore, 1, NULL);
+#else
+        while( write(s_state.write_fd, &c, 1) < 0 && errno == EINTR )
+            ;
+#endif
+    }
+}
+
+bool Jobserver_InitClient()
+{
+    if( s_state.active )
+        return true;
+    auto auth = get_auth();
+    if( auth == "" )
+        return false;
+    return connect(auth);
+}
+
+void Jobserver_InitServer(unsigned num_jobs)
+{
+    if( Jobserver_InitClient() )
+        return ;
+    // A single job doesn't need coordinating
+    if( num_jobs <= 1 )
+        return ;
+
+    ::std::stringstream flags;
+    if( const char* makeflags = getenv("MAKEFLAGS") )
+        flags << makeflags;
+    flags << " -j" << num_jobs << " --jobserver-auth=";
+#ifdef _WIN32
+    ::std::stringstream name;
+    name << "mrustc_jobserver_" << GetCurrentProcessId();
+    s_state.semaphore = CreateSemaphoreA(NULL, num_jobs - 1, num_jobs - 1, name.str().c_str());
+    if( s_state.semaphore == NULL )
+    {
+        ::std::cerr << "warning: Unable to create jobserver semaphore" << ::std::endl;
+        return ;
+    }
+    flags << name.str();
+    _putenv_s("MAKEFLAGS", flags.str().c_str());
+#else
+    // NOTE: Both ends are left inheritable, so child processes can use them
+    int fds[2];
+    if( pipe(fds) != 0 )
+    {
+        ::std::cerr << "warning: Unable to create jobserver pipe" << ::std::endl;
+        return ;
+    }
+    s_state.read_fd = fds[0];
+    s_state.write_fd = fds[1];
+    // The jobs beyond this process's own token
+    for(unsigned i = 1; i < num_jobs; i ++)
+        write_token('+');
+    flags << fds[0] << "," << fds[1];
+    setenv("MAKEFLAGS", flags.str().c_str(), 1);
+#endif
+    s_state.active = true;
+}
+
+bool Jobserver_IsActive()
+{
+    return s_state.active;
+}
+
+bool Jobserver_TryAcquire(unsigned timeout_ms)
+{
+    auto deadline = ::std::chrono::steady_clock::now() + ::std::chrono::milliseconds(timeout_ms);
+    for(;;)
+    {
+        {
+            state_lock_t    lh { s_state.mutex };
+            if( !s_state.active || !s_state.implicit_used )
+            {
+                s_state.implicit_used = true;
+                return true;
+            }
+        }
+
+        auto now = ::std::chrono::steady_clock::now();
+        auto remaining = now < deadline ? ::std::chrono::duration_cast<::std::chrono::milliseconds>(deadline - now).count() : 0;
+        char    c;
+        if( read_token(&c, static_cast<unsigned>(remaining < WAIT_SLICE_MS ? remaining : WAIT_SLICE_MS)) )
+        {
+            state_lock_t    lh { s_state.mutex };
+            s_state.held.push_back(c);
+            return true;
+        }
+        if( ::std::chrono::steady_clock::now() >= deadline )
+            return false;
+    }
+}
+
+void Jobserver_Acquire()
+{
+    while( !Jobserver_TryAcquire(1000) )
+        ;
+}
+
+void Jobserver_Release()
+{
+    state_lock_t    lh { s_state.mutex };
+    // Return pool tokens first, so the implicit token is always the last one held
+    if( !s_state.held.empty() )
+    {
+        write_token(s_state.held.back());
+        s_state.held.pop_back();
+    }
+    else
+    {
+        s_state.implicit_used = false;
+    }
+}
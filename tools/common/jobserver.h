@@ -0,0 +1,44 @@
+/*
+ * mrustc common code
+ * - by John Hodge (Mutabah)
+ *
+ * tools/common/jobserver.h
+ * - GNU make jobserver protocol (shares a job limit between make, minicargo, mrustc, and the C compiler)
+ */
+#pragma once
+
+// Each process implicitly holds one job token (the one its parent acquired to start it), any further concurrent jobs
+// must each hold a token taken from the shared pool. Without a jobserver, all of these are no-ops.
+
+/// Connect to the jobserver advertised in `MAKEFLAGS`, returns false if there isn't a usable one
+extern bool Jobserver_InitClient();
+/// Connect to an existing jobserver, or create one with `num_jobs` tokens (advertised to child processes via `MAKEFLAGS`)
+extern void Jobserver_InitServer(unsigned num_jobs);
+extern bool Jobserver_IsActive();
+
+/// Acquire a job token, blocking until one is available
+extern void Jobserver_Acquire();
+/// Acquire a job token, giving up after `timeout_ms` milliseconds
+extern bool Jobserver_TryAcquire(unsigned timeout_ms);
+/// Return a token obtained from `Jobserver_Acquire`/`Jobserver_TryAcquire`
+extern void Jobserver_Release();
+
+/// Holds a job token for the lifetime of the object
+class JobserverToken
+{
+    bool    m_held;
+public:
+    JobserverToken():
+        m_held(Jobserver_IsActive())
+    {
+        if(m_held)
+            Jobserver_Acquire();
+    }
+    ~JobserverToken()
+    {
+        if(m_held)
+            Jobserver_Release();
+    }
+    JobserverToken(const JobserverToken&) = delete;
+    JobserverToken& operator=(const JobserverToken&) = delete;
+};
@@ -21,11 +21,16 @@ extern int _putenv_s(const char*, const char*);
 #include "build.h"
 #include "debug.h"
 #include "stringlist.h"
+#include "build_cache.h"
+#include <jobserver.h>
 #include <vector>
 #include <algorithm>
 #include <sstream>  // stringstream
 #include <fstream>  // ifstream
 #include <cstdlib>  // setenv
+#include <cstdio>   // remove
+#include <cstring>  // strcmp
+#include <cerrno>
 #ifndef DISABLE_MULTITHREAD
 # include <thread>
 # include <mutex>
@@ -34,6 +39,10 @@ extern int _putenv_s(const char*, const char*);
 #include <fstream>
 #include <climits>
 #include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <memory>
 #ifdef _WIN32
 # include <Windows.h>
 #else
@@ -68,17 +77,20 @@ class Builder
     ::helpers::path m_compiler_path;
     size_t m_total_targets;
     mutable size_t m_targets_built;
+    ::std::unique_ptr<BuildCache>   m_build_cache;
 
 public:
     Builder(const BuildOptions& opts, size_t total_targets);
 
-    bool build_target(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host, size_t index) const;
-    bool build_library(const PackageManifest& manifest, bool is_for_host, size_t index) const;
+    // If `out_is_rebuilt` is non-null, it's set when the compiler was invoked (i.e. the output wasn't up to date)
+    // If `on_metadata` is set (and the target is a rlib), it's called once the crate's `.hir` has been written
+    bool build_target(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host, size_t index, bool* out_is_rebuilt=nullptr, ::std::function<void()> on_metadata={}) const;
+    bool build_library(const PackageManifest& manifest, bool is_for_host, size_t index, bool* out_is_rebuilt=nullptr, ::std::function<void()> on_metadata={}) const;
     ::helpers::path build_build_script(const PackageManifest& manifest, bool is_for_host, bool* out_is_rebuilt) const;
 
 private:
     ::helpers::path get_crate_path(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host, const char** crate_type, ::std::string* out_crate_suffix) const;
-    bool spawn_process_mrustc(const StringList& args, StringListKV env, const ::helpers::path& logfile) const;
+    bool spawn_process_mrustc(const StringList& args, StringListKV env, const ::helpers::path& logfile, const ProcessMarker* marker=nullptr) const;
 
     ::helpers::path build_and_run_script(const PackageManifest& manifest, bool is_for_host) const;
 
@@ -122,6 +134,9 @@ public:
     bool operator==(const Timestamp& x) const {
         return m_val == x.m_val;
     }
+    bool operator!=(const Timestamp& x) const {
+        return m_val != x.m_val;
+    }
     bool operator<(const Timestamp& x) const {
         return m_val < x.m_val;
     }
@@ -274,6 +289,71 @@ BuildList::BuildList(const PackageManifest& manifest, const BuildOptions& opts):
         }
     }
 }
+namespace {
+    typedef ::std::chrono::steady_clock build_clock_t;
+
+    /// Check if the package's library is built as a rlib (dependents of which only need its metadata to compile)
+    bool library_is_rlib(const PackageManifest& p)
+    {
+        if( !p.has_library() )
+            return false;
+        const auto& lib = p.get_library();
+        if( lib.m_crate_types.empty() )
+            return !lib.m_is_proc_macro;
+        switch(lib.m_crate_types.front())
+        {
+        case PackageTarget::CrateType::rlib:
+            return true;
+        case PackageTarget::CrateType::dylib:
+            // NOTE: Matches `Builder::get_crate_path`, which only emits a dylib when requested
+            return getenv("MINICARGO_DYLIB") == nullptr;
+        default:
+            return false;
+        }
+    }
+
+    /// Build times recorded by previous runs, stored in the output directory
+    class BuildDurations
+    {
+        ::helpers::path m_path;
+        ::std::map<::std::string, double>   m_durations;
+    public:
+        BuildDurations(::helpers::path path):
+            m_path(::std::move(path))
+        {
+            ::std::ifstream ifp(m_path);
+            double  secs;
+            ::std::string   key;
+            // Each line is `<seconds> <package key>`
+            while( ifp >> secs && ::std::getline(ifp >> ::std::ws, key) )
+            {
+                m_durations[key] = secs;
+            }
+        }
+
+        const double* get(const ::std::string& key) const {
+            auto it = m_durations.find(key);
+            return it != m_durations.end() ? &it->second : nullptr;
+        }
+        void set(const ::std::string& key, double secs) {
+            m_durations[key] = secs;
+        }
+        void save() const {
+            ::std::ofstream ofp(m_path);
+            if( !ofp.good() )
+            {
+                DEBUG("Unable to write build durations to " << m_path);
+                return ;
+            }
+            ofp << ::std::fixed << ::std::setprecision(3);
+            for(const auto& e : m_durations)
+            {
+                ofp << e.second << " " << e.first << "\n";
+            }
+        }
+    };
+}
+
 bool BuildList::build(BuildOptions opts, unsigned num_jobs)
 {
     bool include_build = !opts.build_script_overrides.is_valid();
@@ -285,31 +365,112 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
         ::std::vector<unsigned> num_deps_remaining;
         ::std::vector<unsigned> build_queue;
 
+        // Pipelined builds: dependency edges (parallel to `Entry::dependents`) that are released once the metadata is written
+        ::std::vector<::std::vector<bool>>  pipelined;
+        ::std::vector<bool> metadata_released;
+        // A package is linkable once it and all of its dependencies have finished (binaries/build scripts need this)
+        ::std::vector<bool> own_complete;
+        ::std::vector<unsigned> num_deps_unlinkable;
+        // Length of the longest chain (in seconds) from each package to the end of the build
+        ::std::vector<double>   priority;
+
+        struct JobRecord {
+            bool    rebuilt = false;
+            unsigned thread = 0;
+            double  start = 0;
+            double  end = 0;
+        };
+        build_clock_t::time_point   start_time;
+        ::std::vector<JobRecord>    jobs;
+
+        double elapsed() const {
+            return ::std::chrono::duration<double>(build_clock_t::now() - this->start_time).count();
+        }
+
+        bool has_pipelined_dependents(unsigned index) const
+        {
+            const auto& p = this->pipelined[index];
+            return ::std::find(p.begin(), p.end(), true) != p.end();
+        }
+
+        // Called when the package's `.hir` has been written, starts dependents that only need the metadata
+        int metadata_ready(unsigned index, const ::std::vector<Entry>& list)
+        {
+            if( this->metadata_released[index] )
+                return 0;
+            this->metadata_released[index] = true;
+
+            int rv = 0;
+            for(size_t i = 0; i < list[index].dependents.size(); i ++)
+            {
+                if( this->pipelined[index][i] )
+                {
+                    this->release_dependency(list[index].dependents[i], list, rv);
+                }
+            }
+            return rv;
+        }
+
         int complete_package(unsigned index, const ::std::vector<Entry>& list)
         {
             int rv = 0;
             DEBUG("Completed " << list[index].package->name() << " (" << list[index].dependents.size() << " dependents)");
 
-            for(auto d : list[index].dependents)
+            // If the metadata marker wasn't seen (e.g. the package was already up to date), release the pipelined edges now
+            rv += this->metadata_ready(index, list);
+            this->own_complete[index] = true;
+            if( this->num_deps_unlinkable[index] == 0 )
             {
-                assert(this->num_deps_remaining[d] > 0);
-                this->num_deps_remaining[d] --;
-                DEBUG("- " << list[d].package->name() << " has " << this->num_deps_remaining[d] << " deps remaining");
-                if( this->num_deps_remaining[d] == 0 )
-                {
-                    rv ++;
-                    this->build_queue.push_back(d);
-                }
+                this->mark_linkable(index, list, rv);
             }
 
             return rv;
         }
 
-        unsigned get_next()
+    private:
+        void release_dependency(unsigned d, const ::std::vector<Entry>& list, int& rv)
+        {
+            assert(this->num_deps_remaining[d] > 0);
+            this->num_deps_remaining[d] --;
+            DEBUG("- " << list[d].package->name() << " has " << this->num_deps_remaining[d] << " deps remaining");
+            if( this->num_deps_remaining[d] == 0 )
+            {
+                rv ++;
+                this->build_queue.push_back(d);
+            }
+        }
+        // The package and everything it depends on has been built, so the remaining dependents can start
+        void mark_linkable(unsigned index, const ::std::vector<Entry>& list, int& rv)
+        {
+            for(size_t i = 0; i < list[index].dependents.size(); i ++)
+            {
+                auto d = list[index].dependents[i];
+                if( !this->pipelined[index][i] )
+                {
+                    this->release_dependency(d, list, rv);
+                }
+                assert(this->num_deps_unlinkable[d] > 0);
+                this->num_deps_unlinkable[d] --;
+                if( this->own_complete[d] && this->num_deps_unlinkable[d] == 0 )
+                {
+                    this->mark_linkable(d, list, rv);
+                }
+            }
+        }
+    public:
+
+        unsigned get_next(const ::std::vector<Entry>& list)
         {
             assert(!this->build_queue.empty());
-            unsigned rv = this->build_queue.back();
-            this->build_queue.pop_back();
+            // Start the package with the longest critical path first (ties go to the one unblocking the most packages)
+            auto it = ::std::max_element(this->build_queue.begin(), this->build_queue.end(), [&](unsigned a, unsigned b) {
+                if( this->priority[a] != this->priority[b] )
+                    return this->priority[a] < this->priority[b];
+                return list[a].dependents.size() < list[b].dependents.size();
+                });
+            unsigned rv = *it;
+            this->build_queue.erase(it);
+            DEBUG("Next: " << list[rv].package->name() << " (critical path " << this->priority[rv] << ")");
             return rv;
         }
     };
@@ -347,7 +508,83 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
         }
         DEBUG("Package '" << p.name() << "' has " << n_deps << " dependencies and " << m_list[idx].dependents.size() << " dependents");
         state.num_deps_remaining.push_back( n_deps );
+        state.num_deps_unlinkable.push_back( n_deps );
+    }
+    state.metadata_released.resize(m_list.size());
+    state.own_complete.resize(m_list.size());
+
+    // Pipelining: a rlib dependent can start compiling as soon as a rlib dependency's metadata is written
+    // - Build dependencies are excluded, as the build script executable links against them
+    // - Only enabled with multiple jobs (the single-job build has nothing to overlap with)
+    bool pipeline = opts.pipeline && num_jobs > 1;
+    state.pipelined.reserve(m_list.size());
+    for(const auto& e : m_list)
+    {
+        state.pipelined.push_back({});
+        for(auto d : e.dependents)
+        {
+            const auto& dp = *m_list[d].package;
+            bool is_build_dep = false;
+            if( dp.build_script() != "" && include_build )
+            {
+                for(const auto& dep : dp.build_dependencies())
+                {
+                    if( !dep.is_disabled() && &dep.get_package() == e.package )
+                        is_build_dep = true;
+                }
+            }
+            bool can_pipeline = pipeline && !is_build_dep && library_is_rlib(*e.package) && library_is_rlib(dp);
+            DEBUG(e.package->name() << " -> " << dp.name() << (can_pipeline ? " (pipelined)" : ""));
+            state.pipelined.back().push_back(can_pipeline);
+        }
+    }
+
+    // Determine the critical path through each package, using the time each package took in the previous build
+    // - Packages without a recorded time use the average of the known times (or unit weight if there's no history, which
+    //   prioritises the longest chains of dependents)
+    BuildDurations  durations { opts.output_dir / "minicargo_durations.txt" };
+    auto get_duration_key = [&](unsigned idx) {
+        const auto& e = m_list[idx];
+        return ::format(e.package->name(), " v", e.package->version(), (e.is_host && opts.target_name ? " (host)" : ""));
+        };
+    {
+        ::std::vector<const double*>    known;
+        double  known_total = 0;
+        size_t  known_count = 0;
+        for(unsigned i = 0; i < m_list.size(); i ++)
+        {
+            known.push_back( durations.get(get_duration_key(i)) );
+            if( known.back() )
+            {
+                known_total += *known.back();
+                known_count ++;
+            }
+        }
+        double default_weight = (known_count > 0 ? known_total / known_count : 1.0);
+
+        // NOTE: Dependents are always later in the list
+        state.priority.resize(m_list.size());
+        for(size_t i = m_list.size(); i --; )
+        {
+            double longest_tail = 0;
+            for(auto d : m_list[i].dependents)
+            {
+                longest_tail = ::std::max(longest_tail, state.priority[d]);
+            }
+            state.priority[i] = (known[i] ? *known[i] : default_weight) + longest_tail;
+        }
     }
+    state.jobs.resize(m_list.size());
+    state.start_time = build_clock_t::now();
+
+    // Build a single package on the current thread
+    auto build_one = [&](unsigned cur)->bool {
+        auto& rec = state.jobs[cur];
+        rec.start = state.elapsed();
+        bool rv = builder.build_library(*m_list[cur].package, m_list[cur].is_host, cur, &rec.rebuilt);
+        rec.end = state.elapsed();
+        return rv;
+        };
 
     // Actually do the build
     if( num_jobs > 1 )
@@ -422,15 +659,41 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
                         break;
                     }
 
+                    // Wait for a job token (the one this thread gets is passed on to mrustc, for its own use)
+                    JobserverToken  token;
+                    if( queue.failure )
+                    {
+                        DEBUG("Thread " << my_idx << ": Terminating");
+                        break;
+                    }
+
                     unsigned cur;
+                    ::std::function<void()> on_metadata;
                     {
                         ::std::lock_guard<::std::mutex> sl { queue.mutex };
-                        cur = queue.state.get_next();
+                        cur = queue.state.get_next(list);
                         queue.num_active ++;
+                        if( queue.state.has_pipelined_dependents(cur) )
+                        {
+                            on_metadata = [=,&queue,&list]() {
+                                ::std::lock_guard<::std::mutex> sl { queue.mutex };
+                                DEBUG("Thread " << my_idx << ": Metadata written for " << cur << " - " << list[cur].package->name());
+                                int v = queue.state.metadata_ready(cur, list);
+                                while(v--)
+                                {
+                                    queue.avaliable_tasks.notify();
+                                }
+                                };
+                        }
                     }
 
                     DEBUG("Thread " << my_idx << ": Starting " << cur << " - " << list[cur].package->name());
-                    if( ! builder->build_library(*list[cur].package, list[cur].is_host, cur) )
+                    BuildState::JobRecord   rec;
+                    rec.thread = my_idx;
+                    rec.start = queue.state.elapsed();
+                    bool ok = builder->build_library(*list[cur].package, list[cur].is_host, cur, &rec.rebuilt, ::std::move(on_metadata));
+                    rec.end = queue.state.elapsed();
+                    if( !ok )
                     {
                         queue.failure = true;
                         queue.signal_all();
@@ -438,6 +701,7 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
                     else
                     {
                         ::std::lock_guard<::std::mutex> sl { queue.mutex };
+                        queue.state.jobs[cur] = rec;
                         queue.num_active --;
                         int v = queue.state.complete_package(cur, list);
                         while(v--)
@@ -489,9 +753,9 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
 #else
         while( !state.build_queue.empty() )
         {
-            auto cur = state.get_next();
+            auto cur = state.get_next(m_list);
 
-            if( ! builder.build_library(*m_list[cur].package, m_list[cur].is_host, cur) )
+            if( ! build_one(cur) )
             {
                 return false;
             }
@@ -503,9 +767,9 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
     {
         while( !state.build_queue.empty() )
         {
-            auto cur = state.get_next();
+            auto cur = state.get_next(m_list);
 
-            if( ! builder.build_library(*m_list[cur].package, m_list[cur].is_host, cur) )
+            if( ! build_one(cur) )
             {
                 return false;
             }
@@ -549,6 +813,51 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs)
         }
     }
 
+    // Save the time taken by each rebuilt package (for scheduling the next build), and report how well the jobs were packed
+    {
+        ::std::vector<unsigned> rebuilt;
+        for(unsigned i = 0; i < m_list.size(); i ++)
+        {
+            const auto& rec = state.jobs[i];
+            if( rec.rebuilt )
+            {
+                durations.set(get_duration_key(i), rec.end - rec.start);
+                rebuilt.push_back(i);
+            }
+        }
+        if( !rebuilt.empty() )
+        {
+            durations.save();
+
+            ::std::sort(rebuilt.begin(), rebuilt.end(), [&](unsigned a, unsigned b){ return state.jobs[a].start < state.jobs[b].start; });
+            double  wall_start = state.jobs[rebuilt.front()].start;
+            double  wall_end = 0;
+            double  busy = 0;
+            for(auto i : rebuilt)
+            {
+                wall_end = ::std::max(wall_end, state.jobs[i].end);
+                busy += state.jobs[i].end - state.jobs[i].start;
+            }
+            unsigned n_threads = ::std::max(num_jobs, 1u);
+            double  available = (wall_end - wall_start) * n_threads;
+
+            auto flags = ::std::cout.flags();
+            ::std::cout << ::std::fixed << ::std::setprecision(1);
+            ::std::cout << "Build timeline (" << rebuilt.size() << " packages, " << n_threads << " jobs):" << ::std::endl;
+            for(auto i : rebuilt)
+            {
+                const auto& rec = state.jobs[i];
+                ::std::cout << "  " << ::std::setw(7) << (rec.start - wall_start) << "s - " << ::std::setw(7) << (rec.end - wall_start) << "s"
+                    << " [" << rec.thread << "] " << get_duration_key(i) << " (" << (rec.end - rec.start) << "s)"
+                    << ::std::endl;
+            }
+            ::std::cout << "Job utilisation: " << (available > 0 ? busy * 100 / available : 100.0) << "%"
+                << " (" << busy << "s busy of " << available << "s over " << (wall_end - wall_start) << "s)"
+                << ::std::endl;
+            ::std::cout.flags(flags);
+        }
+    }
+
     // Now that all libraries are done, build the binaries (if present)
     switch(opts.mode)
     {
@@ -573,6 +882,10 @@ Builder::Builder(const BuildOptions& opts, size_t total_targets):
     m_targets_built(0)
 {
     m_compiler_path = get_mrustc_path();
+    if( opts.build_cache_dir.is_valid() )
+    {
+        m_build_cache.reset(new BuildCache(opts.build_cache_dir, m_compiler_path, opts.target_name, opts.workspace_root, opts.output_dir));
+    }
 }
 
 ::helpers::path Builder::get_crate_path(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host, const char** crate_type, ::std::string* out_crate_suffix) const
@@ -741,7 +1054,7 @@ namespace {
     }
 }
 
-bool Builder::build_target(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host, size_t index) const
+bool Builder::build_target(const PackageManifest& manifest, const PackageTarget& target, bool is_for_host, size_t index, bool* out_is_rebuilt, ::std::function<void()> on_metadata) const
 {
     const char* crate_type;
     ::std::string   crate_suffix;
@@ -796,6 +1109,11 @@ bool Builder::build_target(const PackageManifest& manifest, const PackageTarget&
         }
     }
 
+    if( out_is_rebuilt )
+    {
+        *out_is_rebuilt = true;
+    }
+
     for(const auto& cmd : manifest.build_script_output().pre_build_commands)
     {
         // TODO: Run commands specified by build script (override)
@@ -945,7 +1263,55 @@ bool Builder::build_target(const PackageManifest& manifest, const PackageTarget&
     // TODO: If emitting command files (i.e. cross-compiling), concatenate the contents of `outfile + ".sh"` onto a
     // master file.
     // - Will probably want to do this as a final stage after building everything.
-    return this->spawn_process_mrustc(args, ::std::move(env), outfile + "_dbg.txt");
+
+    // Check the build cache (keyed on everything passed to mrustc, and the contents of the files it read last time)
+    // - Packages with build scripts are skipped, as files generated into OUT_DIR aren't listed in the depfile
+    ::std::string   cache_key;
+    bool use_cache = m_build_cache && manifest.build_script() == "";
+    if( use_cache )
+    {
+        cache_key = m_build_cache->invocation_key(args, env);
+        if( m_build_cache->restore(cache_key, outfile, depfile) )
+        {
+            {
+#ifndef DISABLE_MULTITHREAD
+                ::std::lock_guard<::std::mutex> lh { s_cout_mutex };
+#endif
+                ::std::cout << "RESTORED " << outfile << " from build cache" << ::std::endl;
+            }
+            if( out_is_rebuilt )
+            {
+                *out_is_rebuilt = false;
+            }
+            return true;
+        }
+    }
+
+    // Have mrustc signal when the metadata is complete, so dependents can start while codegen runs
+    ProcessMarker   metadata_marker;
+    if( on_metadata && target.m_type == PackageTarget::Type::Lib && ::std::strcmp(crate_type, "rlib") == 0 )
+    {
+        metadata_marker.path = outfile + ".meta";
+        metadata_marker.on_created = ::std::move(on_metadata);
+        // Remove any marker left by a previous build
+        ::std::remove(metadata_marker.path.str().c_str());
+        args.push_back("-C"); args.push_back(format("emit-metadata-marker=", metadata_marker.path));
+    }
+
+    if( !this->spawn_process_mrustc(args, ::std::move(env), outfile + "_dbg.txt", metadata_marker.on_created ? &metadata_marker : nullptr) )
+    {
+        return false;
+    }
+    if( use_cache )
+    {
+        auto depfile_ents = load_depfile(depfile);
+        auto it = depfile_ents.find(outfile);
+        if( it != depfile_ents.end() )
+        {
+            m_build_cache->store(cache_key, outfile, depfile, it->second);
+        }
+    }
+    return true;
 }
 ::helpers::path Builder::build_build_script(const PackageManifest& manifest, bool is_for_host, bool* out_is_rebuilt) const
 {
@@ -1112,7 +1478,7 @@ bool Builder::build_target(const PackageManifest& manifest, const PackageTarget&
 
     return out_file;
 }
-bool Builder::build_library(const PackageManifest& manifest, bool is_for_host, size_t index) const
+bool Builder::build_library(const PackageManifest& manifest, bool is_for_host, size_t index, bool* out_is_rebuilt, ::std::function<void()> on_metadata) const
 {
     if( manifest.build_script() != "" )
     {
@@ -1138,12 +1504,12 @@ bool Builder::build_library(const PackageManifest& manifest, bool is_for_host, s
         }
     }
 
-    return this->build_target(manifest, manifest.get_library(), is_for_host, index);
+    return this->build_target(manifest, manifest.get_library(), is_for_host, index, out_is_rebuilt, ::std::move(on_metadata));
 }
-bool Builder::spawn_process_mrustc(const StringList& args, StringListKV env, const ::helpers::path& logfile) const
+bool Builder::spawn_process_mrustc(const StringList& args, StringListKV env, const ::helpers::path& logfile, const ProcessMarker* marker/*=nullptr*/) const
 {
     //env.push_back("MRUSTC_DEBUG", "");
-    return spawn_process(m_compiler_path.str().c_str(), args, env, logfile);
+    return spawn_process(m_compiler_path.str().c_str(), args, env, logfile, {}, marker);
 }
 
 const helpers::path& get_mrustc_path()
@@ -1206,7 +1572,7 @@ const helpers::path& get_mrustc_path()
     return s_compiler_path;
 }
 
-bool spawn_process(const char* exe_name, const StringList& args, const StringListKV& env, const ::helpers::path& logfile, const ::helpers::path& working_directory/*={}*/)
+bool spawn_process(const char* exe_name, const StringList& args, const StringListKV& env, const ::helpers::path& logfile, const ::helpers::path& working_directory/*={}*/, const ProcessMarker* marker/*=nullptr*/)
 {
 #ifdef _WIN32
     ::std::stringstream cmdline;
@@ -1270,7 +1636,23 @@ bool spawn_process(const char* exe_name, const StringList& args, const StringLis
     PROCESS_INFORMATION pi = { 0 };
     CreateProcessA(exe_name, (LPSTR)cmdline_str.c_str(), NULL, NULL, TRUE, 0, NULL, (working_directory != ::helpers::path() ? working_directory.str().c_str() : NULL), &si, &pi);
     CloseHandle(si.hStdOutput);
-    WaitForSingleObject(pi.hProcess, INFINITE);
+    if( marker )
+    {
+        // Poll for the marker file while waiting for the process to exit
+        bool marker_seen = false;
+        while( WaitForSingleObject(pi.hProcess, 20) == WAIT_TIMEOUT )
+        {
+            if( !marker_seen && Timestamp::for_file(marker->path) != Timestamp::infinite_past() )
+            {
+                marker_seen = true;
+                marker->on_created();
+            }
+        }
+    }
+    else
+    {
+        WaitForSingleObject(pi.hProcess, INFINITE);
+    }
     DWORD status = 1;
     GetExitCodeProcess(pi.hProcess, &status);
     if (status != 0)
@@ -1353,7 +1735,27 @@ bool spawn_process(const char* exe_name, const StringList& args, const StringLis
     }
     posix_spawn_file_actions_destroy(&fa);
     int status = -1;
-    waitpid(pid, &status, 0);
+    // Poll for the marker file (if requested) while waiting for the process to exit
+    bool marker_seen = false;
+    for(;;)
+    {
+        auto rv = waitpid(pid, &status, marker ? WNOHANG : 0);
+        if( rv == pid )
+            break;
+        if( rv < 0 )
+        {
+            if( errno == EINTR )
+                continue;
+            ::std::cerr << "Unable to wait for process '" << exe_name << "' - " << strerror(errno) << ::std::endl;
+            return false;
+        }
+        if( !marker_seen && Timestamp::for_file(marker->path) != Timestamp::infinite_past() )
+        {
+            marker_seen = true;
+            marker->on_created();
+        }
+        usleep(20*1000);
+    }
     if( status != 0 )
     {
         if( WIFEXITED(status) )
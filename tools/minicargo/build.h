@@ -9,6 +9,7 @@
 
 #include "manifest.h"
 #include <path.h>
+#include <functional>
 
 class StringList;
 class StringListKV;
@@ -20,6 +21,12 @@ struct BuildOptions
     ::helpers::path build_script_overrides;
     ::std::vector<::helpers::path>  lib_search_dirs;
     bool emit_mmir = false;
+    // Start rlib dependents once the library's `.hir` is written, instead of waiting for codegen (only with multiple jobs)
+    bool pipeline = false;
+    // Directory of cached compiler outputs (if invalid, the cache isn't used)
+    ::helpers::path build_cache_dir;
+    // Root of the workspace (paths under it are stored relative to it in the build cache)
+    ::helpers::path workspace_root;
     const char* target_name = nullptr;  // if null, host is used
     enum class Mode {
         /// Build the binary/library
@@ -48,4 +55,11 @@ public:
 };
 
 extern const helpers::path& get_mrustc_path();
-extern bool spawn_process(const char* exe_name, const StringList& args, const StringListKV& env, const ::helpers::path& logfile, const ::helpers::path& working_directory={});
+/// File to watch for while a spawned process runs (e.g. the marker from `mrustc -C emit-metadata-marker`)
+struct ProcessMarker
+{
+    ::helpers::path path;
+    // Called (at most once) when `path` appears, while the process is still running
+    ::std::function<void()> on_created;
+};
+extern bool spawn_process(const char* exe_name, const StringList& args, const StringListKV& env, const ::helpers::path& logfile, const ::helpers::path& working_directory={}, const ProcessMarker* marker=nullptr);
@@ -0,0 +1,292 @@
+/*
+ * minicargo - MRustC-specific clone of `cargo`
+ * - By John Hodge (Mutabah)
+ *
+ * build_cache.cpp
+ * - Content-addressed cache of compiler outputs
+ */
+#include "build_cache.h"
+#include "build.h"  // spawn_process
+#include "stringlist.h"
+#include "debug.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+#include <cstdio>   // remove
+#ifdef _WIN32
+# include <Windows.h>
+#else
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <unistd.h>    // getpid
+#endif
+
+namespace {
+    /// 64-bit FNV-1a
+    class Hasher
+    {
+        uint64_t    m_state = 0xcbf29ce484222325ull;
+    public:
+        void add(const void* data, size_t len)
+        {
+            const auto* p = static_cast<const uint8_t*>(data);
+            for(size_t i = 0; i < len; i ++)
+            {
+                m_state ^= p[i];
+                m_state *= 0x100000001b3ull;
+            }
+        }
+        // Adds a string followed by a terminator (so `"ab","c"` and `"a","bc"` differ)
+        void add_str(const char* s)
+        {
+            this->add(s, ::std::char_traits<char>::length(s) + 1);
+        }
+
+        ::std::string hex() const
+        {
+            ::std::stringstream ss;
+            ss << ::std::hex << ::std::setw(16) << ::std::setfill('0') << m_state;
+            return ss.str();
+        }
+    };
+
+    // Returns an empty string if the file can't be read
+    ::std::string hash_file(const ::helpers::path& p)
+    {
+        ::std::ifstream ifp(p.str(), ::std::ios::binary);
+        if( !ifp.good() )
+            return "";
+        Hasher  h;
+        char    buf[64*1024];
+        while( ifp.read(buf, sizeof(buf)) || ifp.gcount() > 0 )
+        {
+            h.add(buf, static_cast<size_t>(ifp.gcount()));
+        }
+        return h.hex();
+    }
+
+    void make_dir(const ::helpers::path& p)
+    {
+#ifdef _WIN32
+        CreateDirectoryA(p.str().c_str(), NULL);
+#else
+        mkdir(p.str().c_str(), 0755);
+#endif
+    }
+
+    bool file_exists(const ::helpers::path& p)
+    {
+        return ::std::ifstream(p.str()).good();
+    }
+
+    // Copy a file, keeping the permission bits (so cached executables stay executable)
+    bool copy_file(const ::helpers::path& src, const ::helpers::path& dst)
+    {
+        ::std::ifstream ifp(src.str(), ::std::ios::binary);
+        if( !ifp.good() )
+            return false;
+        {
+            ::std::ofstream ofp(dst.str(), ::std::ios::binary | ::std::ios::trunc);
+            if( !ofp.good() )
+                return false;
+            // NOTE: Not using `<< rdbuf()`, as that fails on empty files (e.g. the `.rlib` stamp)
+            char    buf[64*1024];
+            while( ifp.read(buf, sizeof(buf)) || ifp.gcount() > 0 )
+            {
+                ofp.write(buf, ifp.gcount());
+            }
+            if( !ofp.good() )
+                return false;
+        }
+#ifndef _WIN32
+        struct stat s;
+        if( stat(src.str().c_str(), &s) == 0 )
+        {
+            chmod(dst.str().c_str(), s.st_mode & 07777);
+        }
+#endif
+        return true;
+    }
+
+    ::std::string read_file(const ::helpers::path& p)
+    {
+        ::std::ifstream ifp(p.str(), ::std::ios::binary);
+        ::std::string   rv;
+        char    buf[4096];
+        while( ifp.read(buf, sizeof(buf)) || ifp.gcount() > 0 )
+        {
+            rv.append(buf, static_cast<size_t>(ifp.gcount()));
+        }
+        return rv;
+    }
+
+    // Run a command and return its output (empty if it couldn't be run), `tmp_file` is used to capture the output
+    ::std::string run_and_capture(const char* exe, const StringList& args, const ::helpers::path& tmp_file)
+    {
+        ::std::string   rv;
+        if( spawn_process(exe, args, StringListKV(), tmp_file) )
+        {
+            rv = read_file(tmp_file);
+        }
+        ::std::remove(tmp_file.str().c_str());
+        return rv;
+    }
+
+    // Extra files produced alongside the main output (the metadata, and the object for rlibs)
+    const char* const OUTPUT_SUFFIXES[] = { ".hir", ".o" };
+}
+
+BuildCache::BuildCache(::helpers::path dir, const ::helpers::path& compiler_path, const char* target_name, const ::helpers::path& workspace_root, const ::helpers::path& output_dir):
+    m_dir(::std::move(dir))
+{
+    make_dir(m_dir);
+
+#ifdef _WIN32
+    auto tmp_prefix = format(".tmp_", GetCurrentProcessId());
+#else
+    auto tmp_prefix = format(".tmp_", getpid());
+#endif
+
+    // The C compiler is picked by mrustc (from the target and environment), and it produces the cached objects
+    ::std::string   c_compiler;
+    {
+        StringList  args;
+        if( target_name )
+        {
+            args.push_back("--target");
+            args.push_back(target_name);
+        }
+        args.push_back("-Z");
+        args.push_back("print-c-compiler");
+        ::std::stringstream ss( run_and_capture(compiler_path.str().c_str(), args, m_dir / (tmp_prefix + "_cc.txt").c_str()) );
+        ::std::string   line;
+        while( ::std::getline(ss, line) )
+        {
+            if( line.compare(0, 11, "c-compiler=") == 0 )
+                c_compiler = line.substr(11);
+        }
+    }
+    ::std::string   c_compiler_version;
+#ifndef _WIN32
+    if( c_compiler != "" )
+    {
+        // NOTE: Via the shell, as the compiler can be a command line (e.g. `CC="ccache gcc"`) and is looked up in PATH
+        StringList  args;
+        args.push_back("-c");
+        args.push_back(c_compiler + " --version");
+        c_compiler_version = run_and_capture("/bin/sh", args, m_dir / (tmp_prefix + "_ccver.txt").c_str());
+    }
+#endif
+
+    Hasher  h;
+    h.add_str(hash_file(compiler_path).c_str());
+    h.add_str(c_compiler.c_str());
+    h.add_str(c_compiler_version.c_str());
+    // Outputs record absolute paths (e.g. each dependency's path in the `.hir`, used to load transitive dependencies),
+    // so entries are only valid for the output directory and workspace they were built in
+    h.add_str(output_dir.to_absolute().normalise().str().c_str());
+    h.add_str(workspace_root.to_absolute().normalise().str().c_str());
+    m_base_hash = h.hex();
+    DEBUG("Build cache " << m_dir << ", C compiler `" << c_compiler << "`, base hash " << m_base_hash);
+}
+
+::std::string BuildCache::invocation_key(const StringList& args, const StringListKV& env) const
+{
+    Hasher  h;
+    h.add_str(m_base_hash.c_str());
+    for(const auto* a : args.get_vec())
+    {
+        h.add_str(a);
+    }
+    h.add_str("");
+    for(auto kv : env)
+    {
+        h.add_str(kv.first);
+        h.add_str(kv.second);
+    }
+    return h.hex();
+}
+
+bool BuildCache::restore(const ::std::string& key, const ::helpers::path& outfile, const ::helpers::path& depfile) const
+{
+    auto entry_dir = m_dir / key.c_str();
+    ::std::ifstream ifp( (entry_dir / "inputs.txt").str() );
+    if( !ifp.good() )
+    {
+        DEBUG("Cache miss for " << outfile << " - no entry " << key);
+        return false;
+    }
+
+    // Each line is `<hash> <path>`
+    ::std::string   hash, path;
+    while( ifp >> hash && ::std::getline(ifp >> ::std::ws, path) )
+    {
+        auto cur_hash = hash_file(path);
+        if( cur_hash != hash )
+        {
+            DEBUG("Cache miss for " << outfile << " - " << path << " changed (" << hash << " != " << cur_hash << ")");
+            return false;
+        }
+    }
+
+    // The output directory is usually created when mrustc is spawned
+    make_dir(outfile.parent());
+    for(const auto* sfx : OUTPUT_SUFFIXES)
+    {
+        auto src = entry_dir / (::std::string("output") + sfx).c_str();
+        if( file_exists(src) && !copy_file(src, outfile + sfx) )
+            return false;
+    }
+    if( !copy_file(entry_dir / "output.d", depfile) )
+        return false;
+    // NOTE: The main output is restored last, as its timestamp is what's checked by the next build
+    if( !copy_file(entry_dir / "output", outfile) )
+        return false;
+    DEBUG("Restored " << outfile << " from cache entry " << key);
+    return true;
+}
+
+void BuildCache::store(const ::std::string& key, const ::helpers::path& outfile, const ::helpers::path& depfile, const ::std::vector<::helpers::path>& inputs) const
+{
+    auto entry_dir = m_dir / key.c_str();
+    make_dir(entry_dir);
+
+    // Invalidate the existing entry while its files are replaced
+    auto inputs_path = entry_dir / "inputs.txt";
+    ::std::remove(inputs_path.str().c_str());
+
+    ::std::stringstream inputs_ss;
+    for(const auto& p : inputs)
+    {
+        auto h = hash_file(p);
+        if( h == "" )
+        {
+            DEBUG("Not caching " << outfile << " - can't read input " << p);
+            return ;
+        }
+        inputs_ss << h << " " << p << "\n";
+    }
+
+    if( !copy_file(outfile, entry_dir / "output") || !copy_file(depfile, entry_dir / "output.d") )
+    {
+        DEBUG("Not caching " << outfile << " - failed to copy outputs");
+        return ;
+    }
+    for(const auto* sfx : OUTPUT_SUFFIXES)
+    {
+        auto dst = entry_dir / (::std::string("output") + sfx).c_str();
+        if( file_exists(outfile + sfx) )
+        {
+            if( !copy_file(outfile + sfx, dst) )
+                return ;
+        }
+        else
+        {
+            ::std::remove(dst.str().c_str());
+        }
+    }
+
+    ::std::ofstream(inputs_path.str()) << inputs_ss.str();
+    DEBUG("Cached " << outfile << " as " << key);
+}
@@ -0,0 +1,40 @@
+/*
+ * minicargo - MRustC-specific clone of `cargo`
+ * - By John Hodge (Mutabah)
+ *
+ * build_cache.h
+ * - Content-addressed cache of compiler outputs
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <path.h>
+
+class StringList;
+class StringListKV;
+
+/// Cache of compiler outputs, keyed on the contents of everything that went into them
+///
+/// Layout: `<dir>/<invocation key>/` holds the outputs of the most recent build with that invocation, along with an
+/// `inputs.txt` listing the hash of each input file (from the depfile). An entry is only restored if all the inputs
+/// still hash to the recorded values.
+///
+/// Entries are keyed on the absolute output directory and workspace root, as the outputs refer to other files by path.
+class BuildCache
+{
+    ::helpers::path m_dir;
+    // Hash of the compiler, the C compiler it invokes (command and `--version` output), and the output/workspace paths
+    ::std::string   m_base_hash;
+
+public:
+    BuildCache(::helpers::path dir, const ::helpers::path& compiler_path, const char* target_name, const ::helpers::path& workspace_root, const ::helpers::path& output_dir);
+
+    /// Hash the compiler invocation (compiler, arguments, and environment)
+    ::std::string invocation_key(const StringList& args, const StringListKV& env) const;
+
+    /// Restore `outfile` (and its `.hir`/`.o`/depfile) if the cached entry's inputs are unchanged
+    bool restore(const ::std::string& key, const ::helpers::path& outfile, const ::helpers::path& depfile) const;
+    /// Save the outputs of a successful build, along with the hashes of the files it read
+    void store(const ::std::string& key, const ::helpers::path& outfile, const ::helpers::path& depfile, const ::std::vector<::helpers::path>& inputs) const;
+};
@@ -15,6 +15,7 @@
 #include "repository.h"
 #include "build.h"
 #include <toml.h>   // TomlFile (workspace)
+#include <jobserver.h>
 #include <fstream>  // for workspace enumeration
 #include "cfg.hpp"
 
@@ -44,6 +45,12 @@ struct ProgramOptions
     // Number of build jobs to run at a time
     unsigned build_jobs = 1;
 
+    // Start dependent crates as soon as a library's metadata is written
+    bool pipeline = false;
+
+    // Directory for cached build outputs
+    const char* build_cache_dir = nullptr;
+
     // Pause for user input before quitting (useful for MSVC debugging)
     bool pause_before_quit = false;
 
@@ -78,6 +85,9 @@ int main(int argc, const char* argv[])
         }
     }
 
+    // Use the jobserver from an outer make (or provide one), so mrustc and the C compiler share the `-j` limit
+    Jobserver_InitServer(opts.build_jobs);
+
     try
     {
         Debug_SetPhase("Load Repository");
@@ -211,6 +221,10 @@ int main(int argc, const char* argv[])
         build_opts.lib_search_dirs.reserve(opts.lib_search_dirs.size());
         build_opts.emit_mmir = opts.emit_mmir;
         build_opts.target_name = opts.target;
+        build_opts.pipeline = opts.pipeline;
+        if( opts.build_cache_dir )
+            build_opts.build_cache_dir = ::helpers::path(opts.build_cache_dir);
+        build_opts.workspace_root = workspace_manifest_path.is_valid() ? workspace_manifest_path.parent() : dir;
         for(const auto* d : opts.lib_search_dirs)
             build_opts.lib_search_dirs.push_back( ::helpers::path(d) );
         // Indicate desire to build tests (or examples) instead of the primary target
@@ -377,6 +391,16 @@ int ProgramOptions::parse(int argc, const char* argv[])
             else if( ::std::strcmp(arg, "--test") == 0 ) {
                 this->test = true;
             }
+            else if( ::std::strcmp(arg, "--pipeline") == 0 ) {
+                this->pipeline = true;
+            }
+            else if( ::std::strcmp(arg, "--build-cache") == 0 ) {
+                if(i+1 == argc) {
+                    ::std::cerr << "Flag " << arg << " takes an argument" << ::std::endl;
+                    return 1;
+                }
+                this->build_cache_dir = argv[++i];
+            }
             else {
                 ::std::cerr << "Unknown flag " << arg << ::std::endl;
                 return 1;
@@ -413,6 +437,9 @@ void ProgramOptions::help() const
         << "--output-dir,-o <dir>    : Specify the compiler output directory\n"
         << "-L <dir>                 : Search for pre-built crates (e.g. libstd) in the specified directory\n"
         << "-j <count>               : Run at most <count> build tasks at once (default is to run only one)\n"
+        << "                           Shared with mrustc and the C compiler via the make jobserver protocol\n"
         << "-n                       : Don't build any packages, just list the packages that would be built\n"
+        << "--pipeline               : Start building a library's dependents once its metadata is written (requires -j)\n"
+        << "--build-cache <dir>      : Restore unchanged crates from (and save built crates to) a content-hashed cache\n"
         ;
 }
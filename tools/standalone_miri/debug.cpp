@@ -9,6 +9,7 @@
 #include <fstream>
 
 unsigned DebugSink::s_indent = 0;
+bool DebugSink::s_enabled = true;
 ::std::unique_ptr<std::ofstream> DebugSink::s_out_file;
 
 DebugSink::DebugSink(::std::ostream& inner, bool stderr_too):
@@ -30,9 +31,13 @@ void DebugSink::set_output_file(const ::std::string& s)
 {
     s_out_file.reset(new ::std::ofstream(s));
 }
+void DebugSink::set_enabled(bool e)
+{
+    s_enabled = e;
+}
 bool DebugSink::enabled(const char* fcn_name)
 {
-    return true;
+    return s_enabled;
 }
 DebugSink DebugSink::get(const char* fcn_name, const char* file, unsigned line, DebugLevel lvl)
 {
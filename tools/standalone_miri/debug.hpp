@@ -25,6 +25,7 @@ class DebugSink//:
     //public ::std::ostream
 {
     static unsigned s_indent;
+    static bool s_enabled;
     static ::std::unique_ptr<std::ofstream> s_out_file;
     ::std::ostream& m_inner;
     bool m_stderr_too;
@@ -43,6 +44,8 @@ public:
     }
 
     static void set_output_file(const ::std::string& s);
+    /// Enable/disable debug and trace output (notices and errors are always printed)
+    static void set_enabled(bool e);
     static bool enabled(const char* fcn_name);
     static DebugSink get(const char* fcn_name, const char* file, unsigned line, DebugLevel lvl);
     // TODO: Add a way to insert an annotation before/after an abort/warning/... that indicates what input location caused it.
@@ -113,4 +116,4 @@ struct DebugExceptionError:
 #define LOG_BUG(strm) do { DebugSink::get(__FUNCTION__,__FILE__,__LINE__,DebugLevel::Bug) << "BUG: " << strm; abort(); } while(0)
 #define LOG_ASSERT(cnd,strm) do { if( !(cnd) ) { LOG_ERROR("Assertion failure: " #cnd " - " << strm); } } while(0)
 
-#define FMT_STRING(...) (dynamic_cast<::std::stringstream&>(::std::stringstream() << __VA_ARGS__).str())
+#define FMT_STRING(...) (static_cast<::std::stringstream&&>(::std::stringstream() << __VA_ARGS__).str())
@@ -10,6 +10,7 @@
 #include "value.hpp"
 #include <algorithm>
 #include <iomanip>
+#include <chrono>
 #include "debug.hpp"
 #include "miri.hpp"
 #include "../../src/common.hpp"
@@ -24,6 +25,10 @@ struct ProgramOptions
 
     // Output logfile
     ::std::string   logfile;
+    // Suppress debug/trace logging
+    bool    quiet = false;
+    // Print instruction count and execution rate on exit
+    bool    show_stats = false;
     // Arguments for the program
     ::std::vector<const char*>  args;
 
@@ -45,6 +50,10 @@ int main(int argc, const char* argv[])
     {
         DebugSink::set_output_file(opts.logfile);
     }
+    if( opts.quiet )
+    {
+        DebugSink::set_enabled(false);
+    }
 
     // Load HIR tree
     auto tree = ModuleTree {};
@@ -99,12 +108,21 @@ int main(int argc, const char* argv[])
         args.push_back(::std::move(val_argc));
         args.push_back(::std::move(val_argv));
         Value   rv;
+        auto start_time = ::std::chrono::steady_clock::now();
         root_thread.start("main#", ::std::move(args));
         while( !root_thread.step_one(rv) )
         {
         }
 
         LOG_NOTICE("Return code: " << rv);
+        if( opts.show_stats )
+        {
+            double secs = ::std::chrono::duration<double>(::std::chrono::steady_clock::now() - start_time).count();
+            auto count = root_thread.instruction_count();
+            ::std::cerr << "Executed " << count << " instructions in " << secs << "s"
+                << " (" << static_cast<uint64_t>(secs > 0 ? count / secs : 0) << " instructions/s)"
+                << ::std::endl;
+        }
     }
     catch(const DebugExceptionTodo& /*e*/)
     {
@@ -162,6 +180,9 @@ int ProgramOptions::parse(int argc, const char* argv[])
             case 'h':
                 this->show_help(argv[0]);
                 exit(0);
+            case 'q':
+                this->quiet = true;
+                break;
             default:
                 ::std::cerr << "Unexpected option -" << arg[1] << ::std::endl;
                 return 1;
@@ -182,6 +203,12 @@ int ProgramOptions::parse(int argc, const char* argv[])
                 const char* opt = argv[++argidx];
                 this->logfile = opt;
             }
+            else if( ::std::strcmp(arg, "--quiet") == 0 ) {
+                this->quiet = true;
+            }
+            else if( ::std::strcmp(arg, "--stats") == 0 ) {
+                this->show_stats = true;
+            }
             //else if( ::std::strcmp(arg, "--api") == 0 ) {
             //}
             else {
@@ -200,6 +227,10 @@ int ProgramOptions::parse(int argc, const char* argv[])
 void ProgramOptions::show_help(const char* prog) const
 {
     ::std::cout << "USAGE: " << prog << " <infile> <... args>" << ::std::endl;
+    ::std::cout << "OPTIONS:" << ::std::endl;
+    ::std::cout << "  --logfile <file> : Write debug output to <file>" << ::std::endl;
+    ::std::cout << "  -q, --quiet      : Disable debug/trace output" << ::std::endl;
+    ::std::cout << "  --stats          : Print the executed instruction count and rate on exit" << ::std::endl;
 }
 
 
@@ -328,137 +328,203 @@ struct MirHelpers
         }
         throw "";
     }
-    ValueRef get_value_and_type(const ::MIR::LValue& lv, ::HIR::TypeRef& ty)
+    /// Convert a LValue wrapper into a lowered step, updating `ty` to the type it yields
+    LoweredFunction::LValueStep make_lvalue_step(const ::MIR::LValue::Wrapper& w, ::HIR::TypeRef& ty)
+    {
+        LoweredFunction::LValueStep step {};
+        step.check_size = SIZE_MAX;
+        step.new_size = SIZE_MAX;
+        switch(w.tag())
+        {
+        case ::MIR::LValue::Wrapper::TAGDEAD:    throw "";
+        // --> Modifiers
+        TU_ARM(w, Index, idx_var) {
+            const auto* wrapper = ty.get_wrapper();
+            if( !wrapper )
+            {
+                LOG_ERROR("Indexing non-array/slice - " << ty);
+                throw "ERROR";
+            }
+            else if( wrapper->type == TypeWrapper::Ty::Array )
+            {
+                step.ty = LoweredFunction::LValueStep::Ty::Index;
+            }
+            else if( wrapper->type == TypeWrapper::Ty::Slice )
+            {
+                step.ty = LoweredFunction::LValueStep::Ty::SliceIndex;
+            }
+            else
+            {
+                LOG_ERROR("Indexing non-array/slice - " << ty);
+                throw "ERROR";
+            }
+            ty = ty.get_inner();
+            step.ofs = ty.get_size();
+            step.idx_local = idx_var;
+            } break;
+        TU_ARM(w, Field, fld_idx) {
+            // TODO: if there's metadata present in the base, but the inner doesn't have metadata, clear the metadata
+            size_t inner_ofs;
+            auto inner_ty = ty.get_field(fld_idx, inner_ofs);
+            LOG_DEBUG("Field - " << ty << "#" << fld_idx << " = @" << inner_ofs << " " << inner_ty);
+            step.ty = LoweredFunction::LValueStep::Ty::Offset;
+            step.ofs = inner_ofs;
+            if( inner_ty.get_meta_type() == HIR::TypeRef(RawType::Unreachable) )
+            {
+                step.check_size = inner_ty.get_size();
+                step.new_size = step.check_size;
+            }
+            ty = ::std::move(inner_ty);
+            } break;
+        TU_ARM(w, Downcast, variant_index) {
+            auto composite_ty = ::std::move(ty);
+            LOG_DEBUG("Downcast - " << composite_ty);
+
+            size_t inner_ofs;
+            ty = composite_ty.get_field(variant_index, inner_ofs);
+            step.ty = LoweredFunction::LValueStep::Ty::Offset;
+            step.ofs = inner_ofs;
+            } break;
+        TU_ARM(w, Deref, _) {
+            step.ty = LoweredFunction::LValueStep::Ty::Deref;
+            step.ptr_ty = ::std::move(ty);
+            step.inner_ty = step.ptr_ty.get_inner();
+
+            const auto meta_ty = step.inner_ty.get_meta_type();
+            step.has_meta = (meta_ty != RawType::Unreachable);
+            if( step.has_meta )
+            {
+                step.meta_size = meta_ty.get_size();
+                step.has_slice_meta = step.inner_ty.has_slice_meta(step.slice_inner_size);
+                if( step.has_slice_meta ) {
+                    // Slice metadata, add the base size (if it's a struct) to the variable size
+                    // - `get_wrapper` will return non-null for `[T]`, special-case `str`
+                    step.base_size = (step.inner_ty != RawType::Str && step.inner_ty.get_wrapper() == nullptr ? step.inner_ty.get_size() : 0);
+                }
+            }
+            else
+            {
+                LOG_DEBUG("sizeof(" << step.inner_ty << ") = " << step.inner_ty.get_size());
+                step.base_size = step.inner_ty.get_size();
+            }
+            ty = step.inner_ty;
+            } break;
+        }
+        return step;
+    }
+    /// Append a step to a lowered LValue path (merging adjacent constant offsets)
+    static void push_lvalue_step(::std::vector<LoweredFunction::LValueStep>& steps, LoweredFunction::LValueStep step)
     {
-        auto vr = get_value_and_type_root(lv.m_root, ty);
-        for(const auto& w : lv.m_wrappers)
+        if( step.ty == LoweredFunction::LValueStep::Ty::Offset && !steps.empty() && steps.back().ty == LoweredFunction::LValueStep::Ty::Offset )
         {
-            switch(w.tag())
+            auto& prev = steps.back();
+            prev.ofs += step.ofs;
+            // Only the first size check depends on the input, the rest were checked by the first evaluation
+            if( step.check_size != SIZE_MAX )
             {
-            case ::MIR::LValue::Wrapper::TAGDEAD:    throw "";
-            // --> Modifiers
-            TU_ARM(w, Index, idx_var) {
-                auto idx = this->frame.locals.at(idx_var).read_usize(0);
-                const auto* wrapper = ty.get_wrapper();
-                if( !wrapper )
-                {
-                    LOG_ERROR("Indexing non-array/slice - " << ty);
-                    throw "ERROR";
-                }
-                else if( wrapper->type == TypeWrapper::Ty::Array )
-                {
-                    ty = ty.get_inner();
-                    vr.m_offset += ty.get_size() * idx;
-                }
-                else if( wrapper->type == TypeWrapper::Ty::Slice )
-                {
-                    ty = ty.get_inner();
-                    LOG_ASSERT(vr.m_metadata, "No slice metadata");
-                    auto len = vr.m_metadata->read_usize(0);
-                    LOG_ASSERT(idx < len, "Slice index out of range");
-                    vr.m_offset += ty.get_size() * idx;
-                    vr.m_metadata.reset();
-                }
-                else
-                {
-                    LOG_ERROR("Indexing non-array/slice - " << ty);
-                    throw "ERROR";
-                }
-                } break;
-            TU_ARM(w, Field, fld_idx) {
-                // TODO: if there's metadata present in the base, but the inner doesn't have metadata, clear the metadata
-                size_t inner_ofs;
-                auto inner_ty = ty.get_field(fld_idx, inner_ofs);
-                LOG_DEBUG("Field - " << ty << "#" << fld_idx << " = @" << inner_ofs << " " << inner_ty);
-                vr.m_offset += inner_ofs;
-                if( inner_ty.get_meta_type() == HIR::TypeRef(RawType::Unreachable) )
-                {
-                    LOG_ASSERT(vr.m_size >= inner_ty.get_size(), "Field didn't fit in the value - " << inner_ty.get_size() << " required, but " << vr.m_size << " available");
-                    vr.m_size = inner_ty.get_size();
-                }
-                ty = ::std::move(inner_ty);
-                }
-            TU_ARM(w, Downcast, variant_index) {
-                auto composite_ty = ::std::move(ty);
-                LOG_DEBUG("Downcast - " << composite_ty);
+                if( prev.check_size == SIZE_MAX )
+                    prev.check_size = step.check_size;
+                prev.new_size = step.new_size;
+            }
+        }
+        else
+        {
+            steps.push_back(::std::move(step));
+        }
+    }
+    void apply_lvalue_step(ValueRef& vr, const LoweredFunction::LValueStep& step)
+    {
+        switch(step.ty)
+        {
+        case LoweredFunction::LValueStep::Ty::Offset:
+            vr.m_offset += step.ofs;
+            if( step.check_size != SIZE_MAX )
+            {
+                LOG_ASSERT(vr.m_size >= step.check_size, "Field didn't fit in the value - " << step.check_size << " required, but " << vr.m_size << " available");
+                vr.m_size = step.new_size;
+            }
+            break;
+        case LoweredFunction::LValueStep::Ty::Index: {
+            auto idx = this->frame.locals.at(step.idx_local).read_usize(0);
+            vr.m_offset += step.ofs * idx;
+            } break;
+        case LoweredFunction::LValueStep::Ty::SliceIndex: {
+            auto idx = this->frame.locals.at(step.idx_local).read_usize(0);
+            LOG_ASSERT(vr.m_metadata, "No slice metadata");
+            auto len = vr.m_metadata->read_usize(0);
+            LOG_ASSERT(idx < len, "Slice index out of range");
+            vr.m_offset += step.ofs * idx;
+            vr.m_metadata.reset();
+            } break;
+        case LoweredFunction::LValueStep::Ty::Deref: {
+            LOG_DEBUG("Deref - " << vr << " into " << step.inner_ty);
+
+            LOG_ASSERT(vr.m_size >= POINTER_SIZE, "Deref pointer isn't large enough to be a pointer");
+            // TODO: Move the metadata machinery into `deref` (or at least the logic needed to get the value size)
+            //auto inner_val = vr.deref(0, ty);
+            size_t ofs = vr.read_usize(0);
+            LOG_ASSERT(ofs != 0, "Dereferencing NULL pointer");
+            auto alloc = vr.get_relocation(0);
+            if( alloc )
+            {
+                // TODO: It's valid to dereference (but not read) a non-null invalid pointer.
+                LOG_ASSERT(ofs >= Allocation::PTR_BASE, "Dereferencing invalid pointer - " << ofs << " into " << alloc);
+                ofs -= Allocation::PTR_BASE;
+            }
+            else
+            {
+            }
 
-                size_t inner_ofs;
-                ty = composite_ty.get_field(variant_index, inner_ofs);
-                vr.m_offset += inner_ofs;
-                }
-            TU_ARM(w, Deref, _) {
-                auto ptr_ty = ::std::move(ty);
-                ty = ptr_ty.get_inner();
-                LOG_DEBUG("Deref - " << vr << " into " << ty);
-
-                LOG_ASSERT(vr.m_size >= POINTER_SIZE, "Deref pointer isn't large enough to be a pointer");
-                // TODO: Move the metadata machinery into `deref` (or at least the logic needed to get the value size)
-                //auto inner_val = vr.deref(0, ty);
-                size_t ofs = vr.read_usize(0);
-                LOG_ASSERT(ofs != 0, "Dereferencing NULL pointer");
-                auto alloc = vr.get_relocation(0);
-                if( alloc )
-                {
-                    // TODO: It's valid to dereference (but not read) a non-null invalid pointer.
-                    LOG_ASSERT(ofs >= Allocation::PTR_BASE, "Dereferencing invalid pointer - " << ofs << " into " << alloc);
-                    ofs -= Allocation::PTR_BASE;
-                }
-                else
-                {
-                }
+            // There MUST be a relocation at this point with a valid allocation.
+            LOG_TRACE("Interpret " << alloc << " + " << ofs << " as value of type " << step.inner_ty);
+            // NOTE: No alloc can happen when dereferencing a zero-sized pointer
+            size_t size;
 
-                // There MUST be a relocation at this point with a valid allocation.
-                LOG_TRACE("Interpret " << alloc << " + " << ofs << " as value of type " << ty);
-                // NOTE: No alloc can happen when dereferencing a zero-sized pointer
-                if( alloc.is_alloc() )
-                {
-                    //LOG_DEBUG("Deref - lvr=" << ::MIR::LValue::CRef(lv, &w - &lv.m_wrappers.front()) << " alloc=" << alloc.alloc());
-                }
-                else
-                {
-                    LOG_ASSERT(ty.get_meta_type() != RawType::Unreachable || ty.get_size() >= 0, "Dereference (giving a non-ZST) with no allocation");
-                }
-                size_t size;
+            ::std::shared_ptr<Value>    meta_val;
+            // If the type has metadata, store it.
+            if( step.has_meta )
+            {
+                LOG_ASSERT(vr.m_size == POINTER_SIZE + step.meta_size, "Deref of " << step.inner_ty << ", but pointer isn't correct size");
+                meta_val = ::std::make_shared<Value>( vr.read_value(POINTER_SIZE, step.meta_size) );
 
-                const auto meta_ty = ty.get_meta_type();
-                ::std::shared_ptr<Value>    meta_val;
-                // If the type has metadata, store it.
-                if( meta_ty != RawType::Unreachable )
-                {
-                    auto meta_size = meta_ty.get_size();
-                    LOG_ASSERT(vr.m_size == POINTER_SIZE + meta_size, "Deref of " << ty << ", but pointer isn't correct size");
-                    meta_val = ::std::make_shared<Value>( vr.read_value(POINTER_SIZE, meta_size) );
-
-                    size_t    slice_inner_size;
-                    if( ty.has_slice_meta(slice_inner_size) ) {
-                        // Slice metadata, add the base size (if it's a struct) to the variable size
-                        // - `get_wrapper` will return non-null for `[T]`, special-case `str`
-                        size = (ty != RawType::Str && ty.get_wrapper() == nullptr ? ty.get_size() : 0) + meta_val->read_usize(0) * slice_inner_size;
-                    }
-                    //else if( ty == RawType::TraitObject) {
-                    //    // NOTE: Getting the size from the allocation is semi-valid, as you can't sub-slice trait objects
-                    //    size = alloc.get_size() - ofs;
-                    //}
-                    else {
-                        LOG_DEBUG("> Meta " << *meta_val << ", size = " << alloc.get_size() << " - " << ofs);
-                        // TODO: if the inner type is a trait object, then check that it has an allocation.
-                        size = alloc.get_size() - ofs;
-                    }
+                if( step.has_slice_meta ) {
+                    size = step.base_size + meta_val->read_usize(0) * step.slice_inner_size;
                 }
-                else
-                {
-                    LOG_DEBUG("sizeof(" << ty << ") = " << ty.get_size());
-                    LOG_ASSERT(vr.m_size == POINTER_SIZE, "Deref of a value that isn't a pointer-sized value (size=" << vr << ") - " << vr << ": " << ptr_ty);
-                    size = ty.get_size();
-                    if( !alloc && size > 0 ) {
-                        LOG_ERROR("Deref of a non-ZST pointer with no relocation - " << vr);
-                    }
+                //else if( ty == RawType::TraitObject) {
+                //    // NOTE: Getting the size from the allocation is semi-valid, as you can't sub-slice trait objects
+                //    size = alloc.get_size() - ofs;
+                //}
+                else {
+                    LOG_DEBUG("> Meta " << *meta_val << ", size = " << alloc.get_size() << " - " << ofs);
+                    // TODO: if the inner type is a trait object, then check that it has an allocation.
+                    size = alloc.get_size() - ofs;
+                }
+            }
+            else
+            {
+                LOG_ASSERT(vr.m_size == POINTER_SIZE, "Deref of a value that isn't a pointer-sized value (size=" << vr << ") - " << vr << ": " << step.ptr_ty);
+                size = step.base_size;
+                if( !alloc && size > 0 ) {
+                    LOG_ERROR("Deref of a non-ZST pointer with no relocation - " << vr);
                 }
+            }
 
-                LOG_DEBUG("Deref - New VR: alloc=" << alloc << ", ofs=" << ofs << ", size=" << size);
-                vr = ValueRef(::std::move(alloc), ofs, size);
-                vr.m_metadata = ::std::move(meta_val);
-                } break;
+            LOG_DEBUG("Deref - New VR: alloc=" << alloc << ", ofs=" << ofs << ", size=" << size);
+            vr = ValueRef(::std::move(alloc), ofs, size);
+            vr.m_metadata = ::std::move(meta_val);
+            } break;
+        }
+    }
+    ValueRef get_value_and_type(const ::MIR::LValue& lv, ::HIR::TypeRef& ty, ::std::vector<LoweredFunction::LValueStep>* out_steps=nullptr)
+    {
+        auto vr = get_value_and_type_root(lv.m_root, ty);
+        for(const auto& w : lv.m_wrappers)
+        {
+            auto step = make_lvalue_step(w, ty);
+            apply_lvalue_step(vr, step);
+            if( out_steps )
+            {
+                push_lvalue_step(*out_steps, ::std::move(step));
             }
         }
         return vr;
@@ -509,6 +575,10 @@ struct MirHelpers
     {
         ::HIR::TypeRef  src_ty;
         ValueRef src_base_value = this->get_value_and_type(lv, src_ty);
+        return borrow_value_ref(::std::move(src_base_value), src_ty, bt, dst_ty);
+    }
+    Value borrow_value_ref(ValueRef src_base_value, const ::HIR::TypeRef& src_ty, ::HIR::BorrowType bt, ::HIR::TypeRef& dst_ty)
+    {
         auto alloc = src_base_value.m_alloc;
         // If the source doesn't yet have a relocation, give it a backing allocation so we can borrow
         if( !alloc && src_base_value.m_value )
@@ -660,6 +730,123 @@ struct MirHelpers
         }
         throw "";
     }
+
+    // --> Lowered LValues/Params (see `LoweredFunction`)
+    /// Resolve a lowered LValue on first use: walk the MIR (performing all of the checks), and record the path taken
+    void resolve_lvalue(LoweredFunction::LValue& llv)
+    {
+        ::HIR::TypeRef  ty;
+        ::std::vector<LoweredFunction::LValueStep>  steps;
+        get_value_and_type(*llv.mir, ty, &steps);
+        if( llv.mir->m_root.is_Static() )
+        {
+            llv.root_static = &this->thread.m_global.m_modtree.get_static(llv.mir->m_root.as_Static());
+        }
+        llv.ty = ::std::move(ty);
+        llv.steps = ::std::move(steps);
+        llv.resolved = true;
+    }
+    ValueRef get_value_ref(LoweredFunction::LValue& llv)
+    {
+        if( !llv.resolved )
+        {
+            resolve_lvalue(llv);
+        }
+
+        auto vr = get_value_ref_root(llv);
+        for(const auto& step : llv.steps)
+        {
+            apply_lvalue_step(vr, step);
+        }
+        return vr;
+    }
+    ValueRef get_value_ref_root(const LoweredFunction::LValue& llv)
+    {
+        const auto& root = llv.mir->m_root;
+        switch(root.tag())
+        {
+        case ::MIR::LValue::Storage::TAGDEAD:    throw "";
+        TU_ARM(root, Return, _e)
+            return ValueRef(this->frame.ret);
+        TU_ARM(root, Local, e)
+            return ValueRef(this->frame.locals.at(e));
+        TU_ARM(root, Argument, e)
+            return ValueRef(this->frame.args.at(e));
+        TU_ARM(root, Static, _e)
+            return ValueRef(llv.root_static->val);
+        }
+        throw "";
+    }
+    /// Get the type of a lowered LValue (evaluating it if it hasn't been resolved yet)
+    const ::HIR::TypeRef& get_lvalue_ty(LoweredFunction::LValue& llv)
+    {
+        if( !llv.resolved )
+        {
+            resolve_lvalue(llv);
+        }
+        return llv.ty;
+    }
+    Value read_lvalue(LoweredFunction::LValue& llv)
+    {
+        auto base_value = get_value_ref(llv);
+        if( llv.size == SIZE_MAX )
+        {
+            llv.size = llv.ty.get_size();
+        }
+        return base_value.read_value(0, llv.size);
+    }
+    void write_lvalue(LoweredFunction::LValue& llv, Value val)
+    {
+        auto base_value = get_value_ref(llv);
+        if( val.size() > 0 )
+        {
+            if(!base_value.m_value) {
+                base_value.m_alloc.alloc().write_value(base_value.m_offset, ::std::move(val));
+            }
+            else {
+                base_value.m_value->write_value(base_value.m_offset, ::std::move(val));
+            }
+        }
+    }
+    Value borrow_value(LoweredFunction::LValue& llv, ::HIR::BorrowType bt, ::HIR::TypeRef& dst_ty)
+    {
+        auto src_base_value = get_value_ref(llv);
+        return borrow_value_ref(::std::move(src_base_value), llv.ty, bt, dst_ty);
+    }
+    Value param_to_value(const LoweredFunction::Param& p)
+    {
+        switch(p.mir->tag())
+        {
+        case ::MIR::Param::TAGDEAD: throw "";
+        TU_ARM((*p.mir), Constant, pe)
+            return const_to_value(pe);
+        TU_ARM((*p.mir), Borrow, pe) {
+            ::HIR::TypeRef  ty;
+            return borrow_value(this->frame.lowered->lvalues[p.lv], pe.type, ty);
+            }
+        TU_ARM((*p.mir), LValue, _pe)
+            return read_lvalue(this->frame.lowered->lvalues[p.lv]);
+        }
+        throw "";
+    }
+    ValueRef get_value_ref_param(const LoweredFunction::Param& p, Value& tmp, ::HIR::TypeRef& ty)
+    {
+        switch(p.mir->tag())
+        {
+        case ::MIR::Param::TAGDEAD: throw "";
+        TU_ARM((*p.mir), Constant, pe)
+            tmp = const_to_value(pe, ty);
+            return ValueRef(tmp, 0, ty.get_size());
+        TU_ARM((*p.mir), Borrow, pe)
+            LOG_TODO("");
+        TU_ARM((*p.mir), LValue, _pe) {
+            auto& llv = this->frame.lowered->lvalues[p.lv];
+            ty = get_lvalue_ty(llv);
+            return get_value_ref(llv);
+            }
+        }
+        throw "";
+    }
 };
 
 GlobalState::GlobalState(ModuleTree& modtree):
@@ -760,11 +947,20 @@ bool InterpreterThread::step_one(Value& out_thread_result)
         LOG_ERROR("Maximum stack depth of " << MAX_STACK_DEPTH << " exceeded");
     }
 
+    if( !cur_frame.lowered )
+    {
+        cur_frame.lowered = &m_global.get_lowered(*cur_frame.fcn);
+    }
+    auto& lowered = *cur_frame.lowered;
+    auto& op = lowered.get_op(cur_frame.bb_idx, cur_frame.stmt_idx);
+    auto& lvs = lowered.lvalues;
+    const auto* params = lowered.params.data() + op.params_first;
+
     MirHelpers  state { *this, cur_frame };
 
-    if( cur_frame.stmt_idx < bb.statements.size() )
+    if( op.stmt )
     {
-        const auto& stmt = bb.statements[cur_frame.stmt_idx];
+        const auto& stmt = *op.stmt;
         LOG_DEBUG("=== F" << cur_frame.frame_index << " BB" << cur_frame.bb_idx << "/" << cur_frame.stmt_idx << ": " << stmt);
         switch(stmt.tag())
         {
@@ -774,21 +970,21 @@ bool InterpreterThread::step_one(Value& out_thread_result)
             switch(se.src.tag())
             {
             case ::MIR::RValue::TAGDEAD: throw "";
-            TU_ARM(se.src, Use, re) {
-                new_val = state.read_lvalue(re);
+            TU_ARM(se.src, Use, _re) {
+                new_val = state.read_lvalue(lvs[op.src]);
                 } break;
             TU_ARM(se.src, Constant, re) {
                 new_val = state.const_to_value(re);
                 } break;
             TU_ARM(se.src, Borrow, re) {
                 HIR::TypeRef    dst_ty;
-                new_val = state.borrow_value(re.val, re.type, dst_ty);
+                new_val = state.borrow_value(lvs[op.src], re.type, dst_ty);
                 } break;
             TU_ARM(se.src, Cast, re) {
                 // Determine the type of cast, is it a reinterpret or is it a value transform?
                 // - Float <-> integer is a transform, anything else should be a reinterpret.
-                ::HIR::TypeRef  src_ty;
-                auto src_value = state.get_value_and_type(re.val, src_ty);
+                auto src_value = state.get_value_ref(lvs[op.src]);
+                const auto& src_ty = lvs[op.src].ty;
 
                 new_val = Value(re.type);
                 if( re.type == src_ty )
@@ -1139,8 +1335,8 @@ bool InterpreterThread::step_one(Value& out_thread_result)
             TU_ARM(se.src, BinOp, re) {
                 ::HIR::TypeRef  ty_l, ty_r;
                 Value   tmp_l, tmp_r;
-                auto v_l = state.get_value_ref_param(re.val_l, tmp_l, ty_l);
-                auto v_r = state.get_value_ref_param(re.val_r, tmp_r, ty_r);
+                auto v_l = state.get_value_ref_param(params[0], tmp_l, ty_l);
+                auto v_r = state.get_value_ref_param(params[1], tmp_r, ty_r);
                 LOG_DEBUG(v_l << " (" << ty_l <<") ? " << v_r << " (" << ty_r <<")");
 
                 switch(re.op)
@@ -1408,8 +1604,8 @@ bool InterpreterThread::step_one(Value& out_thread_result)
                 }
                 } break;
             TU_ARM(se.src, UniOp, re) {
-                ::HIR::TypeRef  ty;
-                auto v = state.get_value_and_type(re.val, ty);
+                auto v = state.get_value_ref(lvs[op.src]);
+                const auto& ty = lvs[op.src].ty;
                 LOG_ASSERT(ty.get_wrapper() == nullptr, "UniOp on wrapped type - " << ty);
                 new_val = Value(ty);
                 switch(re.op)
@@ -1473,34 +1669,31 @@ bool InterpreterThread::step_one(Value& out_thread_result)
                     break;
                 }
                 } break;
-            TU_ARM(se.src, DstMeta, re) {
-                auto ptr = state.get_value_ref(re.val);
+            TU_ARM(se.src, DstMeta, _re) {
+                auto ptr = state.get_value_ref(lvs[op.src]);
 
-                ::HIR::TypeRef  dst_ty;
-                state.get_value_and_type(se.dst, dst_ty);
+                const auto& dst_ty = state.get_lvalue_ty(lvs[op.dst]);
                 new_val = ptr.read_value(POINTER_SIZE, dst_ty.get_size());
                 } break;
-            TU_ARM(se.src, DstPtr, re) {
-                auto ptr = state.get_value_ref(re.val);
+            TU_ARM(se.src, DstPtr, _re) {
+                auto ptr = state.get_value_ref(lvs[op.src]);
 
                 new_val = ptr.read_value(0, POINTER_SIZE);
                 } break;
-            TU_ARM(se.src, MakeDst, re) {
+            TU_ARM(se.src, MakeDst, _re) {
                 // - Get target type, just for some assertions
-                ::HIR::TypeRef  dst_ty;
-                state.get_value_and_type(se.dst, dst_ty);
+                const auto& dst_ty = state.get_lvalue_ty(lvs[op.dst]);
                 new_val = Value(dst_ty);
 
-                auto ptr  = state.param_to_value(re.ptr_val );
-                auto meta = state.param_to_value(re.meta_val);
+                auto ptr  = state.param_to_value(params[0]);
+                auto meta = state.param_to_value(params[1]);
                 LOG_DEBUG("ty=" << dst_ty << ", ptr=" << ptr << ", meta=" << meta);
 
                 new_val.write_value(0, ::std::move(ptr));
                 new_val.write_value(POINTER_SIZE, ::std::move(meta));
                 } break;
             TU_ARM(se.src, Tuple, re) {
-                ::HIR::TypeRef  dst_ty;
-                state.get_value_and_type(se.dst, dst_ty);
+                const auto& dst_ty = state.get_lvalue_ty(lvs[op.dst]);
                 new_val = Value(dst_ty);
 
                 if( dst_ty.inner_type == RawType::Unit )
@@ -1513,28 +1706,26 @@ bool InterpreterThread::step_one(Value& out_thread_result)
                     for(size_t i = 0; i < re.vals.size(); i++)
                     {
                         auto fld_ofs = dst_ty.composite_type().fields.at(i).first;
-                        new_val.write_value(fld_ofs, state.param_to_value(re.vals[i]));
+                        new_val.write_value(fld_ofs, state.param_to_value(params[i]));
                     }
                 }
                 } break;
             TU_ARM(se.src, Array, re) {
-                ::HIR::TypeRef  dst_ty;
-                state.get_value_and_type(se.dst, dst_ty);
+                const auto& dst_ty = state.get_lvalue_ty(lvs[op.dst]);
                 new_val = Value(dst_ty);
                 // TODO: Assert that type is an array
                 auto inner_ty = dst_ty.get_inner();
                 size_t stride = inner_ty.get_size();
 
                 size_t ofs = 0;
-                for(const auto& v : re.vals)
+                for(size_t i = 0; i < re.vals.size(); i++)
                 {
-                    new_val.write_value(ofs, state.param_to_value(v));
+                    new_val.write_value(ofs, state.param_to_value(params[i]));
                     ofs += stride;
                 }
                 } break;
             TU_ARM(se.src, SizedArray, re) {
-                ::HIR::TypeRef  dst_ty;
-                state.get_value_and_type(se.dst, dst_ty);
+                const auto& dst_ty = state.get_lvalue_ty(lvs[op.dst]);
                 new_val = Value(dst_ty);
                 // TODO: Assert that type is an array
                 auto inner_ty = dst_ty.get_inner();
@@ -1543,7 +1734,7 @@ bool InterpreterThread::step_one(Value& out_thread_result)
                 size_t ofs = 0;
                 for(size_t i = 0; i < re.count; i++)
                 {
-                    new_val.write_value(ofs, state.param_to_value(re.val));
+                    new_val.write_value(ofs, state.param_to_value(params[0]));
                     ofs += stride;
                 }
                 } break;
@@ -1561,7 +1752,7 @@ bool InterpreterThread::step_one(Value& out_thread_result)
                 {
                     const auto& fld = data_ty.fields.at(re.index);
 
-                    new_val.write_value(fld.first, state.param_to_value(re.val));
+                    new_val.write_value(fld.first, state.param_to_value(params[0]));
                 }
                 if( var.base_field != SIZE_MAX )
                 {
@@ -1579,8 +1770,7 @@ bool InterpreterThread::step_one(Value& out_thread_result)
             TU_ARM(se.src, Struct, re) {
                 const auto& data_ty = m_global.m_modtree.get_composite(re.path.n);
 
-                ::HIR::TypeRef  dst_ty;
-                state.get_value_and_type(se.dst, dst_ty);
+                const auto& dst_ty = state.get_lvalue_ty(lvs[op.dst]);
                 new_val = Value(dst_ty);
                 LOG_ASSERT(dst_ty.inner_type == RawType::Composite, dst_ty);
                 LOG_ASSERT(dst_ty.ptr.composite_type == &data_ty, "Destination type of RValue::Struct isn't the same as the input");
@@ -1588,14 +1778,14 @@ bool InterpreterThread::step_one(Value& out_thread_result)
                 for(size_t i = 0; i < re.vals.size(); i++)
                 {
                     auto fld_ofs = data_ty.fields.at(i).first;
-                    auto v = state.param_to_value(re.vals[i]);
+                    auto v = state.param_to_value(params[i]);
                     LOG_DEBUG("Struct - @" << fld_ofs << " = " << v);
                     new_val.write_value(fld_ofs, ::std::move(v));
                 }
                 } break;
             }
             LOG_DEBUG("- new_val=" << new_val);
-            state.write_lvalue(se.dst, ::std::move(new_val));
+            state.write_lvalue(lvs[op.dst], ::std::move(new_val));
             } break;
         case ::MIR::Statement::TAG_Asm:
             LOG_TODO(stmt);
@@ -1603,8 +1793,8 @@ bool InterpreterThread::step_one(Value& out_thread_result)
         TU_ARM(stmt, Drop, se) {
             if( se.flag_idx == ~0u || cur_frame.drop_flags.at(se.flag_idx) )
             {
-                ::HIR::TypeRef  ty;
-                auto v = state.get_value_and_type(se.slot, ty);
+                auto v = state.get_value_ref(lvs[op.dst]);
+                const auto& ty = lvs[op.dst].ty;
 
                 // - Take a pointer to the inner
                 auto alloc = (v.m_value ? RelocationPtr::new_alloc(v.m_value->borrow("drop")) : v.m_alloc);
@@ -1659,13 +1849,13 @@ bool InterpreterThread::step_one(Value& out_thread_result)
             LOG_DEBUG("RETURN " << cur_frame.ret);
             return this->pop_stack(out_thread_result);
         TU_ARM(bb.terminator, If, te) {
-            uint8_t v = state.get_value_ref(te.cond).read_u8(0);
+            uint8_t v = state.get_value_ref(lvs[op.src]).read_u8(0);
             LOG_ASSERT(v == 0 || v == 1, "");
             cur_frame.bb_idx = v ? te.bb0 : te.bb1;
             } break;
         TU_ARM(bb.terminator, Switch, te) {
-            ::HIR::TypeRef ty;
-            auto v = state.get_value_and_type(te.val, ty);
+            auto v = state.get_value_ref(lvs[op.src]);
+            const auto& ty = lvs[op.src].ty;
             LOG_ASSERT(ty.get_wrapper() == nullptr, "Matching on wrapped value - " << ty);
             LOG_ASSERT(ty.inner_type == RawType::Composite, "Matching on non-coposite - " << ty);
             LOG_DEBUG("Switch v = " << v);
@@ -1716,8 +1906,8 @@ bool InterpreterThread::step_one(Value& out_thread_result)
             cur_frame.bb_idx = te.targets.at(found_target);
             } break;
         TU_ARM(bb.terminator, SwitchValue, te) {
-            ::HIR::TypeRef ty;
-            auto v = state.get_value_and_type(te.val, ty);
+            auto v = state.get_value_ref(lvs[op.src]);
+            const auto& ty = lvs[op.src].ty;
             TU_MATCH_HDRA( (te.values), {)
             TU_ARMA(Unsigned, vals) {
                 LOG_ASSERT(vals.size() == te.targets.size(), "Mismatch in SwitchValue target/value list lengths");
@@ -1804,16 +1994,16 @@ bool InterpreterThread::step_one(Value& out_thread_result)
             }
         TU_ARM(bb.terminator, Call, te) {
             ::std::vector<Value>    sub_args; sub_args.reserve(te.args.size());
-            for(const auto& a : te.args)
+            for(size_t i = 0; i < te.args.size(); i++)
             {
-                sub_args.push_back( state.param_to_value(a) );
+                sub_args.push_back( state.param_to_value(params[i]) );
                 LOG_DEBUG("#" << (sub_args.size() - 1) << " " << sub_args.back());
             }
             Value   rv;
             if( te.fcn.is_Intrinsic() )
             {
                 const auto& fe = te.fcn.as_Intrinsic();
-                auto ret_ty = state.get_lvalue_ty(te.ret_val);
+                const auto& ret_ty = state.get_lvalue_ty(lvs[op.dst]);
                 if( !this->call_intrinsic(rv, ret_ty, fe.name, fe.params, ::std::move(sub_args)) )
                 {
                     // Early return, don't want to update stmt_idx yet
@@ -1829,8 +2019,7 @@ bool InterpreterThread::step_one(Value& out_thread_result)
                     fcn_p = &te.fcn.as_Path();
                 }
                 else {
-                    ::HIR::TypeRef ty;
-                    auto v = state.get_value_and_type(te.fcn.as_Value(), ty);
+                    auto v = state.get_value_ref(lvs[op.src]);
                     LOG_DEBUG("> Indirect call " << v);
                     // TODO: Assert type
                     // TODO: Assert offset/content.
@@ -1870,7 +2059,22 @@ bool InterpreterThread::step_one(Value& out_thread_result)
                 }
 
                 LOG_DEBUG("Call " << *fcn_p);
-                if( !this->call_path(rv, *fcn_p, ::std::move(sub_args)) )
+                bool immediate;
+                if( te.fcn.is_Path() )
+                {
+                    // Direct calls always go to the same function, so cache the resolved target
+                    auto& tgt = op.call_target;
+                    if( !tgt.resolved )
+                    {
+                        tgt = m_global.resolve_call_target(*fcn_p);
+                    }
+                    immediate = this->call_target(rv, tgt, *fcn_p, ::std::move(sub_args));
+                }
+                else
+                {
+                    immediate = this->call_path(rv, *fcn_p, ::std::move(sub_args));
+                }
+                if( !immediate )
                 {
                     // Early return, don't want to update stmt_idx yet
                     LOG_DEBUG("- Non-immediate return, do not advance yet");
@@ -1887,7 +2091,7 @@ bool InterpreterThread::step_one(Value& out_thread_result)
             else
             {
                 LOG_DEBUG(te.ret_val << " = " << rv << " (resume " << cur_frame.fcn->my_path << ")");
-                state.write_lvalue(te.ret_val, rv);
+                state.write_lvalue(lvs[op.dst], rv);
                 cur_frame.bb_idx = te.ret_block;
             }
             } break;
@@ -1938,6 +2142,8 @@ bool InterpreterThread::pop_stack(Value& out_thread_result)
         {
             assert( blk.terminator.is_Call() );
             const auto& te = blk.terminator.as_Call();
+            assert( cur_frame.lowered );
+            auto& ret_lv = cur_frame.lowered->lvalues[ cur_frame.lowered->get_op(cur_frame.bb_idx, cur_frame.stmt_idx).dst ];
 
             LOG_DEBUG("Resume " << cur_frame.fcn->my_path);
             LOG_DEBUG("F" << cur_frame.frame_index << " " << te.ret_val << " = " << res_v);
@@ -1952,7 +2158,7 @@ bool InterpreterThread::pop_stack(Value& out_thread_result)
             }
             else
             {
-                state.write_lvalue(te.ret_val, res_v);
+                state.write_lvalue(ret_lv, res_v);
                 cur_frame.bb_idx = te.ret_block;
             }
         }
@@ -1965,6 +2171,7 @@ unsigned InterpreterThread::StackFrame::s_next_frame_index = 0;
 InterpreterThread::StackFrame::StackFrame(const Function& fcn, ::std::vector<Value> args):
     frame_index(s_next_frame_index++),
     fcn(&fcn),
+    lowered(nullptr),
     ret( fcn.ret_ty == RawType::Unreachable ? Value() : Value(fcn.ret_ty) ),
     args( ::std::move(args) ),
     locals( ),
@@ -1986,14 +2193,18 @@ InterpreterThread::StackFrame::StackFrame(const Function& fcn, ::std::vector<Val
         }
     }
 }
-bool InterpreterThread::call_path(Value& ret, const ::HIR::Path& path, ::std::vector<Value> args)
+GlobalState::CallTarget GlobalState::resolve_call_target(const ::HIR::Path& path) const
 {
+    CallTarget  rv;
+    rv.resolved = true;
+
     // Support overriding certain functions
     {
-        auto it = m_global.m_fcn_overrides.find(path.n);
-        if( it != m_global.m_fcn_overrides.end() )
+        auto it = m_fcn_overrides.find(path.n);
+        if( it != m_fcn_overrides.end() )
         {
-            return it->second(*this, ret, path, args);
+            rv.override_fcn = it->second;
+            return rv;
         }
     }
 
@@ -2005,24 +2216,191 @@ bool InterpreterThread::call_path(Value& ret, const ::HIR::Path& path, ::std::ve
     //    return this->call_extern(ret, link_name, link_abi, ::std::move(args));
     //}
 
-    const auto& fcn = m_global.m_modtree.get_function(path);
+    const auto& fcn = m_modtree.get_function(path);
 
     if( fcn.external.link_name != "" )
     {
         // Search for a function with both code and this link name
-        if(const auto* ext_fcn = m_global.m_modtree.get_ext_function(fcn.external.link_name.c_str()))
+        if(const auto* ext_fcn = m_modtree.get_ext_function(fcn.external.link_name.c_str()))
         {
-            this->m_stack.push_back(StackFrame(*ext_fcn, ::std::move(args)));
-            return false;
+            rv.fcn = ext_fcn;
         }
         else
         {
             // External function!
-            return this->call_extern(ret, fcn.external.link_name, fcn.external.link_abi, ::std::move(args));
+            rv.extern_fcn = &fcn;
+        }
+        return rv;
+    }
+
+    rv.fcn = &fcn;
+    return rv;
+}
+LoweredFunction& GlobalState::get_lowered(const Function& fcn)
+{
+    auto it = m_lowered.find(&fcn);
+    if( it == m_lowered.end() )
+    {
+        it = m_lowered.insert(::std::make_pair( &fcn, ::std::unique_ptr<LoweredFunction>(new LoweredFunction(fcn)) )).first;
+    }
+    return *it->second;
+}
+
+LoweredFunction::LoweredFunction(const Function& fcn)
+{
+    const auto& blocks = fcn.m_mir.blocks;
+    size_t n_ops = 0;
+    for(const auto& bb : blocks)
+        n_ops += bb.statements.size() + 1;
+    this->ops.reserve(n_ops);
+    this->block_start.reserve(blocks.size());
+
+    for(const auto& bb : blocks)
+    {
+        this->block_start.push_back( static_cast<unsigned>(this->ops.size()) );
+        for(const auto& stmt : bb.statements)
+        {
+            Op  op;
+            op.stmt = &stmt;
+            switch(stmt.tag())
+            {
+            case ::MIR::Statement::TAGDEAD: throw "";
+            TU_ARM(stmt, Assign, se) {
+                op.dst = add_lvalue(se.dst);
+                lower_rvalue(op, se.src);
+                } break;
+            TU_ARM(stmt, Drop, se) {
+                op.dst = add_lvalue(se.slot);
+                } break;
+            case ::MIR::Statement::TAG_Asm:
+            case ::MIR::Statement::TAG_SetDropFlag:
+            case ::MIR::Statement::TAG_ScopeEnd:
+                break;
+            }
+            this->ops.push_back(::std::move(op));
         }
+
+        Op  op;
+        op.term = &bb.terminator;
+        switch(bb.terminator.tag())
+        {
+        case ::MIR::Terminator::TAGDEAD:    throw "";
+        TU_ARM(bb.terminator, If, te) {
+            op.src = add_lvalue(te.cond);
+            } break;
+        TU_ARM(bb.terminator, Switch, te) {
+            op.src = add_lvalue(te.val);
+            } break;
+        TU_ARM(bb.terminator, SwitchValue, te) {
+            op.src = add_lvalue(te.val);
+            } break;
+        TU_ARM(bb.terminator, Call, te) {
+            op.dst = add_lvalue(te.ret_val);
+            if( te.fcn.is_Value() ) {
+                op.src = add_lvalue(te.fcn.as_Value());
+            }
+            op.params_first = static_cast<unsigned>(this->params.size());
+            op.params_count = static_cast<unsigned>(te.args.size());
+            for(const auto& a : te.args)
+                add_param(a);
+            } break;
+        default:
+            break;
+        }
+        this->ops.push_back(::std::move(op));
+    }
+}
+void LoweredFunction::lower_rvalue(Op& op, const ::MIR::RValue& rv)
+{
+    auto add_params = [&](const ::std::vector<::MIR::Param>& vals) {
+        op.params_first = static_cast<unsigned>(this->params.size());
+        op.params_count = static_cast<unsigned>(vals.size());
+        for(const auto& v : vals)
+            add_param(v);
+        };
+    switch(rv.tag())
+    {
+    case ::MIR::RValue::TAGDEAD: throw "";
+    TU_ARM(rv, Use, re)
+        op.src = add_lvalue(re);
+    TU_ARM(rv, Constant, _re)
+        ;
+    TU_ARM(rv, Borrow, re)
+        op.src = add_lvalue(re.val);
+    TU_ARM(rv, Cast, re)
+        op.src = add_lvalue(re.val);
+    TU_ARM(rv, BinOp, re) {
+        op.params_first = static_cast<unsigned>(this->params.size());
+        op.params_count = 2;
+        add_param(re.val_l);
+        add_param(re.val_r);
+        }
+    TU_ARM(rv, UniOp, re)
+        op.src = add_lvalue(re.val);
+    TU_ARM(rv, DstMeta, re)
+        op.src = add_lvalue(re.val);
+    TU_ARM(rv, DstPtr, re)
+        op.src = add_lvalue(re.val);
+    TU_ARM(rv, MakeDst, re) {
+        op.params_first = static_cast<unsigned>(this->params.size());
+        op.params_count = 2;
+        add_param(re.ptr_val);
+        add_param(re.meta_val);
+        }
+    TU_ARM(rv, Tuple, re)
+        add_params(re.vals);
+    TU_ARM(rv, Array, re)
+        add_params(re.vals);
+    TU_ARM(rv, SizedArray, re) {
+        op.params_first = static_cast<unsigned>(this->params.size());
+        op.params_count = 1;
+        add_param(re.val);
+        }
+    TU_ARM(rv, Variant, re) {
+        op.params_first = static_cast<unsigned>(this->params.size());
+        op.params_count = 1;
+        add_param(re.val);
+        }
+    TU_ARM(rv, Struct, re)
+        add_params(re.vals);
+    }
+}
+unsigned LoweredFunction::add_lvalue(const ::MIR::LValue& lv)
+{
+    LValue  llv;
+    llv.mir = &lv;
+    this->lvalues.push_back(::std::move(llv));
+    return static_cast<unsigned>(this->lvalues.size() - 1);
+}
+void LoweredFunction::add_param(const ::MIR::Param& p)
+{
+    Param   lp;
+    lp.mir = &p;
+    if( p.is_LValue() ) {
+        lp.lv = add_lvalue(p.as_LValue());
+    }
+    else if( p.is_Borrow() ) {
+        lp.lv = add_lvalue(p.as_Borrow().val);
+    }
+    this->params.push_back(lp);
+}
+bool InterpreterThread::call_path(Value& ret, const ::HIR::Path& path, ::std::vector<Value> args)
+{
+    return this->call_target(ret, m_global.resolve_call_target(path), path, ::std::move(args));
+}
+bool InterpreterThread::call_target(Value& ret, const GlobalState::CallTarget& tgt, const ::HIR::Path& path, ::std::vector<Value> args)
+{
+    assert(tgt.resolved);
+    if( tgt.override_fcn )
+    {
+        return tgt.override_fcn(*this, ret, path, args);
+    }
+    if( tgt.extern_fcn )
+    {
+        return this->call_extern(ret, tgt.extern_fcn->external.link_name, tgt.extern_fcn->external.link_abi, ::std::move(args));
     }
 
-    this->m_stack.push_back(StackFrame(fcn, ::std::move(args)));
+    this->m_stack.push_back(StackFrame(*tgt.fcn, ::std::move(args)));
     return false;
 }
 
@@ -8,6 +8,7 @@
 #pragma once
 #include "module_tree.hpp"
 #include "value.hpp"
+#include <unordered_map>
 
 struct ThreadState
 {
@@ -37,15 +38,117 @@ struct ThreadState
 };
 
 class InterpreterThread;
+struct LoweredFunction;
 
 struct GlobalState
 {
     typedef bool    override_handler_t(InterpreterThread& thread, Value& ret, const ::HIR::Path& path, ::std::vector<Value> args);
 
+    /// Pre-resolved target of a call (avoids repeated name lookups for hot call sites)
+    struct CallTarget
+    {
+        bool    resolved = false;
+        // Override handler (if set, the other fields are unused)
+        override_handler_t* override_fcn = nullptr;
+        // Function with a body to enter
+        const Function* fcn = nullptr;
+        // External function (no body available, called via `call_extern`)
+        const Function* extern_fcn = nullptr;
+    };
+
     ModuleTree& m_modtree;
     std::map<RcString, override_handler_t*>  m_fcn_overrides;
+    // Lowered form of each function that has been entered (see `LoweredFunction`)
+    std::unordered_map<const Function*, std::unique_ptr<LoweredFunction>>    m_lowered;
 
     GlobalState(ModuleTree& modtree);
+
+    CallTarget resolve_call_target(const ::HIR::Path& path) const;
+    LoweredFunction& get_lowered(const Function& fcn);
+};
+
+/// Function body lowered for execution (built when the function is first entered)
+///
+/// Every statement and terminator becomes one entry in a flat op array, and each LValue/Param that
+/// an op uses gets a slot in `lvalues`/`params`. The first evaluation of an LValue walks the MIR as
+/// usual (so errors are reported at the same point), then records the result as a resolved path:
+/// the root slot, the final type, and a list of steps with runs of Field/Downcast folded into a
+/// single constant offset.
+struct LoweredFunction
+{
+    struct LValueStep
+    {
+        enum class Ty {
+            Offset,     // Field/Downcast wrappers, with the offsets summed
+            Index,      // Array index
+            SliceIndex, // Slice index (checked against the metadata)
+            Deref,
+        } ty;
+        // Offset: byte offset. Index/SliceIndex: element size
+        size_t  ofs;
+        // Offset: size of the first sized field (checked against the value size) and of the last (SIZE_MAX if none)
+        size_t  check_size;
+        size_t  new_size;
+        // Index/SliceIndex: local holding the index
+        unsigned    idx_local;
+
+        // Deref: pointer/pointee types (only used for messages) and pointee size/metadata
+        ::HIR::TypeRef  ptr_ty;
+        ::HIR::TypeRef  inner_ty;
+        bool    has_meta;
+        size_t  meta_size;
+        bool    has_slice_meta;
+        size_t  slice_inner_size;
+        size_t  base_size;  // Pointee size (for sized pointees), or the size of the fixed part of a slice DST
+    };
+    struct LValue
+    {
+        const ::MIR::LValue*    mir;
+        // Set once the first evaluation succeeds, all fields below are only valid after that
+        bool    resolved = false;
+        Static* root_static = nullptr;
+        ::std::vector<LValueStep>   steps;
+        ::HIR::TypeRef  ty;
+        // Size of `ty`, calculated on the first read (SIZE_MAX until then)
+        size_t  size = SIZE_MAX;
+    };
+    struct Param
+    {
+        const ::MIR::Param* mir;
+        // LValue (or borrowed LValue) slot, ~0u for constants
+        unsigned    lv = ~0u;
+    };
+    struct Op
+    {
+        // Exactly one of these is set
+        const ::MIR::Statement* stmt = nullptr;
+        const ::MIR::Terminator*    term = nullptr;
+        // Destination LValue (Assign destination, Drop slot, Call return value)
+        unsigned    dst = ~0u;
+        // Single LValue operand (e.g. Use/Borrow/Cast/UniOp source, If condition, Switch value, indirect call target)
+        unsigned    src = ~0u;
+        // Param operands (BinOp operands, MakeDst pointer/metadata, aggregate values, Call arguments)
+        unsigned    params_first = 0;
+        unsigned    params_count = 0;
+        // Direct calls, resolved on first execution
+        GlobalState::CallTarget call_target;
+    };
+
+    ::std::vector<LValue>   lvalues;
+    ::std::vector<Param>    params;
+    ::std::vector<Op>   ops;
+    // Index of the first op of each block (block `i` covers `block_start[i]` to `block_start[i+1]`, terminator last)
+    ::std::vector<unsigned> block_start;
+
+    LoweredFunction(const Function& fcn);
+
+    Op& get_op(unsigned bb_idx, unsigned stmt_idx) {
+        return ops[block_start.at(bb_idx) + stmt_idx];
+    }
+private:
+    unsigned add_lvalue(const ::MIR::LValue& lv);
+    void add_param(const ::MIR::Param& p);
+    void lower_rvalue(Op& op, const ::MIR::RValue& rv);
 };
 
 class InterpreterThread
@@ -59,6 +162,8 @@ class InterpreterThread
 
         ::std::function<bool(Value&,Value)> cb;
         const Function* fcn;
+        // Lowered form of `fcn` (looked up on the first step of this frame)
+        LoweredFunction*    lowered;
         Value ret;
         ::std::vector<Value>    args;
         ::std::vector<Value>    locals;
@@ -93,12 +198,16 @@ public:
     // Returns `true` if the call stack empties
     bool step_one(Value& out_thread_result);
 
+    size_t instruction_count() const { return m_instruction_count; }
+
 private:
     bool pop_stack(Value& out_thread_result);
 
     // Returns true if the call was resolved instantly
     bool call_path(Value& ret_val, const HIR::Path& p, ::std::vector<Value> args);
     // Returns true if the call was resolved instantly
+    bool call_target(Value& ret_val, const GlobalState::CallTarget& tgt, const HIR::Path& p, ::std::vector<Value> args);
+    // Returns true if the call was resolved instantly
     bool call_extern(Value& ret_val, const ::std::string& name, const ::std::string& abi, ::std::vector<Value> args);
     // Returns true if the call was resolved instantly
     bool call_intrinsic(Value& ret_val, const ::HIR::TypeRef& ret_ty, const RcString& name, const ::HIR::PathParams& pp, ::std::vector<Value> args);
@@ -22,33 +22,104 @@ namespace {
         return ofs + size <= max_size;
     }
 
-    void set_bit(uint8_t* p, size_t i, bool v)
+    bool get_bit(const uint8_t* p, size_t i) {
+        return (p[i/8] & (1 << (i%8))) != 0;
+    }
+    // Read `n` (at most 8) bits starting at bit `ofs`
+    uint8_t get_bits(const uint8_t* p, size_t ofs, size_t n)
+    {
+        assert(n <= 8);
+        unsigned v = p[ofs/8] >> (ofs%8);
+        if( ofs%8 + n > 8 )
+            v |= p[ofs/8+1] << (8 - ofs%8);
+        return static_cast<uint8_t>( v & ((1u << n) - 1) );
+    }
+    // Replace `n` (at most 8) bits starting at bit `ofs`
+    void set_bits(uint8_t* p, size_t ofs, size_t n, uint8_t v)
     {
-        if(v) {
-            p[i/8] |= 1 << (i%8);
+        assert(n <= 8);
+        unsigned mask = ((1u << n) - 1) << (ofs%8);
+        unsigned val = static_cast<unsigned>(v) << (ofs%8);
+        p[ofs/8] = static_cast<uint8_t>( (p[ofs/8] & ~mask) | (val & mask) );
+        if( ofs%8 + n > 8 )
+        {
+            p[ofs/8+1] = static_cast<uint8_t>( (p[ofs/8+1] & ~(mask >> 8)) | ((val >> 8) & (mask >> 8)) );
         }
-        else {
-            p[i/8] &= ~(1 << (i%8));
+    }
+    // Set all bits in `ofs .. ofs+len`
+    void set_bit_range(uint8_t* p, size_t ofs, size_t len)
+    {
+        // Leading partial byte
+        if( ofs % 8 != 0 && len > 0 )
+        {
+            size_t n = ::std::min(len, 8 - ofs%8);
+            set_bits(p, ofs, n, 0xFF);
+            ofs += n;
+            len -= n;
+        }
+        // Whole bytes
+        ::std::memset(p + ofs/8, 0xFF, len / 8);
+        ofs += len / 8 * 8;
+        len %= 8;
+        // Trailing partial byte
+        if( len > 0 )
+        {
+            set_bits(p, ofs, len, 0xFF);
         }
     }
-    bool get_bit(const uint8_t* p, size_t i) {
-        return (p[i/8] & (1 << (i%8))) != 0;
+    // Check that all bits in `ofs .. ofs+len` are set
+    bool test_bit_range(const uint8_t* p, size_t ofs, size_t len)
+    {
+        if( ofs % 8 != 0 && len > 0 )
+        {
+            size_t n = ::std::min(len, 8 - ofs%8);
+            if( get_bits(p, ofs, n) != (1u << n) - 1 )
+                return false;
+            ofs += n;
+            len -= n;
+        }
+        const uint8_t* bp = p + ofs/8;
+        size_t nbytes = len / 8;
+        // Test a word at a time, then any remaining whole bytes
+        for( ; nbytes >= 8; nbytes -= 8, bp += 8 )
+        {
+            uint64_t w;
+            ::std::memcpy(&w, bp, 8);
+            if( w != ~uint64_t(0) )
+                return false;
+        }
+        for( ; nbytes > 0; nbytes --, bp ++ )
+        {
+            if( *bp != 0xFF )
+                return false;
+        }
+        ofs += len / 8 * 8;
+        len %= 8;
+        if( len > 0 )
+        {
+            if( get_bits(p, ofs, len) != (1u << len) - 1 )
+                return false;
+        }
+        return true;
     }
     void copy_bits(uint8_t* dst, size_t dst_ofs, const uint8_t* src, size_t src_ofs,  size_t len)
     {
-        // Even number of bytes, fast copy
-        if( dst_ofs % 8 == 0 && src_ofs % 8 == 0 && len % 8 == 0 )
+        // Byte-aligned, copy whole bytes then the trailing bits
+        if( dst_ofs % 8 == 0 && src_ofs % 8 == 0 )
         {
-            for(size_t i = 0; i < len/8; i ++)
+            ::std::memmove(dst + dst_ofs/8, src + src_ofs/8, len / 8);
+            if( len % 8 != 0 )
             {
-                dst[dst_ofs/8 + i] = src[src_ofs/8 + i];
+                size_t o = len / 8 * 8;
+                set_bits(dst, dst_ofs + o, len % 8, get_bits(src, src_ofs + o, len % 8));
             }
         }
         else
         {
-            for(size_t i = 0; i < len; i ++)
+            for(size_t i = 0; i < len; i += 8)
             {
-                set_bit( dst, dst_ofs+i, get_bit(src, src_ofs+i) );
+                size_t n = ::std::min(len - i, size_t(8));
+                set_bits( dst, dst_ofs+i, n, get_bits(src, src_ofs+i, n) );
             }
         }
     }
@@ -413,22 +484,16 @@ void Allocation::check_bytes_valid(size_t ofs, size_t size) const
     if( !in_bounds(ofs, size, this->size()) ) {
         LOG_FATAL("Out of range - " << ofs << "+" << size << " > " << this->size());
     }
-    for(size_t i = ofs; i < ofs + size; i++)
+    if( !test_bit_range(this->m_mask.data(), ofs, size) )
     {
-        if( !(this->m_mask[i/8] & (1 << (i%8))) )
-        {
-            LOG_ERROR("Invalid bytes in value - " << ofs << "+" << size << " - " << *this);
-            throw "ERROR";
-        }
+        LOG_ERROR("Invalid bytes in value - " << ofs << "+" << size << " - " << *this);
+        throw "ERROR";
     }
 }
 void Allocation::mark_bytes_valid(size_t ofs, size_t size)
 {
     assert( ofs+size <= this->m_mask.size() * 8 );
-    for(size_t i = ofs; i < ofs + size; i++)
-    {
-        this->m_mask[i/8] |= (1 << (i%8));
-    }
+    set_bit_range(this->m_mask.data(), ofs, size);
 }
 Value Allocation::read_value(size_t ofs, size_t size) const
 {
@@ -439,27 +504,17 @@ Value Allocation::read_value(size_t ofs, size_t size) const
     LOG_DEBUG(*this);
     LOG_ASSERT( in_bounds(ofs, size, this->size()), "Read out of bounds (" << ofs << "+" << size << " > " << this->size() << ")" );
 
+    auto reloc_range = this->relocations_in(ofs, size);
     // Determine if this can become an inline allocation.
-    bool has_reloc = false;
-    for(const auto& r : this->relocations)
-    {
-        if( ofs <= r.slot_ofs && r.slot_ofs < ofs + size )
-        {
-            // NOTE: A relocation at offset zero is allowed
-            if( r.slot_ofs == ofs )
-                continue ;
-            has_reloc = true;
-        }
-    }
+    // NOTE: A relocation at offset zero is allowed
+    bool has_reloc = reloc_range.first != reloc_range.second
+        && (reloc_range.first->slot_ofs != ofs || reloc_range.second - reloc_range.first > 1);
     rv = Value::with_size(size, has_reloc);
     rv.write_bytes(0, this->data_ptr() + ofs, size);
 
-    for(const auto& r : this->relocations)
+    for(auto it = reloc_range.first; it != reloc_range.second; ++it)
     {
-        if( ofs <= r.slot_ofs && r.slot_ofs < ofs + size )
-        {
-            rv.set_reloc(r.slot_ofs - ofs, /*r.size*/POINTER_SIZE, r.backing_alloc);
-        }
+        rv.set_reloc(it->slot_ofs - ofs, /*r.size*/POINTER_SIZE, it->backing_alloc);
     }
     // Copy the mask bits
     copy_bits(rv.get_mask_mut(), 0, m_mask.data(), ofs, size);
@@ -509,12 +564,14 @@ void Allocation::write_value(size_t ofs, Value v)
         if( !new_relocs.empty() )
         {
             // 2. Move the new relocations into this allocation
+            // - The region was just cleared by `write_bytes`, and the source list is sorted, so insert as a block
             for(auto& r : new_relocs)
             {
                 //LOG_TRACE("Insert " << r.backing_alloc);
                 r.slot_ofs += ofs;
-                this->relocations.push_back( ::std::move(r) );
             }
+            auto pos = this->relocations_in(ofs, 0).first;
+            this->relocations.insert(pos, ::std::make_move_iterator(new_relocs.begin()), ::std::make_move_iterator(new_relocs.end()));
         }
 
         // Set mask in destination
@@ -549,19 +606,8 @@ void Allocation::write_bytes(size_t ofs, const void* src, size_t count)
 
 
     // - Remove any relocations already within this region
-    auto& this_relocs = this->relocations;
-    for(auto it = this_relocs.begin(); it != this_relocs.end(); )
-    {
-        if( ofs <= it->slot_ofs && it->slot_ofs < ofs + count)
-        {
-            //LOG_TRACE("Delete " << it->backing_alloc);
-            it = this_relocs.erase(it);
-        }
-        else 
-        {
-            ++it;
-        }
-    }
+    auto reloc_range = this->relocations_in(ofs, count);
+    this->relocations.erase(reloc_range.first, reloc_range.second);
 
     ::std::memcpy(this->data_ptr() + ofs, src, count);
     mark_bytes_valid(ofs, count);
@@ -577,20 +623,27 @@ void Allocation::set_reloc(size_t ofs, size_t len, RelocationPtr reloc)
     LOG_ASSERT(ofs % POINTER_SIZE == 0, "Allocation::set_reloc(" << ofs << ", " << len << ", " << reloc << ")");
     LOG_ASSERT(len == POINTER_SIZE, "Allocation::set_reloc(" << ofs << ", " << len << ", " << reloc << ")");
     // Delete any existing relocation at this position
-    for(auto it = this->relocations.begin(); it != this->relocations.end();)
-    {
-        if( ofs <= it->slot_ofs && it->slot_ofs < ofs + len )
-        {
-            // Slot starts in this updated region
-            // - TODO: Split in half?
-            it = this->relocations.erase(it);
-            continue ;
-        }
-        // TODO: What if the slot ends in the new region?
-        // What if the new region is in the middle of the slot
-        ++ it;
-    }
-    this->relocations.push_back(Relocation { ofs, /*len,*/ ::std::move(reloc) });
+    // - Slots that start in this updated region
+    // - TODO: Split in half?
+    // TODO: What if the slot ends in the new region?
+    // What if the new region is in the middle of the slot
+    auto reloc_range = this->relocations_in(ofs, len);
+    auto it = this->relocations.erase(reloc_range.first, reloc_range.second);
+    this->relocations.insert(it, Relocation { ofs, /*len,*/ ::std::move(reloc) });
+}
+::std::pair<Allocation::reloc_iter_t, Allocation::reloc_iter_t> Allocation::relocations_in(size_t ofs, size_t size)
+{
+    auto cmp = [](const Relocation& r, size_t o){ return r.slot_ofs < o; };
+    auto first = ::std::lower_bound(this->relocations.begin(), this->relocations.end(), ofs, cmp);
+    auto last = ::std::lower_bound(first, this->relocations.end(), ofs + size, cmp);
+    return ::std::make_pair(first, last);
+}
+::std::pair<Allocation::reloc_citer_t, Allocation::reloc_citer_t> Allocation::relocations_in(size_t ofs, size_t size) const
+{
+    auto cmp = [](const Relocation& r, size_t o){ return r.slot_ofs < o; };
+    auto first = ::std::lower_bound(this->relocations.begin(), this->relocations.end(), ofs, cmp);
+    auto last = ::std::lower_bound(first, this->relocations.end(), ofs + size, cmp);
+    return ::std::make_pair(first, last);
 }
 ::std::ostream& operator<<(::std::ostream& os, const Allocation& x)
 {
@@ -735,12 +788,12 @@ void Value::check_bytes_valid(size_t ofs, size_t size) const
         throw "ERROR";
     }
     const auto* mask = this->get_mask();
-    for(size_t i = ofs; i < ofs + size; i++)
+    if( !test_bit_range(mask, ofs, size) )
     {
-        if( !get_bit(mask, i) )
-        {
-            LOG_ERROR("Accessing invalid bytes in value, offset " << i << " of " << *this);
-        }
+        size_t i = ofs;
+        while( get_bit(mask, i) )
+            i ++;
+        LOG_ERROR("Accessing invalid bytes in value, offset " << i << " of " << *this);
     }
 }
 void Value::mark_bytes_valid(size_t ofs, size_t size)
@@ -751,10 +804,7 @@ void Value::mark_bytes_valid(size_t ofs, size_t size)
     }
     else
     {
-        for(size_t i = ofs; i < ofs+size; i++)
-        {
-            m_inner.direct.mask[i/8] |= (1 << i%8);
-        }
+        set_bit_range(m_inner.direct.mask, ofs, size);
     }
 }
 
@@ -834,14 +884,17 @@ void Value::write_value(size_t ofs, Value v)
         // - Copy mask
         copy_bits(this->get_mask_mut(), ofs,  v.get_mask(), 0,  v.size());
 
-        // TODO: Faster way of knowing where there are relocations
-        for(size_t i = 0; i < v.size(); i ++)
+        if( v.m_inner.is_alloc )
         {
-            if( auto r = v.get_relocation(i) )
+            for(const auto& r : v.m_inner.alloc.alloc->relocations)
             {
-                this->set_reloc(ofs + i, POINTER_SIZE, r);
+                this->set_reloc(ofs + r.slot_ofs, POINTER_SIZE, r.backing_alloc);
             }
         }
+        else if( v.m_inner.direct.reloc_0 )
+        {
+            this->set_reloc(ofs, POINTER_SIZE, ::std::move(v.m_inner.direct.reloc_0));
+        }
     }
 }
 void Value::write_ptr(size_t ofs, size_t ptr_ofs, RelocationPtr reloc)
@@ -12,6 +12,7 @@
 #include <cstdint>
 #include <cstring>	// memcpy
 #include <cassert>
+#include <algorithm>
 
 #include "debug.hpp"
 #include "u128.hpp"
@@ -276,8 +277,12 @@ class Allocation:
 
     ::std::vector<uint64_t> m_data;
 public:
+    // Validity bitmap (one bit per byte)
     ::std::vector<uint8_t> m_mask;
+    // Relocations, sorted by `slot_ofs`
     ::std::vector<Relocation>   relocations;
+    typedef ::std::vector<Relocation>::iterator reloc_iter_t;
+    typedef ::std::vector<Relocation>::const_iterator reloc_citer_t;
 public:
     virtual ~Allocation() {}
     static AllocationHandle new_alloc(size_t size, ::std::string tag);
@@ -291,17 +296,18 @@ public:
     const ::std::string& tag() const { return m_tag; }
 
     RelocationPtr get_relocation(size_t ofs) const override {
-        for(const auto& r : relocations) {
-            if(r.slot_ofs == ofs)
-                return r.backing_alloc;
-        }
+        auto r = relocations_in(ofs, 1);
+        if( r.first != r.second )
+            return r.first->backing_alloc;
         return RelocationPtr();
     }
+    /// Get the range of relocations that start within `ofs .. ofs+size`
+    ::std::pair<reloc_iter_t, reloc_iter_t> relocations_in(size_t ofs, size_t size);
+    ::std::pair<reloc_citer_t, reloc_citer_t> relocations_in(size_t ofs, size_t size) const;
     void mark_as_freed() {
         is_freed = true;
         relocations.clear();
-        for(auto& v : m_mask)
-            v = 0;
+        ::std::fill(m_mask.begin(), m_mask.end(), uint8_t(0));
     }
 
     void resize(size_t new_size);